@@ -5,8 +5,9 @@
 #include <stdbool.h>
 #include <stdlib.h>
 
-#include "stb_easy_font.h"
 #include "soil.h"  
+#include "src/gl_ext.h"
+#include "src/ui_batch.h"
 
 bool enPantalla2 = false;
 int windowWidth = 1920;
@@ -46,37 +47,17 @@ void dibujarFondo() {
     glDisable(GL_TEXTURE_2D);
 }
 
-// Dibujar texto con stb_easy_font
+// Dibujar texto con stb_easy_font: los quads de cada texto se generan una vez
+// (ui_batch los guarda en caché) y se dibujan con el resto de la interfaz en ui_flush()
 void dibujarTexto(const char* texto, float x, float y, float r, float g, float b) {
-    char buffer[99999]; // suficiente para mucho texto
-    int quads;
-
-    quads = stb_easy_font_print(x, y, (char*)texto, NULL, buffer, sizeof(buffer));
-
-    // Escalar el texto para hacerlo más visible
-    glPushMatrix();
-    glScalef(0.01f, 0.01f, 1.0f); // Escalar a 1/100 del tamaño original (más pequeño)
-    glScalef(1.0f, -1.0f, 1.0f); // Invertir Y para corregir la orientación
-    
-    glColor3f(r, g, b);
-    glEnableClientState(GL_VERTEX_ARRAY);
-    glVertexPointer(2, GL_FLOAT, 16, buffer);
-    glDrawArrays(GL_QUADS, 0, quads * 4);
-    glDisableClientState(GL_VERTEX_ARRAY);
-    
-    glPopMatrix();
+    // Escalar a 1/100 del tamaño original e invertir Y para corregir la orientación
+    ui_text(texto, x * 0.01f, -y * 0.01f, 0.01f, -0.01f, r, g, b);
 }
 
 // Botón central
 void dibujarBoton() {
     // Rectángulo azul centrado
-    glColor3f(0.2f, 0.4f, 0.8f);
-    glBegin(GL_QUADS);
-        glVertex2f(-0.15f, -0.08f);
-        glVertex2f( 0.15f, -0.08f);
-        glVertex2f( 0.15f,  0.08f);
-        glVertex2f(-0.15f,  0.08f);
-    glEnd();
+    ui_rect(-0.15f, -0.08f, 0.3f, 0.16f, 0.2f, 0.4f, 0.8f, 1.0f);
 
     // Texto "Iniciar" centrado en el botón
     dibujarTexto("Iniciar", -1.2f, 0.0f, 1.0f, 1.0f, 1.0f);
@@ -147,6 +128,10 @@ int main() {
     glfwSetMouseButtonCallback(window, mouse_button_callback);
     glfwSetWindowSizeCallback(window, window_size_callback);
     
+    // Interfaz en lote (usa un VBO si el driver lo soporta)
+    init_gl_extensions();
+    init_ui_batch();
+    
     // Configurar la matriz de proyección para mantener aspecto correcto
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
@@ -199,11 +184,15 @@ int main() {
         } else {
             dibujarPantalla2();
         }
+        
+        // Toda la interfaz del frame en una sola llamada de dibujo
+        ui_flush();
     
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
     
+    cleanup_ui_batch();
 
     glfwDestroyWindow(window);
     glfwTerminate();
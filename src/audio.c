@@ -1,8 +1,26 @@
 // audio.c - Sistema de audio simplificado para Backrooms
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 199309L  // clock_gettime
+#endif
 #include "audio.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <windows.h>
+
+#ifndef _WIN32
+#include <time.h>
+
+// Sin winmm: los sonidos no se reproducen pero los temporizadores siguen igual
+#define SND_FILENAME 0
+#define SND_ASYNC 0
+#define SND_LOOP 0
+#define PlaySound(sound, module, flags) ((void)(sound))
+
+static DWORD GetTickCount() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (DWORD)(now.tv_sec * 1000 + now.tv_nsec / 1000000);
+}
+#endif
 
 // Variables para control de sonidos
 static int current_footstep = 0;
@@ -99,6 +117,7 @@ void cleanup_audio() {
     printf("Sistema de audio limpiado\n");
 }
 
+#ifdef _WIN32
 // Funciones de hilos (no usadas en el sistema simplificado)
 DWORD WINAPI ambient_thread(LPVOID lpParam) {
     return 0;
@@ -110,4 +129,5 @@ DWORD WINAPI footstep_thread(LPVOID lpParam) {
 
 DWORD WINAPI running_thread(LPVOID lpParam) {
     return 0;
-}
\ No newline at end of file
+}
+#endif
@@ -2,8 +2,18 @@
 #ifndef AUDIO_H
 #define AUDIO_H
 
+#ifdef _WIN32
 #include <windows.h>
 #include <mmsystem.h>
+#else
+// Fuera de Windows (benchmark sin ventana) el audio queda en silencio
+#include <stdint.h>
+typedef int BOOL;
+typedef uint32_t DWORD;
+typedef void* HANDLE;
+#define TRUE 1
+#define FALSE 0
+#endif
 
 // Estructura para sonidos con hilos
 typedef struct {
@@ -24,9 +34,11 @@ void play_death_sound();
 void update_audio();
 void cleanup_audio();
 
+#ifdef _WIN32
 // Funciones de hilos
 DWORD WINAPI ambient_thread(LPVOID lpParam);
 DWORD WINAPI footstep_thread(LPVOID lpParam);
 DWORD WINAPI running_thread(LPVOID lpParam);
+#endif
 
 #endif // AUDIO_H
@@ -0,0 +1,908 @@
+// benchmark.c - Medición reproducible del tiempo de frame
+#include "benchmark.h"
+#include "render.h"
+#include "player.h"
+#include "map.h"
+#include "frustum.h"
+#include "occlusion.h"
+#include "gl_state.h"
+#include "gl_ext.h"
+#include "instancing.h"
+#include "light_clusters.h"
+#include "lightmap.h"
+#include "lod.h"
+#include "pvs.h"
+#include "light_visibility.h"
+#include "particles.h"
+#include "connectivity.h"
+#include "timer.h"
+#include <GL/gl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+extern int windowWidth;
+extern int windowHeight;
+
+// Posición de cámara de un frame del recorrido
+typedef struct {
+    float x, y, z;
+    float yaw, pitch;
+} CameraPose;
+
+// Medidas de un frame
+typedef struct {
+    double cpu_ms;        // Tiempo de render_world() en la CPU (envío de comandos)
+    double gpu_ms;        // Tiempo de GPU medido con GL_TIME_ELAPSED (-1 sin soporte)
+    double frame_ms;      // Frame completo hasta glFinish()
+    long draw_calls;
+    long vertices;
+} FrameSample;
+
+// Percentiles de una serie
+typedef struct {
+    double avg, min, max;
+    double p50, p95, p99;
+} Percentiles;
+
+// Resultado de una pasada
+typedef struct {
+    const char* name;
+    int mode;
+    FrameSample* samples;
+    Percentiles cpu;
+    Percentiles gpu;
+    Percentiles frame;
+    Percentiles draw_calls;
+    Percentiles vertices;
+    double chunks_accepted;   // Medias por frame del frustum culling
+    double chunks_rejected;
+    double cells_accepted;
+    double cells_rejected;
+    double visible_cells;     // Medias por frame de la oclusión por raycasting
+    double radius_cells;
+    double gl_calls_issued;   // Medias por frame de la caché de estado
+    double gl_calls_filtered;
+} BenchmarkResult;
+
+// Ordenación y subida de partículas para una cantidad fija
+typedef struct {
+    int count;
+    int visible;          // Delante de la cámara en el último frame
+    Percentiles sort_ms;
+    Percentiles upload_ms;
+} ParticleBenchmark;
+
+static const int benchmark_particle_counts[] = {10000, 50000, 100000};
+#define BENCHMARK_PARTICLE_STEPS (int)(sizeof(benchmark_particle_counts) / sizeof(benchmark_particle_counts[0]))
+
+// Etiquetado, unión y relleno de regiones sobre un mapa cuadrado aleatorio
+typedef struct {
+    int size;
+    int regions;          // Regiones abiertas antes de unir
+    int carved;           // Muros abiertos para unirlas
+    int filled;           // Celdas alcanzadas desde el centro tras unir
+    int open_cells;
+    Percentiles label_ms;
+    Percentiles join_ms;
+    Percentiles fill_ms;
+} ConnectivityBenchmark;
+
+static const int benchmark_connectivity_sizes[] = {1024, 4096};
+#define BENCHMARK_CONNECTIVITY_STEPS (int)(sizeof(benchmark_connectivity_sizes) / sizeof(benchmark_connectivity_sizes[0]))
+
+// Generación, relleno y rayos sobre la rejilla del mapa en una disposición de memoria
+typedef struct {
+    int size;
+    MapLayout layout;
+    int walls;            // Muros del mapa generado
+    int filled;           // Celdas alcanzadas por el relleno desde el centro
+    long ray_cells;       // Celdas recorridas por todos los rayos
+    Percentiles generate_ms;
+    Percentiles fill_ms;
+    Percentiles raycast_ms;
+} LayoutBenchmark;
+
+static const int benchmark_layout_sizes[] = {512, 2048};
+#define BENCHMARK_LAYOUT_STEPS (int)(sizeof(benchmark_layout_sizes) / sizeof(benchmark_layout_sizes[0]))
+
+// Recorrido de cámara (grabado o generado sobre el mapa)
+static CameraPose* camera_path = NULL;
+static int camera_path_length = 0;
+static const char* camera_path_source = "recorrido generado";
+
+// Grabación de recorridos durante una partida
+static FILE* record_file = NULL;
+
+static int compare_doubles(const void* a, const void* b) {
+    double da = *(const double*)a;
+    double db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+// Percentiles por rango más cercano sobre una copia ordenada
+static Percentiles compute_percentiles(const double* values, int count) {
+    Percentiles result = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    if (count <= 0) return result;
+
+    double* sorted = (double*)malloc(sizeof(double) * count);
+    if (!sorted) return result;
+    memcpy(sorted, values, sizeof(double) * count);
+    qsort(sorted, count, sizeof(double), compare_doubles);
+
+    double sum = 0.0;
+    for (int i = 0; i < count; i++) sum += sorted[i];
+    result.avg = sum / count;
+    result.min = sorted[0];
+    result.max = sorted[count - 1];
+    result.p50 = sorted[(int)ceil(0.50 * count) - 1];
+    result.p95 = sorted[(int)ceil(0.95 * count) - 1];
+    result.p99 = sorted[(int)ceil(0.99 * count) - 1];
+    free(sorted);
+    return result;
+}
+
+// Recorrido en anchura por celdas abiertas; devuelve la longitud del camino o 0.
+// previous y queue tienen una entrada por celda del mapa
+static int find_cell_path(int from_x, int from_z, int to_x, int to_z, int* path, int max_length,
+                          int* previous, int* queue) {
+    for (int i = 0; i < maze_width * maze_height; i++) previous[i] = -1;
+
+    int start = from_x * maze_height + from_z;
+    int goal = to_x * maze_height + to_z;
+    int head = 0, tail = 0;
+    queue[tail++] = start;
+    previous[start] = start;
+
+    const int dx[4] = {1, -1, 0, 0};
+    const int dz[4] = {0, 0, 1, -1};
+    while (head < tail && previous[goal] < 0) {
+        int cell = queue[head++];
+        int x = cell / maze_height, z = cell % maze_height;
+        for (int d = 0; d < 4; d++) {
+            int nx = x + dx[d], nz = z + dz[d];
+            if (nx < 0 || nx >= maze_width || nz < 0 || nz >= maze_height) continue;
+            int next = nx * maze_height + nz;
+            if (previous[next] >= 0 || maze_cell(nx, nz) == 1) continue;
+            previous[next] = cell;
+            queue[tail++] = next;
+        }
+    }
+    if (previous[goal] < 0) return 0;
+
+    // Reconstruir desde el destino y dar la vuelta
+    int length = 0;
+    for (int cell = goal; length < max_length; cell = previous[cell]) {
+        path[length++] = cell;
+        if (cell == start) break;
+    }
+    for (int i = 0; i < length / 2; i++) {
+        int t = path[i];
+        path[i] = path[length - 1 - i];
+        path[length - 1 - i] = t;
+    }
+    return length;
+}
+
+// Recorrido por defecto: de luz en luz (la más cercana cada vez) por los pasillos del mapa,
+// remuestreado a velocidad constante y mirando unas celdas por delante
+static void build_flythrough() {
+    int max_points = maze_width * maze_height;
+    int* cells = (int*)malloc(sizeof(int) * max_points);
+    int* segment = (int*)malloc(sizeof(int) * max_points);
+    int* previous = (int*)malloc(sizeof(int) * max_points);
+    int* queue = (int*)malloc(sizeof(int) * max_points);
+    bool* visited = (bool*)calloc((size_t)(lightCount > 0 ? lightCount : 1), sizeof(bool));
+    if (!cells || !segment || !previous || !queue || !visited) {
+        free(cells);
+        free(segment);
+        free(previous);
+        free(queue);
+        free(visited);
+        return;
+    }
+
+    // Celdas que consume el remuestreo (más las que mira por delante): en mapas grandes
+    // no hace falta visitar todas las luces
+    int needed = (int)(BENCHMARK_FRAMES * BENCHMARK_PATH_SPEED) + BENCHMARK_LOOK_AHEAD + 2;
+
+    int x = maze_width / 2, z = maze_height / 2;
+    int count = 0;
+    cells[count++] = x * maze_height + z;
+    for (int step = 0; step < lightCount && count < needed; step++) {
+        int best = -1;
+        float best_distance = 1e30f;
+        for (int i = 0; i < lightCount; i++) {
+            if (visited[i] || !lightPoints[i].active) continue;
+            float ddx = lightPoints[i].x - x, ddz = lightPoints[i].z - z;
+            if (ddx * ddx + ddz * ddz < best_distance) {
+                best_distance = ddx * ddx + ddz * ddz;
+                best = i;
+            }
+        }
+        if (best < 0) break;
+        visited[best] = true;
+
+        int tx = (int)floorf(lightPoints[best].x + 0.5f);
+        int tz = (int)floorf(lightPoints[best].z + 0.5f);
+        int length = find_cell_path(x, z, tx, tz, segment, max_points, previous, queue);
+        if (length < 2 || count + length > max_points) continue;
+        memcpy(cells + count, segment + 1, sizeof(int) * (length - 1));
+        count += length - 1;
+        x = tx;
+        z = tz;
+    }
+
+    // Remuestrear a BENCHMARK_PATH_SPEED unidades por frame (el recorrido se repite si es corto)
+    camera_path = (CameraPose*)malloc(sizeof(CameraPose) * BENCHMARK_FRAMES);
+    camera_path_length = camera_path ? BENCHMARK_FRAMES : 0;
+    for (int frame = 0; frame < camera_path_length; frame++) {
+        float position = count > 1 ? fmodf(frame * BENCHMARK_PATH_SPEED, (float)(count - 1)) : 0.0f;
+        int i = (int)position;
+        float t = position - i;
+        int a = cells[i], b = cells[i + 1 < count ? i + 1 : i];
+        int ahead = cells[i + BENCHMARK_LOOK_AHEAD < count ? i + BENCHMARK_LOOK_AHEAD : count - 1];
+
+        CameraPose* pose = &camera_path[frame];
+        pose->x = (a / maze_height) * (1.0f - t) + (b / maze_height) * t;
+        pose->z = (a % maze_height) * (1.0f - t) + (b % maze_height) * t;
+        pose->y = 0.0f;
+        pose->pitch = 0.0f;
+
+        // yaw = 0 mira hacia -Z
+        float look_x = ahead / maze_height - pose->x;
+        float look_z = ahead % maze_height - pose->z;
+        pose->yaw = (look_x != 0.0f || look_z != 0.0f) ? atan2f(-look_x, -look_z)
+                                                      : 2.0f * (float)M_PI * frame / BENCHMARK_FRAMES;
+    }
+
+    free(cells);
+    free(segment);
+    free(previous);
+    free(queue);
+    free(visited);
+}
+
+// Recorrido grabado con --record-path: una línea "x y z yaw pitch" por tick
+static bool load_camera_path(const char* filename) {
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        printf("No se pudo abrir el recorrido %s (se usa el generado)\n", filename);
+        return false;
+    }
+
+    int capacity = 1024;
+    camera_path = (CameraPose*)malloc(sizeof(CameraPose) * capacity);
+    camera_path_length = 0;
+    CameraPose pose;
+    while (camera_path && fscanf(file, "%f %f %f %f %f", &pose.x, &pose.y, &pose.z, &pose.yaw, &pose.pitch) == 5) {
+        if (camera_path_length == capacity) {
+            capacity *= 2;
+            CameraPose* grown = (CameraPose*)realloc(camera_path, sizeof(CameraPose) * capacity);
+            if (!grown) break;
+            camera_path = grown;
+        }
+        camera_path[camera_path_length++] = pose;
+    }
+    fclose(file);
+
+    if (camera_path_length == 0) {
+        printf("El recorrido %s está vacío (se usa el generado)\n", filename);
+        free(camera_path);
+        camera_path = NULL;
+        return false;
+    }
+    camera_path_source = filename;
+    return true;
+}
+
+static void benchmark_camera(int frame) {
+    if (camera_path_length == 0) {
+        // Sin recorrido: vuelta completa en el centro del mapa
+        player.x = maze_width / 2.0f;
+        player.z = maze_height / 2.0f;
+        player.y = 0.0f;
+        player.pitch = 0.0f;
+        player.yaw = 2.0f * (float)M_PI * frame / BENCHMARK_FRAMES;
+        return;
+    }
+    const CameraPose* pose = &camera_path[frame % camera_path_length];
+    player.x = pose->x;
+    player.y = pose->y;
+    player.z = pose->z;
+    player.yaw = pose->yaw;
+    player.pitch = pose->pitch;
+}
+
+static BenchmarkResult benchmark_pass(GLFWwindow* window, const char* name, int mode) {
+    BenchmarkResult result;
+    memset(&result, 0, sizeof(result));
+    result.name = name;
+    result.mode = mode;
+    result.samples = (FrameSample*)calloc(BENCHMARK_FRAMES, sizeof(FrameSample));
+    double* series = (double*)malloc(sizeof(double) * BENCHMARK_FRAMES);
+    if (!result.samples || !series) {
+        free(series);
+        return result;
+    }
+
+    wall_render_mode = mode;
+
+    // Consulta de tiempo de GPU alrededor de cada render_world()
+    GLuint gpu_query = 0;
+    if (gl_has_timer_query) glGenQueries(1, &gpu_query);
+
+    for (int frame = -BENCHMARK_WARMUP; frame < BENCHMARK_FRAMES; frame++) {
+        benchmark_camera(frame < 0 ? 0 : frame);
+
+        if (gpu_query) glBeginQuery(GL_TIME_ELAPSED, gpu_query);
+        double start = timer_seconds();
+        render_world();
+        double submitted = timer_seconds();
+        if (gpu_query) glEndQuery(GL_TIME_ELAPSED);
+        glFinish(); // Esperar a la GPU para medir el frame completo
+        double finished = timer_seconds();
+
+        uint64_t gpu_ns = 0;
+        if (gpu_query) glGetQueryObjectui64v(gpu_query, GL_QUERY_RESULT, &gpu_ns);
+
+        if (window) {
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        if (frame < 0) continue;
+        FrameSample* sample = &result.samples[frame];
+        sample->cpu_ms = (submitted - start) * 1000.0;
+        sample->gpu_ms = gpu_query ? gpu_ns / 1.0e6 : -1.0;
+        sample->frame_ms = (finished - start) * 1000.0;
+        sample->draw_calls = gl_state_stats.draw_calls;
+        sample->vertices = gl_state_stats.vertices;
+
+        result.chunks_accepted += frustum_stats.chunks_accepted;
+        result.chunks_rejected += frustum_stats.chunks_rejected;
+        result.cells_accepted += frustum_stats.cells_accepted;
+        result.cells_rejected += frustum_stats.cells_rejected;
+        result.visible_cells += occlusion_stats.visible_cells;
+        result.radius_cells += occlusion_stats.radius_cells;
+        result.gl_calls_issued += gl_state_stats.calls_issued;
+        result.gl_calls_filtered += gl_state_stats.calls_filtered;
+    }
+    if (gpu_query) glDeleteQueries(1, &gpu_query);
+
+    result.chunks_accepted /= BENCHMARK_FRAMES;
+    result.chunks_rejected /= BENCHMARK_FRAMES;
+    result.cells_accepted /= BENCHMARK_FRAMES;
+    result.cells_rejected /= BENCHMARK_FRAMES;
+    result.visible_cells /= BENCHMARK_FRAMES;
+    result.radius_cells /= BENCHMARK_FRAMES;
+    result.gl_calls_issued /= BENCHMARK_FRAMES;
+    result.gl_calls_filtered /= BENCHMARK_FRAMES;
+
+    for (int i = 0; i < BENCHMARK_FRAMES; i++) series[i] = result.samples[i].cpu_ms;
+    result.cpu = compute_percentiles(series, BENCHMARK_FRAMES);
+    for (int i = 0; i < BENCHMARK_FRAMES; i++) series[i] = result.samples[i].gpu_ms;
+    result.gpu = compute_percentiles(series, BENCHMARK_FRAMES);
+    for (int i = 0; i < BENCHMARK_FRAMES; i++) series[i] = result.samples[i].frame_ms;
+    result.frame = compute_percentiles(series, BENCHMARK_FRAMES);
+    for (int i = 0; i < BENCHMARK_FRAMES; i++) series[i] = (double)result.samples[i].draw_calls;
+    result.draw_calls = compute_percentiles(series, BENCHMARK_FRAMES);
+    for (int i = 0; i < BENCHMARK_FRAMES; i++) series[i] = (double)result.samples[i].vertices;
+    result.vertices = compute_percentiles(series, BENCHMARK_FRAMES);
+    free(series);
+
+    printf("  %-22s frame %7.3f ms | p50 %7.3f | p95 %7.3f | p99 %7.3f (%.1f FPS)\n",
+           result.name, result.frame.avg, result.frame.p50, result.frame.p95, result.frame.p99,
+           result.frame.avg > 0.0 ? 1000.0 / result.frame.avg : 0.0);
+    printf("  %-22s CPU   %7.3f ms | p50 %7.3f | p95 %7.3f | p99 %7.3f\n",
+           "", result.cpu.avg, result.cpu.p50, result.cpu.p95, result.cpu.p99);
+    if (gl_has_timer_query) {
+        printf("  %-22s GPU   %7.3f ms | p50 %7.3f | p95 %7.3f | p99 %7.3f\n",
+               "", result.gpu.avg, result.gpu.p50, result.gpu.p95, result.gpu.p99);
+    }
+    printf("  %-22s dibujo: %.0f llamadas y %.0f vértices por frame (máx %.0f / %.0f)\n",
+           "", result.draw_calls.avg, result.vertices.avg, result.draw_calls.max, result.vertices.max);
+    printf("  %-22s frustum: chunks %.1f aceptados / %.1f rechazados, celdas %.0f / %.0f\n",
+           "", result.chunks_accepted, result.chunks_rejected,
+           result.cells_accepted, result.cells_rejected);
+    printf("  %-22s oclusion: %.0f celdas visibles de %.0f dentro del radio\n",
+           "", result.visible_cells, result.radius_cells);
+    printf("  %-22s estado GL: %.0f llamadas emitidas, %.0f filtradas por la caché\n",
+           "", result.gl_calls_issued, result.gl_calls_filtered);
+    printf("  %-22s luces: %d visibles de %d, %d clusters iluminados, máx %d por cluster (último frame)\n",
+           "", light_cluster_stats.lights_visible, light_cluster_stats.lights_total,
+           light_cluster_stats.clusters_lit, light_cluster_stats.max_per_cluster);
+    printf("  %-22s LOD: %d cerca / %d medio / %d lejos, umbrales %.1f / %.1f (último frame)\n",
+           "", lod_stats.near_count, lod_stats.mid_count, lod_stats.far_count,
+           lod_mid_distance, lod_far_distance);
+    return result;
+}
+
+// Coste por frame de ordenar las partículas y subir sus billboards, con la cámara
+// girando sobre la primera pose del recorrido para que el orden cambie cada frame
+static ParticleBenchmark benchmark_particles(int count) {
+    ParticleBenchmark result;
+    memset(&result, 0, sizeof(result));
+    result.count = count;
+
+    double sort_series[BENCHMARK_PARTICLE_FRAMES];
+    double upload_series[BENCHMARK_PARTICLE_FRAMES];
+
+    benchmark_camera(0);
+    srand(BENCHMARK_SEED);
+    particle_count = 0;
+    for (int i = 0; i < count; i++) {
+        float angle = (rand() % 3600) * (float)M_PI / 1800.0f;
+        float radius = (rand() % 1000) / 1000.0f * BENCHMARK_PARTICLE_RADIUS;
+        add_particle(player.x + cosf(angle) * radius, 0.2f + (rand() % 1000) / 1000.0f * 2.5f,
+                     player.z + sinf(angle) * radius, 0.0f, 0.0f, 0.0f);
+    }
+
+    float start_yaw = player.yaw;
+    for (int frame = -BENCHMARK_WARMUP; frame < BENCHMARK_PARTICLE_FRAMES; frame++) {
+        player.yaw = start_yaw + (frame < 0 ? 0 : frame) * 2.0f * (float)M_PI / BENCHMARK_PARTICLE_FRAMES;
+        setup_camera();
+
+        double start = timer_seconds();
+        int visible = sort_particles_back_to_front();
+        double sorted = timer_seconds();
+        upload_particle_batch(visible);
+        glFinish(); // Incluir la copia al driver
+        double uploaded = timer_seconds();
+
+        if (frame < 0) continue;
+        sort_series[frame] = (sorted - start) * 1000.0;
+        upload_series[frame] = (uploaded - sorted) * 1000.0;
+        result.visible = visible;
+    }
+    particle_count = 0;
+
+    result.sort_ms = compute_percentiles(sort_series, BENCHMARK_PARTICLE_FRAMES);
+    result.upload_ms = compute_percentiles(upload_series, BENCHMARK_PARTICLE_FRAMES);
+    printf("  %6d partículas (%6d visibles): orden %6.3f ms (p95 %6.3f) | subida %6.3f ms (p95 %6.3f)\n",
+           count, result.visible, result.sort_ms.avg, result.sort_ms.p95,
+           result.upload_ms.avg, result.upload_ms.p95);
+    return result;
+}
+
+// Conectividad a escala: rejilla size x size con muros aleatorios y borde cerrado.
+// Cada repetición regenera la misma rejilla (la unión la modifica)
+static ConnectivityBenchmark benchmark_connectivity(int size) {
+    ConnectivityBenchmark result;
+    memset(&result, 0, sizeof(result));
+    result.size = size;
+
+    int cells = size * size;
+    unsigned char* grid = malloc((size_t)cells);
+    int* labels = malloc(sizeof(int) * cells);
+    unsigned char* visited = malloc((size_t)cells);
+    if (!grid || !labels || !visited) {
+        printf("  %5dx%-5d sin memoria suficiente\n", size, size);
+        free(grid); free(labels); free(visited);
+        return result;
+    }
+
+    double label_series[BENCHMARK_CONNECTIVITY_RUNS];
+    double join_series[BENCHMARK_CONNECTIVITY_RUNS];
+    double fill_series[BENCHMARK_CONNECTIVITY_RUNS];
+    int center = (size / 2) * size + size / 2;
+
+    for (int run = 0; run < BENCHMARK_CONNECTIVITY_RUNS; run++) {
+        srand(BENCHMARK_SEED);
+        result.open_cells = 0;
+        for (int x = 0; x < size; x++) {
+            for (int z = 0; z < size; z++) {
+                bool border = x == 0 || z == 0 || x == size - 1 || z == size - 1;
+                bool wall = border || rand() % 100 < BENCHMARK_CONNECTIVITY_WALLS;
+                grid[x * size + z] = wall ? CELL_WALL : 0;
+                if (!wall) result.open_cells++;
+            }
+        }
+        if (grid[center] == CELL_WALL) {
+            grid[center] = 0;
+            result.open_cells++;
+        }
+
+        double start = timer_seconds();
+        result.regions = label_components(grid, size, size, MAP_LAYOUT_LINEAR, labels);
+        double labeled = timer_seconds();
+        result.carved = join_components(grid, size, size, MAP_LAYOUT_LINEAR, labels, result.regions, labels[center]);
+        double joined = timer_seconds();
+        memset(visited, 0, (size_t)cells);
+        double fill_start = timer_seconds();
+        result.filled = scanline_fill(grid, size, size, MAP_LAYOUT_LINEAR, size / 2, size / 2, visited);
+        double filled = timer_seconds();
+
+        label_series[run] = (labeled - start) * 1000.0;
+        join_series[run] = (joined - labeled) * 1000.0;
+        fill_series[run] = (filled - fill_start) * 1000.0;
+    }
+    result.open_cells += result.carved > 0 ? result.carved : 0;
+
+    free(grid);
+    free(labels);
+    free(visited);
+
+    result.label_ms = compute_percentiles(label_series, BENCHMARK_CONNECTIVITY_RUNS);
+    result.join_ms = compute_percentiles(join_series, BENCHMARK_CONNECTIVITY_RUNS);
+    result.fill_ms = compute_percentiles(fill_series, BENCHMARK_CONNECTIVITY_RUNS);
+    printf("  %5dx%-5d %7d regiones, %6d muros abiertos: etiquetado %8.2f ms | unión %8.2f ms | "
+           "relleno %8.2f ms (%s)\n",
+           size, size, result.regions, result.carved, result.label_ms.avg, result.join_ms.avg,
+           result.fill_ms.avg, result.filled == result.open_cells ? "todo conectado" : "REGIONES SUELTAS");
+    return result;
+}
+
+// Relleno en anchura desde el centro con vecindad 4, todo a través de los accesores
+// de la rejilla; visited sigue la misma disposición que maze_cells
+static int layout_flood_fill(unsigned char* visited, int* queue) {
+    int start_x = maze_width / 2, start_z = maze_height / 2;
+    if (maze_cell(start_x, start_z) == 1) return 0;
+
+    static const int step_x[4] = {-1, 1, 0, 0};
+    static const int step_z[4] = {0, 0, -1, 1};
+    int head = 0, tail = 0;
+    queue[tail++] = (start_x << 16) | start_z;
+    visited[maze_index(start_x, start_z)] = 1;
+    while (head < tail) {
+        int x = queue[head] >> 16, z = queue[head] & 0xFFFF;
+        head++;
+        for (int d = 0; d < 4; d++) {
+            int nx = x + step_x[d], nz = z + step_z[d];
+            if (!maze_in_bounds(nx, nz) || maze_cell(nx, nz) == 1) continue;
+            int index = maze_index(nx, nz);
+            if (visited[index]) continue;
+            visited[index] = 1;
+            queue[tail++] = (nx << 16) | nz;
+        }
+    }
+    return tail;
+}
+
+// Rayos DDA como los del PVS: devuelve las celdas recorridas hasta chocar con un muro
+static long layout_cast_rays(const int* origins, int origin_count) {
+    long cells = 0;
+    for (int o = 0; o < origin_count; o++) {
+        int start_x = origins[o] >> 16, start_z = origins[o] & 0xFFFF;
+        for (int r = 0; r < BENCHMARK_LAYOUT_RAYS; r++) {
+            float angle = 2.0f * (float)M_PI * r / BENCHMARK_LAYOUT_RAYS;
+            float dir_x = cosf(angle), dir_z = sinf(angle);
+            int cell_x = start_x, cell_z = start_z;
+            int step_x = dir_x >= 0.0f ? 1 : -1;
+            int step_z = dir_z >= 0.0f ? 1 : -1;
+            float delta_x = dir_x != 0.0f ? fabsf(1.0f / dir_x) : 1e30f;
+            float delta_z = dir_z != 0.0f ? fabsf(1.0f / dir_z) : 1e30f;
+            float side_x = 0.5f * delta_x;     // Desde el centro de la celda hasta su borde
+            float side_z = 0.5f * delta_z;
+
+            float travelled = 0.0f;
+            while (travelled <= PVS_MAX_DISTANCE && maze_in_bounds(cell_x, cell_z)) {
+                cells++;
+                if (maze_cell(cell_x, cell_z) == 1) break;
+                if (side_x < side_z) {
+                    travelled = side_x;
+                    side_x += delta_x;
+                    cell_x += step_x;
+                } else {
+                    travelled = side_z;
+                    side_z += delta_z;
+                    cell_z += step_z;
+                }
+            }
+        }
+    }
+    return cells;
+}
+
+// Misma semilla y tamaño en cada disposición: el mapa generado es idéntico y solo
+// cambia el orden de las celdas en memoria
+static LayoutBenchmark benchmark_layout(int size, MapLayout layout) {
+    LayoutBenchmark result;
+    memset(&result, 0, sizeof(result));
+    result.size = size;
+    result.layout = layout;
+
+    // visited cubre también el relleno de los bloques incompletos
+    int padded = (size + MAP_TILE_SIZE - 1) & ~(MAP_TILE_SIZE - 1);
+    unsigned char* visited = malloc((size_t)padded * padded);
+    int* queue = malloc(sizeof(int) * (size_t)size * size);
+    int* origins = malloc(sizeof(int) * BENCHMARK_LAYOUT_RAY_ORIGINS);
+    if (!visited || !queue || !origins) {
+        printf("  %5dx%-5d sin memoria suficiente\n", size, size);
+        free(visited); free(queue); free(origins);
+        return result;
+    }
+
+    double generate_series[BENCHMARK_LAYOUT_RUNS];
+    double fill_series[BENCHMARK_LAYOUT_RUNS];
+    double raycast_series[BENCHMARK_LAYOUT_RUNS];
+    set_map_size(size, size);
+    set_map_layout(layout);
+
+    for (int run = 0; run < BENCHMARK_LAYOUT_RUNS; run++) {
+        srand(BENCHMARK_SEED);
+        double start = timer_seconds();
+        generate_map();
+        double generated = timer_seconds();
+
+        memset(visited, 0, (size_t)padded * padded);
+        double fill_start = timer_seconds();
+        result.filled = layout_flood_fill(visited, queue);
+        double filled = timer_seconds();
+
+        // Orígenes fijos para la semilla: celdas abiertas al azar
+        srand(BENCHMARK_SEED);
+        int origin_count = 0;
+        for (int attempt = 0; attempt < BENCHMARK_LAYOUT_RAY_ORIGINS * 16 &&
+                              origin_count < BENCHMARK_LAYOUT_RAY_ORIGINS; attempt++) {
+            int x = rand() % size, z = rand() % size;
+            if (maze_cell(x, z) != 1) origins[origin_count++] = (x << 16) | z;
+        }
+        double ray_start = timer_seconds();
+        result.ray_cells = layout_cast_rays(origins, origin_count);
+        double rays_done = timer_seconds();
+
+        generate_series[run] = (generated - start) * 1000.0;
+        fill_series[run] = (filled - fill_start) * 1000.0;
+        raycast_series[run] = (rays_done - ray_start) * 1000.0;
+    }
+    result.walls = (int)count_maze_walls();
+
+    free(visited);
+    free(queue);
+    free(origins);
+
+    result.generate_ms = compute_percentiles(generate_series, BENCHMARK_LAYOUT_RUNS);
+    result.fill_ms = compute_percentiles(fill_series, BENCHMARK_LAYOUT_RUNS);
+    result.raycast_ms = compute_percentiles(raycast_series, BENCHMARK_LAYOUT_RUNS);
+    printf("  %5dx%-5d %-9s %8d muros: generación %8.2f ms | relleno %7.2f ms (%d celdas) | "
+           "rayos %7.2f ms (%ld celdas)\n",
+           size, size, layout == MAP_LAYOUT_TILED ? "bloques" : "lineal", result.walls,
+           result.generate_ms.avg, result.fill_ms.avg, result.filled, result.raycast_ms.avg, result.ray_cells);
+    return result;
+}
+
+// Cadena JSON entre comillas: escapa comillas, barras y caracteres de control
+// (el nombre del renderer y las rutas de Windows pueden traerlos)
+static void write_json_string(FILE* file, const char* text) {
+    fputc('"', file);
+    for (const unsigned char* c = (const unsigned char*)(text ? text : ""); *c; c++) {
+        switch (*c) {
+            case '"':  fputs("\\\"", file); break;
+            case '\\': fputs("\\\\", file); break;
+            case '\n': fputs("\\n", file); break;
+            case '\r': fputs("\\r", file); break;
+            case '\t': fputs("\\t", file); break;
+            default:
+                if (*c < 0x20) fprintf(file, "\\u%04x", *c);
+                else fputc(*c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+static void write_percentiles(FILE* file, const char* name, const Percentiles* p, bool last) {
+    fprintf(file, "        \"%s\": {\"avg\": %.4f, \"min\": %.4f, \"max\": %.4f, "
+                  "\"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f}%s\n",
+            name, p->avg, p->min, p->max, p->p50, p->p95, p->p99, last ? "" : ",");
+}
+
+// Resultados en JSON: resumen con percentiles y todas las medidas por frame
+static void write_benchmark_json(const char* filename, const BenchmarkResult* results, int count,
+                                 const ParticleBenchmark* particle_results, int particle_count_steps,
+                                 const ConnectivityBenchmark* connectivity_results, int connectivity_steps,
+                                 const LayoutBenchmark* layout_results, int layout_steps) {
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        printf("No se pudo escribir %s\n", filename);
+        return;
+    }
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"seed\": %u,\n", map_seed);
+    fprintf(file, "  \"renderer\": ");
+    write_json_string(file, (const char*)glGetString(GL_RENDERER));
+    fprintf(file, ",\n");
+    fprintf(file, "  \"width\": %d,\n  \"height\": %d,\n", windowWidth, windowHeight);
+    fprintf(file, "  \"frames\": %d,\n  \"warmup\": %d,\n", BENCHMARK_FRAMES, BENCHMARK_WARMUP);
+    fprintf(file, "  \"camera_path\": ");
+    write_json_string(file, camera_path_source);
+    fprintf(file, ",\n");
+    fprintf(file, "  \"gpu_timer\": %s,\n", gl_has_timer_query ? "true" : "false");
+    fprintf(file, "  \"bake_ms\": {\"pvs\": %.3f, \"light_visibility\": %.3f, \"lightmaps\": %.3f},\n",
+            pvs_bake_ms, light_visibility_bake_ms, lightmap_bake_ms);
+    fprintf(file, "  \"particles\": [\n");
+    for (int p = 0; p < particle_count_steps; p++) {
+        const ParticleBenchmark* result = &particle_results[p];
+        fprintf(file, "    {\n");
+        fprintf(file, "      \"count\": %d,\n      \"visible\": %d,\n", result->count, result->visible);
+        write_percentiles(file, "sort_ms", &result->sort_ms, false);
+        write_percentiles(file, "upload_ms", &result->upload_ms, true);
+        fprintf(file, "    }%s\n", p + 1 < particle_count_steps ? "," : "");
+    }
+    fprintf(file, "  ],\n");
+    fprintf(file, "  \"connectivity\": [\n");
+    for (int c = 0; c < connectivity_steps; c++) {
+        const ConnectivityBenchmark* result = &connectivity_results[c];
+        fprintf(file, "    {\n");
+        fprintf(file, "      \"size\": %d,\n      \"regions\": %d,\n      \"carved\": %d,\n"
+                      "      \"filled\": %d,\n      \"open_cells\": %d,\n",
+                result->size, result->regions, result->carved, result->filled, result->open_cells);
+        write_percentiles(file, "label_ms", &result->label_ms, false);
+        write_percentiles(file, "join_ms", &result->join_ms, false);
+        write_percentiles(file, "fill_ms", &result->fill_ms, true);
+        fprintf(file, "    }%s\n", c + 1 < connectivity_steps ? "," : "");
+    }
+    fprintf(file, "  ],\n");
+    fprintf(file, "  \"map_layout\": [\n");
+    for (int l = 0; l < layout_steps; l++) {
+        const LayoutBenchmark* result = &layout_results[l];
+        fprintf(file, "    {\n");
+        fprintf(file, "      \"size\": %d,\n      \"layout\": \"%s\",\n      \"walls\": %d,\n"
+                      "      \"filled\": %d,\n      \"ray_cells\": %ld,\n",
+                result->size, result->layout == MAP_LAYOUT_TILED ? "tiled" : "linear",
+                result->walls, result->filled, result->ray_cells);
+        write_percentiles(file, "generate_ms", &result->generate_ms, false);
+        write_percentiles(file, "fill_ms", &result->fill_ms, false);
+        write_percentiles(file, "raycast_ms", &result->raycast_ms, true);
+        fprintf(file, "    }%s\n", l + 1 < layout_steps ? "," : "");
+    }
+    fprintf(file, "  ],\n");
+    fprintf(file, "  \"passes\": [\n");
+    for (int r = 0; r < count; r++) {
+        const BenchmarkResult* result = &results[r];
+        fprintf(file, "    {\n");
+        fprintf(file, "      \"name\": ");
+        write_json_string(file, result->name);
+        fprintf(file, ",\n");
+        fprintf(file, "      \"mode\": %d,\n", result->mode);
+        fprintf(file, "      \"summary\": {\n");
+        write_percentiles(file, "cpu_ms", &result->cpu, false);
+        write_percentiles(file, "gpu_ms", &result->gpu, false);
+        write_percentiles(file, "frame_ms", &result->frame, false);
+        write_percentiles(file, "draw_calls", &result->draw_calls, false);
+        write_percentiles(file, "vertices", &result->vertices, true);
+        fprintf(file, "      },\n");
+        fprintf(file, "      \"per_frame\": [\n");
+        for (int i = 0; i < BENCHMARK_FRAMES && result->samples; i++) {
+            const FrameSample* s = &result->samples[i];
+            fprintf(file, "        {\"cpu_ms\": %.4f, \"gpu_ms\": %.4f, \"frame_ms\": %.4f, "
+                          "\"draw_calls\": %ld, \"vertices\": %ld}%s\n",
+                    s->cpu_ms, s->gpu_ms, s->frame_ms, s->draw_calls, s->vertices,
+                    i + 1 < BENCHMARK_FRAMES ? "," : "");
+        }
+        fprintf(file, "      ]\n");
+        fprintf(file, "    }%s\n", r + 1 < count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    printf("  Resultados por frame guardados en %s\n", filename);
+}
+
+void run_render_benchmark(GLFWwindow* window, const char* json_path, const char* camera_path_file) {
+    // Sin vsync para medir el coste real del frame
+    if (window) glfwSwapInterval(0);
+
+    int saved_mode = wall_render_mode;
+    Player3D saved_player = player;
+
+    if (!camera_path_file || !load_camera_path(camera_path_file)) build_flythrough();
+
+    // El renderer permite comparar drivers (p. ej. Mesa llvmpipe con LIBGL_ALWAYS_SOFTWARE=1)
+    printf("=== BENCHMARK DE RENDER (semilla %u, %d frames, %dx%d) ===\n",
+           map_seed, BENCHMARK_FRAMES, windowWidth, windowHeight);
+    printf("  Renderer: %s\n", (const char*)glGetString(GL_RENDERER));
+    printf("  Recorrido: %s (%d poses)\n", camera_path_source, camera_path_length);
+    printf("  Iluminación por clusters: %s\n",
+           clustered_lighting_ready ? "activa" : "no disponible (iluminación fija)");
+    printf("  Lightmaps: %s\n", lightmaps_ready ? "horneados (ruta de chunks)" : "no disponibles");
+
+    BenchmarkResult results[3];
+    int result_count = 0;
+    results[result_count++] = benchmark_pass(window, "Modo inmediato", WALL_RENDER_IMMEDIATE);
+    results[result_count++] = benchmark_pass(window, "Chunks en VBO", WALL_RENDER_CHUNKS);
+    const BenchmarkResult* before = &results[0];
+    const BenchmarkResult* after = &results[1];
+
+    if (after->frame.avg > 0.0) {
+        printf("  Aceleración: %.2fx (media), %.2fx (p95)\n",
+               before->frame.avg / after->frame.avg, before->frame.p95 / after->frame.p95);
+    }
+
+    if (instancing_ready) {
+        results[result_count++] = benchmark_pass(window, "Instanciado", WALL_RENDER_INSTANCED);
+        const BenchmarkResult* instanced = &results[2];
+        printf("  %-22s %d instancias de muro, %d de decoración en %d llamadas (último frame)\n",
+               "", instancing_stats.wall_instances, instancing_stats.decor_instances,
+               instancing_stats.draw_calls);
+        if (instanced->frame.avg > 0.0) {
+            printf("  Instanciado frente a inmediato: %.2fx (media), frente a chunks: %.2fx\n",
+                   before->frame.avg / instanced->frame.avg, after->frame.avg / instanced->frame.avg);
+        }
+    } else {
+        printf("  Instanciado: no disponible en este driver (ruta de respaldo: chunks)\n");
+    }
+
+    // Partículas: radix sort por profundidad y subida de billboards
+    printf("  Partículas (orden de atrás hacia delante y subida, %d frames):\n", BENCHMARK_PARTICLE_FRAMES);
+    ParticleBenchmark particle_results[BENCHMARK_PARTICLE_STEPS];
+    for (int i = 0; i < BENCHMARK_PARTICLE_STEPS; i++) {
+        particle_results[i] = benchmark_particles(benchmark_particle_counts[i]);
+    }
+
+    // Conectividad del generador en mapas grandes (sin GPU)
+    printf("  Conectividad (%d%% de muros aleatorios, %d repeticiones):\n",
+           BENCHMARK_CONNECTIVITY_WALLS, BENCHMARK_CONNECTIVITY_RUNS);
+    ConnectivityBenchmark connectivity_results[BENCHMARK_CONNECTIVITY_STEPS];
+    for (int i = 0; i < BENCHMARK_CONNECTIVITY_STEPS; i++) {
+        connectivity_results[i] = benchmark_connectivity(benchmark_connectivity_sizes[i]);
+    }
+
+    // Disposición de la rejilla: lineal frente a bloques de 8x8 con el mismo mapa.
+    // Regenera la rejilla global, así que va al final y luego restaura el mapa medido
+    printf("  Disposición de la rejilla (%d repeticiones, %d orígenes x %d rayos):\n",
+           BENCHMARK_LAYOUT_RUNS, BENCHMARK_LAYOUT_RAY_ORIGINS, BENCHMARK_LAYOUT_RAYS);
+    int saved_width = maze_width, saved_height = maze_height;
+    MapLayout saved_layout = map_layout;
+    map_verbose = false;
+    LayoutBenchmark layout_results[BENCHMARK_LAYOUT_STEPS * 2];
+    for (int i = 0; i < BENCHMARK_LAYOUT_STEPS; i++) {
+        const LayoutBenchmark* linear = &layout_results[i * 2];
+        const LayoutBenchmark* tiled = &layout_results[i * 2 + 1];
+        layout_results[i * 2] = benchmark_layout(benchmark_layout_sizes[i], MAP_LAYOUT_LINEAR);
+        layout_results[i * 2 + 1] = benchmark_layout(benchmark_layout_sizes[i], MAP_LAYOUT_TILED);
+        if (tiled->fill_ms.avg > 0.0 && tiled->raycast_ms.avg > 0.0 && tiled->generate_ms.avg > 0.0) {
+            printf("  %-21s bloques frente a lineal: generación %.2fx | relleno %.2fx | rayos %.2fx\n", "",
+                   linear->generate_ms.avg / tiled->generate_ms.avg, linear->fill_ms.avg / tiled->fill_ms.avg,
+                   linear->raycast_ms.avg / tiled->raycast_ms.avg);
+        }
+    }
+    set_map_size(saved_width, saved_height);
+    set_map_layout(saved_layout);
+    srand(map_seed);
+    generate_map();
+    map_verbose = true;
+
+    if (json_path) {
+        write_benchmark_json(json_path, results, result_count, particle_results, BENCHMARK_PARTICLE_STEPS,
+                             connectivity_results, BENCHMARK_CONNECTIVITY_STEPS,
+                             layout_results, BENCHMARK_LAYOUT_STEPS * 2);
+    }
+    printf("=== FIN DEL BENCHMARK ===\n");
+
+    for (int i = 0; i < result_count; i++) free(results[i].samples);
+    free(camera_path);
+    camera_path = NULL;
+    camera_path_length = 0;
+
+    wall_render_mode = saved_mode;
+    player = saved_player;
+    if (window) glfwSwapInterval(1);
+}
+
+bool benchmark_start_recording(const char* filename) {
+    record_file = fopen(filename, "w");
+    if (!record_file) {
+        printf("No se pudo crear el recorrido %s\n", filename);
+        return false;
+    }
+    printf("Grabando recorrido de cámara en %s\n", filename);
+    return true;
+}
+
+void benchmark_record_pose() {
+    if (!record_file) return;
+    fprintf(record_file, "%.4f %.4f %.4f %.5f %.5f\n",
+            player.x, player.y, player.z, player.yaw, player.pitch);
+}
+
+void benchmark_stop_recording() {
+    if (!record_file) return;
+    fclose(record_file);
+    record_file = NULL;
+}
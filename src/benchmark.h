@@ -0,0 +1,35 @@
+// benchmark.h - Medición reproducible del tiempo de frame
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include <stdbool.h>
+
+// Parámetros del benchmark
+#define BENCHMARK_SEED 1337u      // Semilla fija del mapa
+#define BENCHMARK_FRAMES 600      // Frames medidos por ruta de render
+#define BENCHMARK_WARMUP 30       // Frames descartados antes de medir
+#define BENCHMARK_WIDTH 1280      // Resolución del modo sin ventana
+#define BENCHMARK_HEIGHT 720
+#define BENCHMARK_PATH_SPEED 0.25f    // Celdas por frame del recorrido generado
+#define BENCHMARK_LOOK_AHEAD 4        // Celdas por delante a las que mira la cámara
+#define BENCHMARK_JSON_FILE "benchmark.json"
+#define BENCHMARK_PARTICLE_FRAMES 120     // Frames medidos por cantidad de partículas
+#define BENCHMARK_PARTICLE_RADIUS 8.0f    // Radio de la nube de partículas alrededor de la cámara
+#define BENCHMARK_CONNECTIVITY_RUNS 3     // Repeticiones por tamaño de mapa
+#define BENCHMARK_CONNECTIVITY_WALLS 40   // Porcentaje de muros de la rejilla aleatoria
+#define BENCHMARK_LAYOUT_RUNS 3           // Repeticiones por tamaño y disposición de la rejilla
+#define BENCHMARK_LAYOUT_RAY_ORIGINS 2048 // Celdas abiertas desde las que se lanzan rayos
+#define BENCHMARK_LAYOUT_RAYS 32          // Rayos por celda de origen
+
+// Funciones de benchmark (window puede ser NULL en el modo sin ventana;
+// json_path y camera_path_file son opcionales)
+void run_render_benchmark(GLFWwindow* window, const char* json_path, const char* camera_path_file);
+
+// Grabación de un recorrido de cámara durante la partida (una pose por tick)
+bool benchmark_start_recording(const char* filename);
+void benchmark_record_pose();
+void benchmark_stop_recording();
+
+#endif // BENCHMARK_H
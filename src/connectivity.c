@@ -0,0 +1,286 @@
+// connectivity.c - Regiones conectadas del laberinto (relleno por scanlines y union-find)
+#include "connectivity.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Semilla pendiente del relleno: una celda de la columna vecina de un tramo
+typedef struct {
+    int x, z;
+} FillSeed;
+
+static bool is_open(const unsigned char* grid, int height, MapLayout layout, int x, int z) {
+    return !(grid[grid_index(layout, height, x, z)] & CONNECTIVITY_WALL);
+}
+
+// Coordenadas de la celda en la posición i de la rejilla (inversa de grid_index)
+static void grid_coords(MapLayout layout, int height, int i, int* x, int* z) {
+    if (layout == MAP_LAYOUT_TILED) {
+        int tiles_z = (height + MAP_TILE_SIZE - 1) >> MAP_TILE_SHIFT;
+        int tile = i >> (2 * MAP_TILE_SHIFT);
+        *x = ((tile / tiles_z) << MAP_TILE_SHIFT) | ((i >> MAP_TILE_SHIFT) & (MAP_TILE_SIZE - 1));
+        *z = ((tile % tiles_z) << MAP_TILE_SHIFT) | (i & (MAP_TILE_SIZE - 1));
+        return;
+    }
+    *x = i / height;
+    *z = i % height;
+}
+
+// Apila el inicio de cada tramo abierto y sin visitar de la columna x entre z0 y z1
+static bool push_column_seeds(FillSeed** stack, int* count, int* capacity,
+                              const unsigned char* grid, int height, MapLayout layout,
+                              int x, int z0, int z1, const unsigned char* visited) {
+    bool in_run = false;
+    for (int z = z0; z <= z1; z++) {
+        int i = grid_index(layout, height, x, z);
+        bool open = !(grid[i] & CONNECTIVITY_WALL) && !visited[i];
+        if (open && !in_run) {
+            if (*count == *capacity) {
+                int grown = *capacity * 2;
+                FillSeed* bigger = realloc(*stack, sizeof(FillSeed) * grown);
+                if (!bigger) return false;
+                *stack = bigger;
+                *capacity = grown;
+            }
+            (*stack)[(*count)++] = (FillSeed){x, z};
+        }
+        in_run = open;
+    }
+    return true;
+}
+
+// Celda abierta y sin visitar
+static bool fill_candidate(const unsigned char* grid, int height, MapLayout layout, int x, int z,
+                           const unsigned char* visited) {
+    int i = grid_index(layout, height, x, z);
+    return !(grid[i] & CONNECTIVITY_WALL) && !visited[i];
+}
+
+// Rellena tramos contiguos en z (memoria contigua en la disposición lineal y dentro
+// de cada bloque en la de bloques) y solo apila una semilla por tramo vecino:
+// la pila crece con el contorno, no con el área
+int scanline_fill(const unsigned char* grid, int width, int height, MapLayout layout,
+                  int x, int z, unsigned char* visited) {
+    if (x < 0 || x >= width || z < 0 || z >= height) return 0;
+    if (!is_open(grid, height, layout, x, z) || visited[grid_index(layout, height, x, z)]) return 0;
+
+    int capacity = 256;
+    int count = 0;
+    FillSeed* stack = malloc(sizeof(FillSeed) * capacity);
+    if (!stack) return 0;
+    stack[count++] = (FillSeed){x, z};
+
+    int filled = 0;
+    while (count > 0) {
+        FillSeed seed = stack[--count];
+        if (visited[grid_index(layout, height, seed.x, seed.z)]) continue;
+
+        // Extender el tramo hacia ambos lados de la columna
+        int z0 = seed.z, z1 = seed.z;
+        while (z0 > 0 && fill_candidate(grid, height, layout, seed.x, z0 - 1, visited)) z0--;
+        while (z1 < height - 1 && fill_candidate(grid, height, layout, seed.x, z1 + 1, visited)) z1++;
+        if (layout == MAP_LAYOUT_LINEAR) {
+            memset(&visited[seed.x * height + z0], 1, (size_t)(z1 - z0 + 1));
+        } else {
+            for (int cz = z0; cz <= z1; cz++) visited[grid_index(layout, height, seed.x, cz)] = 1;
+        }
+        filled += z1 - z0 + 1;
+
+        if ((seed.x > 0 && !push_column_seeds(&stack, &count, &capacity, grid, height, layout,
+                                              seed.x - 1, z0, z1, visited)) ||
+            (seed.x < width - 1 && !push_column_seeds(&stack, &count, &capacity, grid, height, layout,
+                                                      seed.x + 1, z0, z1, visited))) {
+            break;  // Sin memoria: el relleno queda incompleto
+        }
+    }
+
+    free(stack);
+    return filled;
+}
+
+// Raíz de la etiqueta con compresión de camino (cada nodo salta a su abuelo)
+static int find_root(int* parent, int label) {
+    while (parent[label] != label) {
+        parent[label] = parent[parent[label]];
+        label = parent[label];
+    }
+    return label;
+}
+
+static int union_labels(int* parent, int a, int b) {
+    a = find_root(parent, a);
+    b = find_root(parent, b);
+    if (a == b) return a;
+    // La raíz menor sobrevive: las etiquetas finales siguen el orden de recorrido
+    if (a < b) { parent[b] = a; return a; }
+    parent[a] = b;
+    return b;
+}
+
+int label_components(const unsigned char* grid, int width, int height, MapLayout layout, int* labels) {
+    int cells = width * height;
+    // Con vecindad 4 hay como mucho una etiqueta provisional por cada dos celdas
+    int* parent = malloc(sizeof(int) * (cells / 2 + 2));
+    if (!parent) return 0;
+    int provisional = 0;
+
+    // Pasada única: cada celda abierta hereda la etiqueta de la celda anterior de
+    // su columna o de la columna anterior, y une ambas si las dos son abiertas
+    for (int x = 0; x < width; x++) {
+        for (int z = 0; z < height; z++) {
+            int i = grid_index(layout, height, x, z);
+            if (grid[i] & CONNECTIVITY_WALL) {
+                labels[i] = CONNECTIVITY_NO_LABEL;
+                continue;
+            }
+            int up = z > 0 ? labels[grid_index(layout, height, x, z - 1)] : CONNECTIVITY_NO_LABEL;
+            int left = x > 0 ? labels[grid_index(layout, height, x - 1, z)] : CONNECTIVITY_NO_LABEL;
+
+            if (up == CONNECTIVITY_NO_LABEL && left == CONNECTIVITY_NO_LABEL) {
+                parent[provisional] = provisional;
+                labels[i] = provisional++;
+            } else if (up == CONNECTIVITY_NO_LABEL) {
+                labels[i] = left;
+            } else if (left == CONNECTIVITY_NO_LABEL || left == up) {
+                labels[i] = up;
+            } else {
+                labels[i] = union_labels(parent, up, left);
+            }
+        }
+    }
+
+    // Raíces a etiquetas consecutivas; la resolución final recorre la rejilla en orden
+    int count = 0;
+    for (int l = 0; l < provisional; l++) {
+        if (parent[l] == l) {
+            parent[l] = -(++count);     // Raíz: etiqueta final codificada en negativo
+        }
+    }
+    for (int l = 0; l < provisional; l++) {
+        int root = l;
+        while (parent[root] >= 0) root = parent[root];
+        parent[l] = parent[root];
+    }
+    for (int x = 0; x < width; x++) {
+        for (int z = 0; z < height; z++) {
+            int i = grid_index(layout, height, x, z);
+            if (labels[i] != CONNECTIVITY_NO_LABEL) labels[i] = -parent[labels[i]] - 1;
+        }
+    }
+
+    free(parent);
+    return count;
+}
+
+// Dirección desde la que se llegó a cada celda en la búsqueda de uniones
+enum {
+    JOIN_UNSEEN = 0,
+    JOIN_SOURCE,
+    JOIN_FROM_LEFT,     // Desde (x - 1, z)
+    JOIN_FROM_RIGHT,    // Desde (x + 1, z)
+    JOIN_FROM_BELOW,    // Desde (x, z - 1)
+    JOIN_FROM_ABOVE     // Desde (x, z + 1)
+};
+
+int join_components(unsigned char* grid, int width, int height, MapLayout layout,
+                    const int* labels, int count, int main_label) {
+    if (count <= 1 || main_label < 0 || main_label >= count) return 0;
+
+    // Arrays con la disposición de la rejilla (las celdas de relleno de los bloques no se usan)
+    int cells = grid_storage_cells(layout, width, height);
+    int* cost = malloc(sizeof(int) * cells);
+    int* queue = malloc(sizeof(int) * cells);
+    unsigned char* from = calloc((size_t)cells, 1);
+    int* best_cell = malloc(sizeof(int) * count);
+    if (!cost || !queue || !from || !best_cell) {
+        free(cost); free(queue); free(from); free(best_cell);
+        return -1;
+    }
+
+    // Búsqueda 0-1 desde la región principal: entrar en una celda abierta cuesta 0
+    // y atravesar un muro cuesta 1, así cost[] es el mínimo de muros a abrir.
+    // La cola es circular de doble extremo (coste 0 delante, coste 1 detrás)
+    int head = 0, size = 0;
+    for (int x = 0; x < width; x++) {
+        for (int z = 0; z < height; z++) {
+            int i = grid_index(layout, height, x, z);
+            cost[i] = -1;
+            if (labels[i] == main_label) {
+                cost[i] = 0;
+                from[i] = JOIN_SOURCE;
+                queue[size++] = i;
+            }
+        }
+    }
+    for (int c = 0; c < count; c++) best_cell[c] = -1;
+
+    static const int step_x[4] = {-1, 1, 0, 0};
+    static const int step_z[4] = {0, 0, -1, 1};
+    static const unsigned char step_from[4] = {JOIN_FROM_RIGHT, JOIN_FROM_LEFT, JOIN_FROM_ABOVE, JOIN_FROM_BELOW};
+
+    // El coste depende solo de la celda a la que se entra y la cola sale en orden
+    // de coste: el primer coste asignado a una celda ya es el mínimo
+    while (size > 0) {
+        int i = queue[head];
+        if (++head == cells) head = 0;
+        size--;
+
+        // La primera celda extraída de cada región es la de menor coste
+        int label = labels[i];
+        if (label != CONNECTIVITY_NO_LABEL && best_cell[label] < 0) best_cell[label] = i;
+
+        int x, z;
+        grid_coords(layout, height, i, &x, &z);
+        for (int d = 0; d < 4; d++) {
+            int nx = x + step_x[d], nz = z + step_z[d];
+            if (nx < 0 || nx >= width || nz < 0 || nz >= height) continue;
+            int n = grid_index(layout, height, nx, nz);
+            if (cost[n] >= 0) continue;
+            bool wall = (grid[n] & CONNECTIVITY_WALL) != 0;
+            // Los muros del borde nunca se abren
+            if (wall && (nx == 0 || nz == 0 || nx == width - 1 || nz == height - 1)) continue;
+
+            from[n] = step_from[d];
+            if (wall) {
+                cost[n] = cost[i] + 1;
+                int tail = head + size++;
+                queue[tail >= cells ? tail - cells : tail] = n;
+            } else {
+                cost[n] = cost[i];
+                head = head == 0 ? cells - 1 : head - 1;
+                queue[head] = n;
+                size++;
+            }
+        }
+    }
+
+    // Abrir el camino de cada región hasta la principal siguiendo las direcciones.
+    // Las celdas recorridas pasan a ser origen: el siguiente camino que llegue a
+    // ellas ya está conectado y se detiene ahí
+    int carved = 0;
+    for (int c = 0; c < count; c++) {
+        if (c == main_label || best_cell[c] < 0) continue;
+        for (int i = best_cell[c]; from[i] != JOIN_SOURCE; ) {
+            if (grid[i] & CONNECTIVITY_WALL) {
+                grid[i] &= (unsigned char)~CONNECTIVITY_WALL;
+                carved++;
+            }
+            unsigned char step = from[i];
+            from[i] = JOIN_SOURCE;
+            int x, z;
+            grid_coords(layout, height, i, &x, &z);
+            switch (step) {
+                case JOIN_FROM_LEFT:  x--; break;
+                case JOIN_FROM_RIGHT: x++; break;
+                case JOIN_FROM_BELOW: z--; break;
+                default:              z++; break;
+            }
+            i = grid_index(layout, height, x, z);
+        }
+    }
+
+    free(cost);
+    free(queue);
+    free(from);
+    free(best_cell);
+    return carved;
+}
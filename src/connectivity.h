@@ -0,0 +1,28 @@
+// connectivity.h - Regiones conectadas del laberinto (relleno por scanlines y union-find)
+#ifndef CONNECTIVITY_H
+#define CONNECTIVITY_H
+
+#include <stdbool.h>
+#include "map.h"
+
+// Las funciones reciben la rejilla con su disposición (la de maze_cells u otra):
+// celda (x, z) en grid[grid_index(layout, height, x, z)], muro si tiene el bit
+// CONNECTIVITY_WALL. visited[] y labels[] usan la misma disposición y tamaño
+#define CONNECTIVITY_WALL 0x01
+#define CONNECTIVITY_NO_LABEL -1
+
+// Relleno iterativo por tramos desde (x, z): marca visited[] y devuelve las celdas alcanzadas
+int scanline_fill(const unsigned char* grid, int width, int height, MapLayout layout,
+                  int x, int z, unsigned char* visited);
+
+// Etiqueta cada celda abierta con su región (0..n-1) en una pasada con union-find;
+// los muros quedan en CONNECTIVITY_NO_LABEL. Devuelve el número de regiones
+int label_components(const unsigned char* grid, int width, int height, MapLayout layout, int* labels);
+
+// Une todas las regiones con la de 'main_label' abriendo el mínimo de muros por región
+// (búsqueda 0-1 desde la región principal; el borde del mapa no se abre).
+// Devuelve los muros abiertos o -1 sin memoria
+int join_components(unsigned char* grid, int width, int height, MapLayout layout,
+                    const int* labels, int count, int main_label);
+
+#endif // CONNECTIVITY_H
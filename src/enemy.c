@@ -3,6 +3,7 @@
 #include "player.h"
 #include "map.h"
 #include "render.h"
+#include "gl_ext.h"
 #include "audio.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -16,28 +17,99 @@
 // Variable global del enemigo
 Enemy enemy;
 
+// Cubo (normal y posición, lado 2) y aura (radio 1 en y = 0) en un solo buffer
+static float enemy_vertices[(ENEMY_CUBE_VERTICES + ENEMY_AURA_VERTICES) * 6];
+static GLuint enemy_vbo = 0;
+static bool enemy_mesh_ready = false;
+
+static float* put_enemy_vertex(float* v, float nx, float ny, float nz, float x, float y, float z) {
+    v[0] = nx; v[1] = ny; v[2] = nz;
+    v[3] = x; v[4] = y; v[5] = z;
+    return v + 6;
+}
+
+static void bake_enemy_mesh() {
+    if (enemy_mesh_ready) return;
+    float* v = enemy_vertices;
+
+    // Cara frontal (Z+)
+    v = put_enemy_vertex(v, 0, 0, 1, -1, -1, 1);
+    v = put_enemy_vertex(v, 0, 0, 1, 1, -1, 1);
+    v = put_enemy_vertex(v, 0, 0, 1, 1, 1, 1);
+    v = put_enemy_vertex(v, 0, 0, 1, -1, 1, 1);
+    // Cara trasera (Z-)
+    v = put_enemy_vertex(v, 0, 0, -1, -1, -1, -1);
+    v = put_enemy_vertex(v, 0, 0, -1, -1, 1, -1);
+    v = put_enemy_vertex(v, 0, 0, -1, 1, 1, -1);
+    v = put_enemy_vertex(v, 0, 0, -1, 1, -1, -1);
+    // Cara izquierda (X-)
+    v = put_enemy_vertex(v, -1, 0, 0, -1, -1, -1);
+    v = put_enemy_vertex(v, -1, 0, 0, -1, -1, 1);
+    v = put_enemy_vertex(v, -1, 0, 0, -1, 1, 1);
+    v = put_enemy_vertex(v, -1, 0, 0, -1, 1, -1);
+    // Cara derecha (X+)
+    v = put_enemy_vertex(v, 1, 0, 0, 1, -1, -1);
+    v = put_enemy_vertex(v, 1, 0, 0, 1, 1, -1);
+    v = put_enemy_vertex(v, 1, 0, 0, 1, 1, 1);
+    v = put_enemy_vertex(v, 1, 0, 0, 1, -1, 1);
+    // Cara superior (Y+)
+    v = put_enemy_vertex(v, 0, 1, 0, -1, 1, -1);
+    v = put_enemy_vertex(v, 0, 1, 0, -1, 1, 1);
+    v = put_enemy_vertex(v, 0, 1, 0, 1, 1, 1);
+    v = put_enemy_vertex(v, 0, 1, 0, 1, 1, -1);
+    // Cara inferior (Y-)
+    v = put_enemy_vertex(v, 0, -1, 0, -1, -1, -1);
+    v = put_enemy_vertex(v, 0, -1, 0, 1, -1, -1);
+    v = put_enemy_vertex(v, 0, -1, 0, 1, -1, 1);
+    v = put_enemy_vertex(v, 0, -1, 0, -1, -1, 1);
+
+    // Aura: abanico con el centro y el anillo cerrado (el último punto repite el primero)
+    v = put_enemy_vertex(v, 0, 1, 0, 0, 0, 0);
+    for (int i = 0; i <= ENEMY_AURA_SEGMENTS; i++) {
+        float angle = 2.0f * M_PI * i / ENEMY_AURA_SEGMENTS;
+        v = put_enemy_vertex(v, 0, 1, 0, cosf(angle), 0, sinf(angle));
+    }
+
+    if (gl_has_vbo) {
+        glGenBuffers(1, &enemy_vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, enemy_vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(enemy_vertices), enemy_vertices, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    enemy_mesh_ready = true;
+}
+
+void update_enemy_metrics() {
+    enemy.to_player_x = player.x - enemy.x;
+    enemy.to_player_z = player.z - enemy.z;
+    enemy.distance_to_player = sqrtf(enemy.to_player_x * enemy.to_player_x +
+                                     enemy.to_player_z * enemy.to_player_z);
+}
+
 void init_enemy() {
     // Inicializar enemigo en una posición aleatoria lejos del jugador
     srand((unsigned int)time(NULL));
     
     int attempts = 0;
     do {
-        enemy.x = (rand() % (MAZE_WIDTH - 20)) + 10;
-        enemy.z = (rand() % (MAZE_HEIGHT - 20)) + 10;
+        enemy.x = (rand() % (maze_width - 20)) + 10;
+        enemy.z = (rand() % (maze_height - 20)) + 10;
         attempts++;
-    } while ((sqrt((enemy.x - player.x) * (enemy.x - player.x) + 
-                   (enemy.z - player.z) * (enemy.z - player.z)) < 30.0f ||
+    } while (((enemy.x - player.x) * (enemy.x - player.x) + 
+              (enemy.z - player.z) * (enemy.z - player.z) < 30.0f * 30.0f ||
              is_wall((int)enemy.x, (int)enemy.z)) && attempts < 100);
     
     // Si no se encontró una posición válida después de 100 intentos, usar posición por defecto
     if (attempts >= 100) {
-        enemy.x = MAZE_WIDTH / 2.0f;
-        enemy.z = MAZE_HEIGHT / 2.0f;
+        enemy.x = maze_width / 2.0f;
+        enemy.z = maze_height / 2.0f;
         printf("ADVERTENCIA: Enemigo colocado en posición por defecto\n");
     }
     
     enemy.target_x = enemy.x;
     enemy.target_z = enemy.z;
+    enemy.previous_x = enemy.x;
+    enemy.previous_z = enemy.z;
     enemy.speed = 0.05f; // Velocidad aumentada para mapa gigante
     enemy.active = true;
     enemy.is_hunting = false;
@@ -58,8 +130,8 @@ void init_enemy() {
     // Nuevo sistema de comportamiento escalonado
     enemy.phase = 0; // 0 = Teletransporte aleatorio, 1 = Acercamiento gradual
     enemy.phase_timer = 0;
-    enemy.phase_duration = 3600; // 1 minuto = 3600 frames (60 FPS)
-    enemy.teleport_frequency = 600; // Teletransportarse cada 10 segundos en fase 0
+    enemy.phase_duration = 60 * SIMULATION_TICK_RATE; // 1 minuto en ticks de simulación
+    enemy.teleport_frequency = 10 * SIMULATION_TICK_RATE; // Teletransportarse cada 10 segundos en fase 0
     enemy.last_teleport = 0;
     
     // Inicializar sistema de IA probabilística
@@ -68,6 +140,9 @@ void init_enemy() {
     enemy.decision_cooldown = 0;
     enemy.last_distance = 999.0f;
     enemy.is_deciding = false;
+    update_enemy_metrics();
+    
+    bake_enemy_mesh();
     
     printf("Enemigo inicializado en posición (%.1f, %.1f) - FASE: Teletransporte Aleatorio\n", enemy.x, enemy.z);
 }
@@ -75,13 +150,17 @@ void init_enemy() {
 void update_enemy() {
     if (!enemy.active) return;
     
+    // Posición de partida del tick para interpolar el render
+    enemy.previous_x = enemy.x;
+    enemy.previous_z = enemy.z;
+    
     // Actualizar temporizadores
     enemy.behavior_timer++;
     enemy.phase_timer++;
     
-    // Calcular distancia al jugador
-    float distance_to_player = sqrt((enemy.x - player.x) * (enemy.x - player.x) + 
-                                   (enemy.z - player.z) * (enemy.z - player.z));
+    // Distancia al jugador (el jugador ya se movió en este tick)
+    update_enemy_metrics();
+    float distance_to_player = enemy.distance_to_player;
     
     // SISTEMA DE IA PROBABILÍSTICA
     // Llamar al sistema de decisión probabilística
@@ -109,16 +188,20 @@ void update_enemy() {
                 int attempts = 0;
                 do {
                     // Teletransportarse a posición aleatoria en el mapa
-                    enemy.x = (rand() % (MAZE_WIDTH - 20)) + 10;
-                    enemy.z = (rand() % (MAZE_HEIGHT - 20)) + 10;
+                    enemy.x = (rand() % (maze_width - 20)) + 10;
+                    enemy.z = (rand() % (maze_height - 20)) + 10;
                     attempts++;
                 } while (is_wall((int)enemy.x, (int)enemy.z) && attempts < 50);
                 
+                // Un teletransporte no se interpola
+                enemy.previous_x = enemy.x;
+                enemy.previous_z = enemy.z;
                 enemy.last_teleport = enemy.behavior_timer;
+                update_enemy_metrics();
                 
                 // Mostrar progreso cada 10 segundos
-                int remaining_time = (enemy.phase_duration - enemy.phase_timer) / 60;
-                if (enemy.phase_timer % 600 == 0) {
+                int remaining_time = (enemy.phase_duration - enemy.phase_timer) / SIMULATION_TICK_RATE;
+                if (enemy.phase_timer % (10 * SIMULATION_TICK_RATE) == 0) {
                     printf("ENEMIGO: Teletransporte aleatorio - Tiempo restante: %d segundos\n", remaining_time);
                 }
                 
@@ -128,11 +211,11 @@ void update_enemy() {
         }
     } else if (enemy.phase == 1) {
         // FASE 1: Acercamiento gradual
-        if (enemy.behavior_timer % 180 == 0) { // Cada 3 segundos
-            // Calcular dirección hacia el jugador
-            float dx = player.x - enemy.x;
-            float dz = player.z - enemy.z;
-            float distance = sqrt(dx * dx + dz * dz);
+        if (enemy.behavior_timer % (3 * SIMULATION_TICK_RATE) == 0) { // Cada 3 segundos
+            // Dirección hacia el jugador
+            float dx = enemy.to_player_x;
+            float dz = enemy.to_player_z;
+            float distance = enemy.distance_to_player;
             
             if (distance > 0.0f) {
                 // Normalizar dirección
@@ -140,7 +223,7 @@ void update_enemy() {
                 dz /= distance;
                 
                 // Calcular distancia de acercamiento basada en el tiempo en fase 1
-                float phase_progress = (float)enemy.phase_timer / 1800.0f; // 30 segundos para acercamiento completo
+                float phase_progress = (float)enemy.phase_timer / (30.0f * SIMULATION_TICK_RATE); // 30 segundos para acercamiento completo
                 if (phase_progress > 1.0f) phase_progress = 1.0f;
                 
                 // Distancia de acercamiento: de 50 unidades a 5 unidades
@@ -154,19 +237,20 @@ void update_enemy() {
                 
                 // Asegurar que esté dentro del mapa
                 if (new_x < 5) new_x = 5;
-                if (new_x > MAZE_WIDTH - 5) new_x = MAZE_WIDTH - 5;
+                if (new_x > maze_width - 5) new_x = maze_width - 5;
                 if (new_z < 5) new_z = 5;
-                if (new_z > MAZE_HEIGHT - 5) new_z = MAZE_HEIGHT - 5;
+                if (new_z > maze_height - 5) new_z = maze_height - 5;
                 
                 // Verificar que no esté en una pared
                 if (!is_wall((int)new_x, (int)new_z)) {
                     enemy.x = new_x;
                     enemy.z = new_z;
+                    update_enemy_metrics();
                     
                     printf("ENEMIGO: Acercándose - Distancia: %.1f unidades\n", approach_distance);
                     
                     // Reproducir sonido de enemigo cuando se acerca
-                    if (enemy.behavior_timer % 360 == 0) { // Cada 6 segundos
+                    if (enemy.behavior_timer % (6 * SIMULATION_TICK_RATE) == 0) { // Cada 6 segundos
                         play_enemy_sound();
                     }
                 }
@@ -184,14 +268,14 @@ void render_enemy_minimap() {
     float minimapSize = 200.0f;
     float x = windowWidth - minimapSize - 10;
     float y = 10;
-    float scale = minimapSize / MAZE_WIDTH;
+    float scale = minimapSize / maze_width;
     
     // Posición del enemigo en el mini mapa
     float enemyMapX = x + enemy.x * scale;
     float enemyMapY = y + enemy.z * scale;
     
     // Dibujar enemigo como un punto rojo más grande
-    glDisable(GL_BLEND);
+    gl_state_enable(GL_BLEND, false);
     glColor3f(1.0f, 0.0f, 0.0f); // Rojo brillante para el enemigo
     
     // Dibujar círculo del enemigo
@@ -213,140 +297,98 @@ void render_enemy_minimap() {
 void check_enemy_collision() {
     if (!enemy.active) return;
     
-    float distance_to_player = sqrt((enemy.x - player.x) * (enemy.x - player.x) + 
-                                   (enemy.z - player.z) * (enemy.z - player.z));
-    
-    if (distance_to_player <= enemy.attack_range) {
+    if (enemy.distance_to_player <= enemy.attack_range) {
         printf("¡EL ENEMIGO TE HA ALCANZADO! ¡GAME OVER!\n");
         enemy.active = false;
     }
 }
 
 void render_enemy_3d() {
-    if (!enemy.active) return;
+    if (!enemy.active || !enemy_mesh_ready) return;
     
-    // Calcular distancia desde el jugador
-    float distance = sqrt((enemy.x - player.x) * (enemy.x - player.x) + 
-                         (enemy.z - player.z) * (enemy.z - player.z));
+    // Distancia del último tick
+    float distance = enemy.distance_to_player;
     
     // Renderizar si está a menos de 35 unidades (área de carga aumentada)
-    if (distance <= 35.0f) {
+    if (distance <= ENEMY_RENDER_DISTANCE) {
+        bool close = distance <= ENEMY_CLOSE_DISTANCE;
+        // Tiempo de animación en ticks, interpolado entre los dos últimos como la posición
+        float anim_time = (float)(enemy.behavior_timer - 1) + render_alpha;
+        float wave = sinf(anim_time * 0.05f);
+        
         // Configurar iluminación del enemigo
-        float float_height = 2.0f + sin(enemy.behavior_timer * 0.05f) * 0.3f;
+        float float_height = 2.0f + wave * 0.3f;
         setup_enemy_lighting(enemy.x, float_height, enemy.z);
         
         // Configurar material rojo brillante y pulsante
-        float pulse = (sin(enemy.behavior_timer * 0.05f) + 1.0f) * 0.5f; // Pulsación más lenta
+        float pulse = (wave + 1.0f) * 0.5f; // Pulsación más lenta
         float intensity = 1.0f + pulse * 0.5f; // Entre 1.0 y 1.5 (más brillante)
         
-        GLfloat ambient[] = {0.8f * intensity, 0.0f, 0.0f, 1.0f};
-        GLfloat diffuse[] = {1.2f * intensity, 0.0f, 0.0f, 1.0f};
-        GLfloat specular[] = {1.0f * intensity, 0.3f, 0.3f, 1.0f};
-        GLfloat shininess[] = {128.0f};
-        
-        glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, ambient);
-        glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, diffuse);
-        glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, specular);
-        glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, shininess);
-        
-        // Dibujar cubo rojo flotante del enemigo
-        glPushMatrix();
+        GLMaterial material = {
+            {0.8f * intensity, 0.0f, 0.0f, 1.0f},
+            {1.2f * intensity, 0.0f, 0.0f, 1.0f},
+            {1.0f * intensity, 0.3f, 0.3f, 1.0f},
+            128.0f
+        };
+        gl_state_material(&material);
         
         // Animación de acercamiento cuando está cerca
         float approach_animation = 0.0f;
-        if (distance <= 15.0f) {
+        if (close) {
             // Efecto de "respiración" más intenso cuando está cerca
-            approach_animation = sin(enemy.behavior_timer * 0.2f) * 0.5f;
+            approach_animation = sinf(anim_time * 0.2f) * 0.5f;
             float_height += approach_animation;
         }
         
-        glTranslatef(enemy.x, float_height, enemy.z);
-        
         // Rotación más rápida cuando está cerca
-        float rotation_speed = 0.5f;
-        if (distance <= 15.0f) {
-            rotation_speed = 2.0f; // Rotación más rápida cuando está cerca
-        }
-        glRotatef(enemy.behavior_timer * rotation_speed, 0, 1, 0);
+        float rotation_speed = close ? 2.0f : 0.5f;
         
-                // Dibujar cubo rojo más pequeño
-                float size = 0.6f + pulse * 0.2f; // Tamaño pulsante más pequeño
-                
-                // Hacer el cubo un poco más grande cuando está cerca
-                if (distance <= 15.0f) {
-                    size += 0.2f + approach_animation * 0.1f; // Más pequeño cuando está cerca
-                }
-        glBegin(GL_QUADS);
-        
-        // Cara frontal (Z+)
-        glNormal3f(0.0f, 0.0f, 1.0f);
-        glVertex3f(-size, -size, size);
-        glVertex3f(size, -size, size);
-        glVertex3f(size, size, size);
-        glVertex3f(-size, size, size);
-        
-        // Cara trasera (Z-)
-        glNormal3f(0.0f, 0.0f, -1.0f);
-        glVertex3f(-size, -size, -size);
-        glVertex3f(-size, size, -size);
-        glVertex3f(size, size, -size);
-        glVertex3f(size, -size, -size);
-        
-        // Cara izquierda (X-)
-        glNormal3f(-1.0f, 0.0f, 0.0f);
-        glVertex3f(-size, -size, -size);
-        glVertex3f(-size, -size, size);
-        glVertex3f(-size, size, size);
-        glVertex3f(-size, size, -size);
-        
-        // Cara derecha (X+)
-        glNormal3f(1.0f, 0.0f, 0.0f);
-        glVertex3f(size, -size, -size);
-        glVertex3f(size, size, -size);
-        glVertex3f(size, size, size);
-        glVertex3f(size, -size, size);
-        
-        // Cara superior (Y+)
-        glNormal3f(0.0f, 1.0f, 0.0f);
-        glVertex3f(-size, size, -size);
-        glVertex3f(-size, size, size);
-        glVertex3f(size, size, size);
-        glVertex3f(size, size, -size);
+        // Cubo rojo pulsante, algo más grande cuando está cerca
+        float size = 0.6f + pulse * 0.2f;
+        if (close) {
+            size += 0.2f + approach_animation * 0.1f;
+        }
         
-        // Cara inferior (Y-)
-        glNormal3f(0.0f, -1.0f, 0.0f);
-        glVertex3f(-size, -size, -size);
-        glVertex3f(size, -size, -size);
-        glVertex3f(size, -size, size);
-        glVertex3f(-size, -size, size);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_NORMAL_ARRAY);
+        if (enemy_vbo) {
+            glBindBuffer(GL_ARRAY_BUFFER, enemy_vbo);
+            glInterleavedArrays(GL_N3F_V3F, 0, (const GLvoid*)0);
+        } else {
+            glInterleavedArrays(GL_N3F_V3F, 0, enemy_vertices);
+        }
         
-        glEnd();
+        // El tamaño va en la escala (setup_lighting deja GL_NORMALIZE activo para las normales)
+        glPushMatrix();
+        glTranslatef(enemy.x, float_height, enemy.z);
+        glRotatef(anim_time * rotation_speed, 0, 1, 0);
+        glScalef(size, size, size);
+        glDrawArrays(GL_QUADS, 0, ENEMY_CUBE_VERTICES);
+        gl_state_count_draw(ENEMY_CUBE_VERTICES);
         glPopMatrix();
         
         // Dibujar aura roja pulsante
-        glDisable(GL_LIGHTING);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        gl_state_enable(GL_LIGHTING, false);
+        gl_state_enable(GL_BLEND, true);
+        gl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         
         float aura_alpha = 0.2f + pulse * 0.3f; // Alpha pulsante
         glColor4f(1.0f, 0.0f, 0.0f, aura_alpha);
         
+        float aura_radius = 3.0f + pulse * 1.0f;
         glPushMatrix();
         glTranslatef(enemy.x, 0.1f, enemy.z);
+        glScalef(aura_radius, 1.0f, aura_radius);
+        glDrawArrays(GL_TRIANGLE_FAN, ENEMY_CUBE_VERTICES, ENEMY_AURA_VERTICES);
+        gl_state_count_draw(ENEMY_AURA_VERTICES);
+        glPopMatrix();
         
-        // Dibujar aura circular pulsante
-        float aura_radius = 3.0f + pulse * 1.0f;
-        glBegin(GL_TRIANGLE_FAN);
-        glVertex3f(0, 0, 0);
-        for (int i = 0; i <= 32; i++) {
-            float angle = 2.0f * M_PI * i / 32.0f;
-            glVertex3f(cos(angle) * aura_radius, 0, sin(angle) * aura_radius);
-        }
-        glEnd();
+        if (enemy_vbo) glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glDisableClientState(GL_NORMAL_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
         
-        glPopMatrix();
-        glDisable(GL_BLEND);
-        glEnable(GL_LIGHTING);
+        gl_state_enable(GL_BLEND, false);
+        gl_state_enable(GL_LIGHTING, true);
     }
 }
 
@@ -354,11 +396,8 @@ void render_enemy_3d() {
 void make_probabilistic_decision() {
     if (enemy.is_deciding) return; // Ya está en proceso de decisión
     
-    float distance_to_player = sqrt((enemy.x - player.x) * (enemy.x - player.x) + 
-                                   (enemy.z - player.z) * (enemy.z - player.z));
-    
     // Solo decidir si está cerca del jugador (rango de decisión)
-    if (distance_to_player > 10.0f) {
+    if (enemy.distance_to_player > 10.0f) {
         enemy.decision_made = false;
         return;
     }
@@ -383,7 +422,7 @@ void make_probabilistic_decision() {
     
     enemy.is_deciding = true;
     enemy.decision_made = true;
-    enemy.decision_cooldown = 600; // 10 segundos de cooldown
+    enemy.decision_cooldown = 10 * SIMULATION_TICK_RATE; // 10 segundos de cooldown
     
     if (random_value <= enemy.attack_probability) {
         // DECISIÓN: ATACAR
@@ -404,11 +443,11 @@ void teleport_enemy_randomly() {
     float new_x, new_z;
     
     do {
-        new_x = (rand() % (MAZE_WIDTH - 20)) + 10;
-        new_z = (rand() % (MAZE_HEIGHT - 20)) + 10;
+        new_x = (rand() % (maze_width - 20)) + 10;
+        new_z = (rand() % (maze_height - 20)) + 10;
         attempts++;
-    } while ((sqrt((new_x - player.x) * (new_x - player.x) + 
-                   (new_z - player.z) * (new_z - player.z)) < 20.0f ||
+    } while (((new_x - player.x) * (new_x - player.x) + 
+              (new_z - player.z) * (new_z - player.z) < 20.0f * 20.0f ||
              is_wall((int)new_x, (int)new_z)) && attempts < 50);
     
     if (attempts < 50) {
@@ -416,8 +455,11 @@ void teleport_enemy_randomly() {
         enemy.z = new_z;
         enemy.target_x = enemy.x;
         enemy.target_z = enemy.z;
+        enemy.previous_x = enemy.x;     // Un teletransporte no se interpola
+        enemy.previous_z = enemy.z;
         enemy.is_hunting = false;
         enemy.last_teleport = enemy.behavior_timer;
+        update_enemy_metrics();
         
         printf("ENEMIGO: Teletransportado a (%.1f, %.1f)\n", enemy.x, enemy.z);
     } else {
@@ -443,8 +485,7 @@ void attack_player() {
 
 float calculate_attack_probability() {
     // Calcular probabilidad de ataque basada en varios factores
-    float distance_to_player = sqrt((enemy.x - player.x) * (enemy.x - player.x) + 
-                                   (enemy.z - player.z) * (enemy.z - player.z));
+    float distance_to_player = enemy.distance_to_player;
     
     float base_probability = 0.05f; // Probabilidad base del 5%
     
@@ -454,7 +495,7 @@ float calculate_attack_probability() {
     if (distance_factor > 1.0f) distance_factor = 1.0f;
     
     // Factor de tiempo: más tiempo cazando = mayor probabilidad
-    float time_factor = (float)enemy.behavior_timer / 3600.0f; // Normalizar a 1 minuto
+    float time_factor = (float)enemy.behavior_timer / (60.0f * SIMULATION_TICK_RATE); // Normalizar a 1 minuto
     if (time_factor > 1.0f) time_factor = 1.0f;
     
     // Factor de sospecha
@@ -476,3 +517,11 @@ float calculate_attack_probability() {
 bool is_player_dead() {
     return !enemy.active; // El enemigo se desactiva cuando mata al jugador
 }
+
+void cleanup_enemy() {
+    if (enemy_vbo) {
+        glDeleteBuffers(1, &enemy_vbo);
+        enemy_vbo = 0;
+    }
+    enemy_mesh_ready = false;
+}
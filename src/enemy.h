@@ -7,6 +7,7 @@
 // Estructura del enemigo
 typedef struct {
     float x, z;           // Posición en el mapa
+    float previous_x, previous_z; // Posición al inicio del último tick (para interpolar el render)
     float target_x, target_z; // Posición objetivo
     float speed;          // Velocidad de movimiento
     bool active;          // Si el enemigo está activo
@@ -29,7 +30,7 @@ typedef struct {
     int phase_timer;      // Temporizador de la fase actual
     int phase_duration;   // Duración de la fase 0 (1 minuto)
     int teleport_frequency; // Frecuencia de teletransporte en fase 0
-    int last_teleport;    // Último frame de teletransporte
+    int last_teleport;    // Último tick de teletransporte
     
     // Sistema de IA probabilística
     float attack_probability; // Probabilidad de atacar (0.0 - 1.0)
@@ -37,18 +38,32 @@ typedef struct {
     int decision_cooldown;    // Cooldown entre decisiones
     float last_distance;      // Última distancia al jugador
     bool is_deciding;         // Si está en proceso de decisión
+    
+    // Métricas respecto al jugador: se calculan una vez por tick (y al moverse el
+    // enemigo) y las comparten la IA y el render
+    float to_player_x, to_player_z; // Vector del enemigo al jugador
+    float distance_to_player;
 } Enemy;
 
+// Malla del enemigo horneada una vez: cubo y aura unitarios (el tamaño va en la matriz)
+#define ENEMY_AURA_SEGMENTS 32
+#define ENEMY_CUBE_VERTICES 24
+#define ENEMY_AURA_VERTICES (ENEMY_AURA_SEGMENTS + 2)   // Centro y anillo cerrado
+#define ENEMY_RENDER_DISTANCE 35.0f
+#define ENEMY_CLOSE_DISTANCE 15.0f
+
 // Variables globales del enemigo
 extern Enemy enemy;
 
 // Funciones del enemigo
 void init_enemy();
 void update_enemy();
+void update_enemy_metrics();
 void render_enemy_minimap();
 void render_enemy_3d();
 void check_enemy_collision();
 bool is_player_dead();
+void cleanup_enemy();
 
 // Sistema de IA probabilística
 void make_probabilistic_decision();
@@ -0,0 +1,156 @@
+// frustum.c - Frustum culling con los 6 planos de la cámara
+#include "frustum.h"
+#include <GL/gl.h>
+#include <stdlib.h>
+#include <math.h>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+FrustumPlane frustum_planes[6];
+FrustumStats frustum_stats = {0};
+float frustum_half_fov_x = 1.0f;
+
+static void normalize_plane(FrustumPlane* p) {
+    float length = sqrtf(p->a * p->a + p->b * p->b + p->c * p->c);
+    if (length > 0.0f) {
+        p->a /= length;
+        p->b /= length;
+        p->c /= length;
+        p->d /= length;
+    }
+}
+
+void frustum_update() {
+    // Leer las matrices actuales (column-major) y combinarlas: clip = P * MV
+    GLfloat proj[16], modl[16], clip[16];
+    glGetFloatv(GL_PROJECTION_MATRIX, proj);
+    glGetFloatv(GL_MODELVIEW_MATRIX, modl);
+
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) {
+            clip[col * 4 + row] = proj[0 * 4 + row] * modl[col * 4 + 0] +
+                                  proj[1 * 4 + row] * modl[col * 4 + 1] +
+                                  proj[2 * 4 + row] * modl[col * 4 + 2] +
+                                  proj[3 * 4 + row] * modl[col * 4 + 3];
+        }
+    }
+
+    // FOV horizontal a partir de la proyección: proj[0] = 1 / tan(fov_x / 2)
+    if (proj[0] > 0.0f) {
+        frustum_half_fov_x = atanf(1.0f / proj[0]);
+    }
+
+    // Extraer planos sumando/restando la fila 3 con las filas 0, 1 y 2
+    for (int i = 0; i < 6; i++) {
+        int row = i / 2;
+        float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+        frustum_planes[i].a = clip[3] + sign * clip[row];
+        frustum_planes[i].b = clip[7] + sign * clip[4 + row];
+        frustum_planes[i].c = clip[11] + sign * clip[8 + row];
+        frustum_planes[i].d = clip[15] + sign * clip[12 + row];
+        normalize_plane(&frustum_planes[i]);
+    }
+
+    // Reiniciar estadísticas del frame
+    frustum_stats.chunks_accepted = 0;
+    frustum_stats.chunks_rejected = 0;
+    frustum_stats.cells_accepted = 0;
+    frustum_stats.cells_rejected = 0;
+}
+
+bool frustum_test_box(float min_x, float min_y, float min_z,
+                      float max_x, float max_y, float max_z) {
+    // La caja está fuera si su vértice más positivo queda detrás de algún plano
+    for (int i = 0; i < 6; i++) {
+        const FrustumPlane* p = &frustum_planes[i];
+        float x = p->a >= 0.0f ? max_x : min_x;
+        float y = p->b >= 0.0f ? max_y : min_y;
+        float z = p->c >= 0.0f ? max_z : min_z;
+        if (p->a * x + p->b * y + p->c * z + p->d < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int frustum_test_boxes(const FrustumBoxes* boxes, unsigned char* visible) {
+    int accepted = 0;
+    int i = 0;
+
+#if defined(__SSE__)
+    // Cuatro cajas por iteración
+    for (; i + 4 <= boxes->capacity && i < boxes->count; i += 4) {
+        __m128 inside = _mm_cmpeq_ps(_mm_setzero_ps(), _mm_setzero_ps()); // Todo a 1
+        for (int p = 0; p < 6; p++) {
+            const FrustumPlane* plane = &frustum_planes[p];
+            __m128 x = _mm_loadu_ps(plane->a >= 0.0f ? boxes->max_x + i : boxes->min_x + i);
+            __m128 y = _mm_loadu_ps(plane->b >= 0.0f ? boxes->max_y + i : boxes->min_y + i);
+            __m128 z = _mm_loadu_ps(plane->c >= 0.0f ? boxes->max_z + i : boxes->min_z + i);
+            __m128 dist = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane->a)), _mm_mul_ps(y, _mm_set1_ps(plane->b))),
+                _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane->c)), _mm_set1_ps(plane->d)));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, _mm_setzero_ps()));
+        }
+        int mask = _mm_movemask_ps(inside);
+        for (int k = 0; k < 4 && i + k < boxes->count; k++) {
+            visible[i + k] = (mask >> k) & 1;
+            accepted += visible[i + k];
+        }
+    }
+#endif
+
+    // Resto (o ruta escalar sin SSE)
+    for (; i < boxes->count; i++) {
+        visible[i] = frustum_test_box(boxes->min_x[i], boxes->min_y[i], boxes->min_z[i],
+                                      boxes->max_x[i], boxes->max_y[i], boxes->max_z[i]);
+        accepted += visible[i];
+    }
+    return accepted;
+}
+
+bool frustum_boxes_init(FrustumBoxes* boxes, int count) {
+    // Reservar con relleno a múltiplo de 4; las cajas de relleno quedan vacías
+    int capacity = (count + 3) & ~3;
+    boxes->count = count;
+    boxes->capacity = capacity;
+    boxes->min_x = (float*)calloc((size_t)capacity, sizeof(float));
+    boxes->min_y = (float*)calloc((size_t)capacity, sizeof(float));
+    boxes->min_z = (float*)calloc((size_t)capacity, sizeof(float));
+    boxes->max_x = (float*)calloc((size_t)capacity, sizeof(float));
+    boxes->max_y = (float*)calloc((size_t)capacity, sizeof(float));
+    boxes->max_z = (float*)calloc((size_t)capacity, sizeof(float));
+
+    // Si falta alguna, nada a medias: se liberan las que sí se reservaron
+    if (!boxes->min_x || !boxes->min_y || !boxes->min_z ||
+        !boxes->max_x || !boxes->max_y || !boxes->max_z) {
+        frustum_boxes_free(boxes);
+        return false;
+    }
+    return true;
+}
+
+void frustum_boxes_set(FrustumBoxes* boxes, int index,
+                       float min_x, float min_y, float min_z,
+                       float max_x, float max_y, float max_z) {
+    boxes->min_x[index] = min_x;
+    boxes->min_y[index] = min_y;
+    boxes->min_z[index] = min_z;
+    boxes->max_x[index] = max_x;
+    boxes->max_y[index] = max_y;
+    boxes->max_z[index] = max_z;
+}
+
+void frustum_boxes_free(FrustumBoxes* boxes) {
+    free(boxes->min_x);
+    free(boxes->min_y);
+    free(boxes->min_z);
+    free(boxes->max_x);
+    free(boxes->max_y);
+    free(boxes->max_z);
+    boxes->min_x = boxes->min_y = boxes->min_z = NULL;
+    boxes->max_x = boxes->max_y = boxes->max_z = NULL;
+    boxes->count = 0;
+    boxes->capacity = 0;
+}
@@ -0,0 +1,49 @@
+// frustum.h - Frustum culling con los 6 planos de la cámara
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <stdbool.h>
+
+// Plano: a*x + b*y + c*z + d >= 0 dentro del frustum
+typedef struct {
+    float a, b, c, d;
+} FrustumPlane;
+
+// Cajas envolventes en formato SoA (relleno a múltiplo de 4 para SIMD)
+typedef struct {
+    float* min_x;
+    float* min_y;
+    float* min_z;
+    float* max_x;
+    float* max_y;
+    float* max_z;
+    int count;
+    int capacity;
+} FrustumBoxes;
+
+// Estadísticas de culling del frame actual
+typedef struct {
+    int chunks_accepted;
+    int chunks_rejected;
+    int cells_accepted;
+    int cells_rejected;
+} FrustumStats;
+
+extern FrustumPlane frustum_planes[6];
+extern FrustumStats frustum_stats;
+extern float frustum_half_fov_x;   // Mitad del FOV horizontal (radianes)
+
+// Funciones del frustum
+void frustum_update();
+bool frustum_test_box(float min_x, float min_y, float min_z,
+                      float max_x, float max_y, float max_z);
+int frustum_test_boxes(const FrustumBoxes* boxes, unsigned char* visible);
+
+// Gestión de cajas SoA
+bool frustum_boxes_init(FrustumBoxes* boxes, int count);   // false sin memoria (sin reservas a medias)
+void frustum_boxes_set(FrustumBoxes* boxes, int index,
+                       float min_x, float min_y, float min_z,
+                       float max_x, float max_y, float max_z);
+void frustum_boxes_free(FrustumBoxes* boxes);
+
+#endif // FRUSTUM_H
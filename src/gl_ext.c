@@ -0,0 +1,268 @@
+// gl_ext.c - Carga de funciones OpenGL posteriores a 1.1 (GLFW o el cargador del contexto sin ventana)
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include "gl_ext.h"
+#include <stdio.h>
+#include <string.h>
+
+PFN_GENBUFFERS pglGenBuffers = NULL;
+PFN_DELETEBUFFERS pglDeleteBuffers = NULL;
+PFN_BINDBUFFER pglBindBuffer = NULL;
+PFN_BUFFERDATA pglBufferData = NULL;
+PFN_BUFFERSUBDATA pglBufferSubData = NULL;
+
+PFN_CREATESHADER pglCreateShader = NULL;
+PFN_DELETESHADER pglDeleteShader = NULL;
+PFN_SHADERSOURCE pglShaderSource = NULL;
+PFN_COMPILESHADER pglCompileShader = NULL;
+PFN_GETSHADERIV pglGetShaderiv = NULL;
+PFN_GETSHADERINFOLOG pglGetShaderInfoLog = NULL;
+PFN_CREATEPROGRAM pglCreateProgram = NULL;
+PFN_DELETEPROGRAM pglDeleteProgram = NULL;
+PFN_ATTACHSHADER pglAttachShader = NULL;
+PFN_BINDATTRIBLOCATION pglBindAttribLocation = NULL;
+PFN_LINKPROGRAM pglLinkProgram = NULL;
+PFN_GETPROGRAMIV pglGetProgramiv = NULL;
+PFN_GETPROGRAMINFOLOG pglGetProgramInfoLog = NULL;
+PFN_USEPROGRAM pglUseProgram = NULL;
+PFN_GETUNIFORMLOCATION pglGetUniformLocation = NULL;
+PFN_UNIFORM1I pglUniform1i = NULL;
+PFN_UNIFORM1F pglUniform1f = NULL;
+PFN_UNIFORM2F pglUniform2f = NULL;
+PFN_UNIFORM2I pglUniform2i = NULL;
+PFN_UNIFORM4FV pglUniform4fv = NULL;
+PFN_ACTIVETEXTURE pglActiveTexture = NULL;
+PFN_ENABLEVERTEXATTRIBARRAY pglEnableVertexAttribArray = NULL;
+PFN_DISABLEVERTEXATTRIBARRAY pglDisableVertexAttribArray = NULL;
+PFN_VERTEXATTRIBPOINTER pglVertexAttribPointer = NULL;
+
+PFN_DRAWARRAYSINSTANCED pglDrawArraysInstanced = NULL;
+PFN_VERTEXATTRIBDIVISOR pglVertexAttribDivisor = NULL;
+
+PFN_GENFRAMEBUFFERS pglGenFramebuffers = NULL;
+PFN_DELETEFRAMEBUFFERS pglDeleteFramebuffers = NULL;
+PFN_BINDFRAMEBUFFER pglBindFramebuffer = NULL;
+PFN_GENRENDERBUFFERS pglGenRenderbuffers = NULL;
+PFN_DELETERENDERBUFFERS pglDeleteRenderbuffers = NULL;
+PFN_BINDRENDERBUFFER pglBindRenderbuffer = NULL;
+PFN_RENDERBUFFERSTORAGE pglRenderbufferStorage = NULL;
+PFN_FRAMEBUFFERRENDERBUFFER pglFramebufferRenderbuffer = NULL;
+PFN_CHECKFRAMEBUFFERSTATUS pglCheckFramebufferStatus = NULL;
+
+PFN_GENQUERIES pglGenQueries = NULL;
+PFN_DELETEQUERIES pglDeleteQueries = NULL;
+PFN_BEGINQUERY pglBeginQuery = NULL;
+PFN_ENDQUERY pglEndQuery = NULL;
+PFN_GETQUERYOBJECTUI64V pglGetQueryObjectui64v = NULL;
+
+bool gl_has_vbo = false;
+bool gl_has_shaders = false;
+bool gl_has_instancing = false;
+bool gl_has_framebuffers = false;
+bool gl_has_timer_query = false;
+
+// Cargador de funciones del contexto actual
+static GLProcLoader proc_loader = NULL;
+
+static GLProc load_proc(const char* name) {
+    return proc_loader ? proc_loader(name) : NULL;
+}
+
+// Busca el nombre completo en la lista de extensiones (no un prefijo de otra)
+static bool extension_supported(const char* name) {
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    if (!extensions) return false;
+    size_t length = strlen(name);
+    for (const char* p = strstr(extensions, name); p; p = strstr(p + length, name)) {
+        bool starts = p == extensions || p[-1] == ' ';
+        bool ends = p[length] == ' ' || p[length] == '\0';
+        if (starts && ends) return true;
+    }
+    return false;
+}
+
+static void load_shader_functions() {
+    // Shaders GLSL: núcleo desde OpenGL 2.0
+    pglCreateShader = (PFN_CREATESHADER)load_proc("glCreateShader");
+    pglDeleteShader = (PFN_DELETESHADER)load_proc("glDeleteShader");
+    pglShaderSource = (PFN_SHADERSOURCE)load_proc("glShaderSource");
+    pglCompileShader = (PFN_COMPILESHADER)load_proc("glCompileShader");
+    pglGetShaderiv = (PFN_GETSHADERIV)load_proc("glGetShaderiv");
+    pglGetShaderInfoLog = (PFN_GETSHADERINFOLOG)load_proc("glGetShaderInfoLog");
+    pglCreateProgram = (PFN_CREATEPROGRAM)load_proc("glCreateProgram");
+    pglDeleteProgram = (PFN_DELETEPROGRAM)load_proc("glDeleteProgram");
+    pglAttachShader = (PFN_ATTACHSHADER)load_proc("glAttachShader");
+    pglBindAttribLocation = (PFN_BINDATTRIBLOCATION)load_proc("glBindAttribLocation");
+    pglLinkProgram = (PFN_LINKPROGRAM)load_proc("glLinkProgram");
+    pglGetProgramiv = (PFN_GETPROGRAMIV)load_proc("glGetProgramiv");
+    pglGetProgramInfoLog = (PFN_GETPROGRAMINFOLOG)load_proc("glGetProgramInfoLog");
+    pglUseProgram = (PFN_USEPROGRAM)load_proc("glUseProgram");
+    pglGetUniformLocation = (PFN_GETUNIFORMLOCATION)load_proc("glGetUniformLocation");
+    pglUniform1i = (PFN_UNIFORM1I)load_proc("glUniform1i");
+    pglUniform1f = (PFN_UNIFORM1F)load_proc("glUniform1f");
+    pglUniform2f = (PFN_UNIFORM2F)load_proc("glUniform2f");
+    pglUniform2i = (PFN_UNIFORM2I)load_proc("glUniform2i");
+    pglUniform4fv = (PFN_UNIFORM4FV)load_proc("glUniform4fv");
+    pglActiveTexture = (PFN_ACTIVETEXTURE)load_proc("glActiveTexture");
+    pglEnableVertexAttribArray = (PFN_ENABLEVERTEXATTRIBARRAY)load_proc("glEnableVertexAttribArray");
+    pglDisableVertexAttribArray = (PFN_DISABLEVERTEXATTRIBARRAY)load_proc("glDisableVertexAttribArray");
+    pglVertexAttribPointer = (PFN_VERTEXATTRIBPOINTER)load_proc("glVertexAttribPointer");
+
+    gl_has_shaders = pglCreateShader && pglDeleteShader && pglShaderSource && pglCompileShader &&
+                     pglGetShaderiv && pglGetShaderInfoLog && pglCreateProgram && pglDeleteProgram &&
+                     pglAttachShader && pglBindAttribLocation && pglLinkProgram && pglGetProgramiv &&
+                     pglGetProgramInfoLog && pglUseProgram && pglGetUniformLocation && pglUniform1i &&
+                     pglUniform1f && pglUniform2f && pglUniform2i && pglUniform4fv &&
+                     pglActiveTexture && pglEnableVertexAttribArray &&
+                     pglDisableVertexAttribArray && pglVertexAttribPointer;
+}
+
+static void load_instancing_functions() {
+    // Instancing: núcleo desde 3.1 (dibujo) y 3.3 (divisor), extensiones ARB antes
+    pglDrawArraysInstanced = (PFN_DRAWARRAYSINSTANCED)load_proc("glDrawArraysInstanced");
+    pglVertexAttribDivisor = (PFN_VERTEXATTRIBDIVISOR)load_proc("glVertexAttribDivisor");
+
+    if (!pglDrawArraysInstanced && extension_supported("GL_ARB_draw_instanced")) {
+        pglDrawArraysInstanced = (PFN_DRAWARRAYSINSTANCED)load_proc("glDrawArraysInstancedARB");
+    }
+    if (!pglVertexAttribDivisor && extension_supported("GL_ARB_instanced_arrays")) {
+        pglVertexAttribDivisor = (PFN_VERTEXATTRIBDIVISOR)load_proc("glVertexAttribDivisorARB");
+    }
+
+    gl_has_instancing = gl_has_vbo && gl_has_shaders && pglDrawArraysInstanced && pglVertexAttribDivisor;
+}
+
+static void load_framebuffer_functions() {
+    // Framebuffer objects: núcleo desde 3.0 (render sin ventana del benchmark)
+    pglGenFramebuffers = (PFN_GENFRAMEBUFFERS)load_proc("glGenFramebuffers");
+    pglDeleteFramebuffers = (PFN_DELETEFRAMEBUFFERS)load_proc("glDeleteFramebuffers");
+    pglBindFramebuffer = (PFN_BINDFRAMEBUFFER)load_proc("glBindFramebuffer");
+    pglGenRenderbuffers = (PFN_GENRENDERBUFFERS)load_proc("glGenRenderbuffers");
+    pglDeleteRenderbuffers = (PFN_DELETERENDERBUFFERS)load_proc("glDeleteRenderbuffers");
+    pglBindRenderbuffer = (PFN_BINDRENDERBUFFER)load_proc("glBindRenderbuffer");
+    pglRenderbufferStorage = (PFN_RENDERBUFFERSTORAGE)load_proc("glRenderbufferStorage");
+    pglFramebufferRenderbuffer = (PFN_FRAMEBUFFERRENDERBUFFER)load_proc("glFramebufferRenderbuffer");
+    pglCheckFramebufferStatus = (PFN_CHECKFRAMEBUFFERSTATUS)load_proc("glCheckFramebufferStatus");
+
+    gl_has_framebuffers = pglGenFramebuffers && pglDeleteFramebuffers && pglBindFramebuffer &&
+                          pglGenRenderbuffers && pglDeleteRenderbuffers && pglBindRenderbuffer &&
+                          pglRenderbufferStorage && pglFramebufferRenderbuffer &&
+                          pglCheckFramebufferStatus;
+}
+
+static void load_query_functions() {
+    // Consultas de tiempo de GPU: núcleo desde 3.3, GL_ARB_timer_query antes
+    pglGenQueries = (PFN_GENQUERIES)load_proc("glGenQueries");
+    pglDeleteQueries = (PFN_DELETEQUERIES)load_proc("glDeleteQueries");
+    pglBeginQuery = (PFN_BEGINQUERY)load_proc("glBeginQuery");
+    pglEndQuery = (PFN_ENDQUERY)load_proc("glEndQuery");
+    pglGetQueryObjectui64v = (PFN_GETQUERYOBJECTUI64V)load_proc("glGetQueryObjectui64v");
+
+    const char* version = (const char*)glGetString(GL_VERSION);
+    bool core_timer = version && (version[0] > '3' || (version[0] == '3' && version[2] >= '3'));
+    gl_has_timer_query = pglGenQueries && pglDeleteQueries && pglBeginQuery && pglEndQuery &&
+                         pglGetQueryObjectui64v &&
+                         (core_timer || extension_supported("GL_ARB_timer_query"));
+}
+
+bool init_gl_extensions() {
+    return init_gl_extensions_with_loader((GLProcLoader)glfwGetProcAddress);
+}
+
+bool init_gl_extensions_with_loader(GLProcLoader loader) {
+    proc_loader = loader;
+
+    // Vertex Buffer Objects: núcleo desde 1.5, extensión ARB antes
+    pglGenBuffers = (PFN_GENBUFFERS)load_proc("glGenBuffers");
+    pglDeleteBuffers = (PFN_DELETEBUFFERS)load_proc("glDeleteBuffers");
+    pglBindBuffer = (PFN_BINDBUFFER)load_proc("glBindBuffer");
+    pglBufferData = (PFN_BUFFERDATA)load_proc("glBufferData");
+    pglBufferSubData = (PFN_BUFFERSUBDATA)load_proc("glBufferSubData");
+
+    if (!pglGenBuffers && extension_supported("GL_ARB_vertex_buffer_object")) {
+        pglGenBuffers = (PFN_GENBUFFERS)load_proc("glGenBuffersARB");
+        pglDeleteBuffers = (PFN_DELETEBUFFERS)load_proc("glDeleteBuffersARB");
+        pglBindBuffer = (PFN_BINDBUFFER)load_proc("glBindBufferARB");
+        pglBufferData = (PFN_BUFFERDATA)load_proc("glBufferDataARB");
+        pglBufferSubData = (PFN_BUFFERSUBDATA)load_proc("glBufferSubDataARB");
+    }
+
+    gl_has_vbo = pglGenBuffers && pglDeleteBuffers && pglBindBuffer &&
+                 pglBufferData && pglBufferSubData;
+
+    load_shader_functions();
+    load_instancing_functions();
+    load_framebuffer_functions();
+    load_query_functions();
+
+    printf("OpenGL: %s (%s) - VBO %s\n", (const char*)glGetString(GL_VERSION),
+           (const char*)glGetString(GL_RENDERER),
+           gl_has_vbo ? "disponible" : "no disponible (usando vertex arrays)");
+    printf("OpenGL: shaders %s, instancing %s\n",
+           gl_has_shaders ? "disponibles" : "no disponibles",
+           gl_has_instancing ? "disponible" : "no disponible");
+    return gl_has_vbo;
+}
+
+static GLuint compile_shader(GLenum type, const char* prefix, const char* source) {
+    GLuint shader = glCreateShader(type);
+    const char* sources[2] = {prefix ? prefix : "", source};
+    glShaderSource(shader, 2, sources, NULL);
+    glCompileShader(shader);
+
+    GLint ok = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        printf("Error compilando shader %s:\n%s\n",
+               type == GL_VERTEX_SHADER ? "de vértices" : "de fragmentos", log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+GLuint gl_build_program(const char* vertex_source, const char* fragment_source,
+                        const char** attributes, int attribute_count) {
+    return gl_build_program_prefixed(NULL, vertex_source, fragment_source, attributes, attribute_count);
+}
+
+GLuint gl_build_program_prefixed(const char* prefix, const char* vertex_source,
+                                 const char* fragment_source,
+                                 const char** attributes, int attribute_count) {
+    if (!gl_has_shaders) return 0;
+
+    GLuint vertex = compile_shader(GL_VERTEX_SHADER, prefix, vertex_source);
+    GLuint fragment = compile_shader(GL_FRAGMENT_SHADER, prefix, fragment_source);
+    if (!vertex || !fragment) {
+        if (vertex) glDeleteShader(vertex);
+        if (fragment) glDeleteShader(fragment);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+
+    // Los atributos propios empiezan en 1: el 0 es alias de gl_Vertex
+    for (int i = 0; i < attribute_count; i++) {
+        glBindAttribLocation(program, (GLuint)(i + 1), attributes[i]);
+    }
+    glLinkProgram(program);
+
+    // Los shaders ya no hacen falta una vez enlazado el programa
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+
+    GLint ok = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        glGetProgramInfoLog(program, sizeof(log), NULL, log);
+        printf("Error enlazando programa GLSL:\n%s\n", log);
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
@@ -0,0 +1,252 @@
+// gl_ext.h - Carga de funciones OpenGL posteriores a 1.1 (opengl32 solo exporta 1.1)
+#ifndef GL_EXT_H
+#define GL_EXT_H
+
+#include <GL/gl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef APIENTRYP
+#define APIENTRYP APIENTRY *
+#endif
+
+// Tipos de OpenGL 1.5/2.0 que no trae el gl.h de MinGW
+typedef ptrdiff_t GLsizeiptr;
+typedef ptrdiff_t GLintptr;
+typedef char GLchar;
+
+// Constantes de Vertex Buffer Objects (OpenGL 1.5)
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER 0x8892
+#define GL_STREAM_DRAW 0x88E0
+#define GL_STATIC_DRAW 0x88E4
+#define GL_DYNAMIC_DRAW 0x88E8
+#endif
+
+// Constantes de shaders GLSL (OpenGL 2.0)
+#ifndef GL_FRAGMENT_SHADER
+#define GL_FRAGMENT_SHADER 0x8B30
+#define GL_VERTEX_SHADER 0x8B31
+#define GL_COMPILE_STATUS 0x8B81
+#define GL_LINK_STATUS 0x8B82
+#define GL_INFO_LOG_LENGTH 0x8B84
+#endif
+
+// Constantes de texturas (OpenGL 1.2/1.3 y texturas float de 3.0)
+#ifndef GL_TEXTURE0
+#define GL_TEXTURE0 0x84C0
+#endif
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE 0x812F
+#endif
+#ifndef GL_RGBA32F
+#define GL_RGBA32F 0x8814
+#endif
+#ifndef GL_R32F
+#define GL_R32F 0x822E
+#endif
+#ifndef GL_R8
+#define GL_R8 0x8229
+#endif
+
+// Constantes de framebuffers (OpenGL 3.0) y consultas de tiempo (OpenGL 3.3)
+#ifndef GL_FRAMEBUFFER
+#define GL_FRAMEBUFFER 0x8D40
+#define GL_RENDERBUFFER 0x8D41
+#define GL_COLOR_ATTACHMENT0 0x8CE0
+#define GL_DEPTH_ATTACHMENT 0x8D00
+#define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+#endif
+#ifndef GL_DEPTH_COMPONENT24
+#define GL_DEPTH_COMPONENT24 0x81A6
+#endif
+#ifndef GL_RGBA8
+#define GL_RGBA8 0x8058
+#endif
+#ifndef GL_TIME_ELAPSED
+#define GL_TIME_ELAPSED 0x88BF
+#endif
+#ifndef GL_QUERY_RESULT
+#define GL_QUERY_RESULT 0x8866
+#endif
+
+// Cargador de funciones: glfwGetProcAddress o el del contexto sin ventana
+typedef void (*GLProc)(void);
+typedef GLProc (*GLProcLoader)(const char* name);
+
+// Punteros a funciones de VBO
+typedef void (APIENTRYP PFN_GENBUFFERS)(GLsizei n, GLuint* buffers);
+typedef void (APIENTRYP PFN_DELETEBUFFERS)(GLsizei n, const GLuint* buffers);
+typedef void (APIENTRYP PFN_BINDBUFFER)(GLenum target, GLuint buffer);
+typedef void (APIENTRYP PFN_BUFFERDATA)(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+typedef void (APIENTRYP PFN_BUFFERSUBDATA)(GLenum target, GLintptr offset, GLsizeiptr size, const void* data);
+
+extern PFN_GENBUFFERS pglGenBuffers;
+extern PFN_DELETEBUFFERS pglDeleteBuffers;
+extern PFN_BINDBUFFER pglBindBuffer;
+extern PFN_BUFFERDATA pglBufferData;
+extern PFN_BUFFERSUBDATA pglBufferSubData;
+
+#define glGenBuffers pglGenBuffers
+#define glDeleteBuffers pglDeleteBuffers
+#define glBindBuffer pglBindBuffer
+#define glBufferData pglBufferData
+#define glBufferSubData pglBufferSubData
+
+// Punteros a funciones de shaders
+typedef GLuint (APIENTRYP PFN_CREATESHADER)(GLenum type);
+typedef void (APIENTRYP PFN_DELETESHADER)(GLuint shader);
+typedef void (APIENTRYP PFN_SHADERSOURCE)(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length);
+typedef void (APIENTRYP PFN_COMPILESHADER)(GLuint shader);
+typedef void (APIENTRYP PFN_GETSHADERIV)(GLuint shader, GLenum pname, GLint* params);
+typedef void (APIENTRYP PFN_GETSHADERINFOLOG)(GLuint shader, GLsizei size, GLsizei* length, GLchar* log);
+typedef GLuint (APIENTRYP PFN_CREATEPROGRAM)(void);
+typedef void (APIENTRYP PFN_DELETEPROGRAM)(GLuint program);
+typedef void (APIENTRYP PFN_ATTACHSHADER)(GLuint program, GLuint shader);
+typedef void (APIENTRYP PFN_BINDATTRIBLOCATION)(GLuint program, GLuint index, const GLchar* name);
+typedef void (APIENTRYP PFN_LINKPROGRAM)(GLuint program);
+typedef void (APIENTRYP PFN_GETPROGRAMIV)(GLuint program, GLenum pname, GLint* params);
+typedef void (APIENTRYP PFN_GETPROGRAMINFOLOG)(GLuint program, GLsizei size, GLsizei* length, GLchar* log);
+typedef void (APIENTRYP PFN_USEPROGRAM)(GLuint program);
+typedef GLint (APIENTRYP PFN_GETUNIFORMLOCATION)(GLuint program, const GLchar* name);
+typedef void (APIENTRYP PFN_UNIFORM1I)(GLint location, GLint v0);
+typedef void (APIENTRYP PFN_UNIFORM1F)(GLint location, GLfloat v0);
+typedef void (APIENTRYP PFN_UNIFORM2F)(GLint location, GLfloat v0, GLfloat v1);
+typedef void (APIENTRYP PFN_UNIFORM2I)(GLint location, GLint v0, GLint v1);
+typedef void (APIENTRYP PFN_UNIFORM4FV)(GLint location, GLsizei count, const GLfloat* value);
+typedef void (APIENTRYP PFN_ACTIVETEXTURE)(GLenum texture);
+typedef void (APIENTRYP PFN_ENABLEVERTEXATTRIBARRAY)(GLuint index);
+typedef void (APIENTRYP PFN_DISABLEVERTEXATTRIBARRAY)(GLuint index);
+typedef void (APIENTRYP PFN_VERTEXATTRIBPOINTER)(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer);
+
+extern PFN_CREATESHADER pglCreateShader;
+extern PFN_DELETESHADER pglDeleteShader;
+extern PFN_SHADERSOURCE pglShaderSource;
+extern PFN_COMPILESHADER pglCompileShader;
+extern PFN_GETSHADERIV pglGetShaderiv;
+extern PFN_GETSHADERINFOLOG pglGetShaderInfoLog;
+extern PFN_CREATEPROGRAM pglCreateProgram;
+extern PFN_DELETEPROGRAM pglDeleteProgram;
+extern PFN_ATTACHSHADER pglAttachShader;
+extern PFN_BINDATTRIBLOCATION pglBindAttribLocation;
+extern PFN_LINKPROGRAM pglLinkProgram;
+extern PFN_GETPROGRAMIV pglGetProgramiv;
+extern PFN_GETPROGRAMINFOLOG pglGetProgramInfoLog;
+extern PFN_USEPROGRAM pglUseProgram;
+extern PFN_GETUNIFORMLOCATION pglGetUniformLocation;
+extern PFN_UNIFORM1I pglUniform1i;
+extern PFN_UNIFORM1F pglUniform1f;
+extern PFN_UNIFORM2F pglUniform2f;
+extern PFN_UNIFORM2I pglUniform2i;
+extern PFN_UNIFORM4FV pglUniform4fv;
+extern PFN_ACTIVETEXTURE pglActiveTexture;
+extern PFN_ENABLEVERTEXATTRIBARRAY pglEnableVertexAttribArray;
+extern PFN_DISABLEVERTEXATTRIBARRAY pglDisableVertexAttribArray;
+extern PFN_VERTEXATTRIBPOINTER pglVertexAttribPointer;
+
+#define glCreateShader pglCreateShader
+#define glDeleteShader pglDeleteShader
+#define glShaderSource pglShaderSource
+#define glCompileShader pglCompileShader
+#define glGetShaderiv pglGetShaderiv
+#define glGetShaderInfoLog pglGetShaderInfoLog
+#define glCreateProgram pglCreateProgram
+#define glDeleteProgram pglDeleteProgram
+#define glAttachShader pglAttachShader
+#define glBindAttribLocation pglBindAttribLocation
+#define glLinkProgram pglLinkProgram
+#define glGetProgramiv pglGetProgramiv
+#define glGetProgramInfoLog pglGetProgramInfoLog
+#define glUseProgram pglUseProgram
+#define glGetUniformLocation pglGetUniformLocation
+#define glUniform1i pglUniform1i
+#define glUniform1f pglUniform1f
+#define glUniform2f pglUniform2f
+#define glUniform2i pglUniform2i
+#define glUniform4fv pglUniform4fv
+#define glActiveTexture pglActiveTexture
+#define glEnableVertexAttribArray pglEnableVertexAttribArray
+#define glDisableVertexAttribArray pglDisableVertexAttribArray
+#define glVertexAttribPointer pglVertexAttribPointer
+
+// Punteros a funciones de instancing (núcleo 3.1/3.3, ARB antes)
+typedef void (APIENTRYP PFN_DRAWARRAYSINSTANCED)(GLenum mode, GLint first, GLsizei count, GLsizei instances);
+typedef void (APIENTRYP PFN_VERTEXATTRIBDIVISOR)(GLuint index, GLuint divisor);
+
+extern PFN_DRAWARRAYSINSTANCED pglDrawArraysInstanced;
+extern PFN_VERTEXATTRIBDIVISOR pglVertexAttribDivisor;
+
+#define glDrawArraysInstanced pglDrawArraysInstanced
+#define glVertexAttribDivisor pglVertexAttribDivisor
+
+// Punteros a funciones de framebuffers (render sin ventana)
+typedef void (APIENTRYP PFN_GENFRAMEBUFFERS)(GLsizei n, GLuint* framebuffers);
+typedef void (APIENTRYP PFN_DELETEFRAMEBUFFERS)(GLsizei n, const GLuint* framebuffers);
+typedef void (APIENTRYP PFN_BINDFRAMEBUFFER)(GLenum target, GLuint framebuffer);
+typedef void (APIENTRYP PFN_GENRENDERBUFFERS)(GLsizei n, GLuint* renderbuffers);
+typedef void (APIENTRYP PFN_DELETERENDERBUFFERS)(GLsizei n, const GLuint* renderbuffers);
+typedef void (APIENTRYP PFN_BINDRENDERBUFFER)(GLenum target, GLuint renderbuffer);
+typedef void (APIENTRYP PFN_RENDERBUFFERSTORAGE)(GLenum target, GLenum format, GLsizei width, GLsizei height);
+typedef void (APIENTRYP PFN_FRAMEBUFFERRENDERBUFFER)(GLenum target, GLenum attachment, GLenum renderbuffer_target, GLuint renderbuffer);
+typedef GLenum (APIENTRYP PFN_CHECKFRAMEBUFFERSTATUS)(GLenum target);
+
+extern PFN_GENFRAMEBUFFERS pglGenFramebuffers;
+extern PFN_DELETEFRAMEBUFFERS pglDeleteFramebuffers;
+extern PFN_BINDFRAMEBUFFER pglBindFramebuffer;
+extern PFN_GENRENDERBUFFERS pglGenRenderbuffers;
+extern PFN_DELETERENDERBUFFERS pglDeleteRenderbuffers;
+extern PFN_BINDRENDERBUFFER pglBindRenderbuffer;
+extern PFN_RENDERBUFFERSTORAGE pglRenderbufferStorage;
+extern PFN_FRAMEBUFFERRENDERBUFFER pglFramebufferRenderbuffer;
+extern PFN_CHECKFRAMEBUFFERSTATUS pglCheckFramebufferStatus;
+
+#define glGenFramebuffers pglGenFramebuffers
+#define glDeleteFramebuffers pglDeleteFramebuffers
+#define glBindFramebuffer pglBindFramebuffer
+#define glGenRenderbuffers pglGenRenderbuffers
+#define glDeleteRenderbuffers pglDeleteRenderbuffers
+#define glBindRenderbuffer pglBindRenderbuffer
+#define glRenderbufferStorage pglRenderbufferStorage
+#define glFramebufferRenderbuffer pglFramebufferRenderbuffer
+#define glCheckFramebufferStatus pglCheckFramebufferStatus
+
+// Punteros a funciones de consultas (tiempo de GPU del benchmark)
+typedef void (APIENTRYP PFN_GENQUERIES)(GLsizei n, GLuint* ids);
+typedef void (APIENTRYP PFN_DELETEQUERIES)(GLsizei n, const GLuint* ids);
+typedef void (APIENTRYP PFN_BEGINQUERY)(GLenum target, GLuint id);
+typedef void (APIENTRYP PFN_ENDQUERY)(GLenum target);
+typedef void (APIENTRYP PFN_GETQUERYOBJECTUI64V)(GLuint id, GLenum pname, uint64_t* params);
+
+extern PFN_GENQUERIES pglGenQueries;
+extern PFN_DELETEQUERIES pglDeleteQueries;
+extern PFN_BEGINQUERY pglBeginQuery;
+extern PFN_ENDQUERY pglEndQuery;
+extern PFN_GETQUERYOBJECTUI64V pglGetQueryObjectui64v;
+
+#define glGenQueries pglGenQueries
+#define glDeleteQueries pglDeleteQueries
+#define glBeginQuery pglBeginQuery
+#define glEndQuery pglEndQuery
+#define glGetQueryObjectui64v pglGetQueryObjectui64v
+
+// Capacidades detectadas
+extern bool gl_has_vbo;
+extern bool gl_has_shaders;
+extern bool gl_has_instancing;
+extern bool gl_has_framebuffers;
+extern bool gl_has_timer_query;
+
+// Utilidad de shaders: compila y enlaza un programa (0 si falla).
+// prefix (opcional) se antepone a ambos fuentes, p. ej. "#version 130\n#define X\n"
+GLuint gl_build_program(const char* vertex_source, const char* fragment_source,
+                        const char** attributes, int attribute_count);
+GLuint gl_build_program_prefixed(const char* prefix, const char* vertex_source,
+                                 const char* fragment_source,
+                                 const char** attributes, int attribute_count);
+
+// Funciones de extensiones (requieren un contexto activo)
+bool init_gl_extensions();                                  // Contexto de GLFW
+bool init_gl_extensions_with_loader(GLProcLoader loader);   // Cualquier otro contexto
+
+#endif // GL_EXT_H
@@ -0,0 +1,309 @@
+// gl_state.c - Caché del estado fijo de OpenGL para filtrar llamadas redundantes
+#include "gl_state.h"
+#include <stdint.h>
+#include <string.h>
+
+#define GL_STATE_MAX_LIGHTS 8
+
+GLStateStats gl_state_stats = {0, 0, 0, 0};
+GLStateStats gl_state_last_frame = {0, 0, 0, 0};
+
+// Capacidades sombreadas (-1 = estado desconocido)
+typedef struct {
+    GLenum cap;
+    signed char enabled;
+} CapState;
+
+static CapState caps[] = {
+    {GL_BLEND, -1}, {GL_DEPTH_TEST, -1}, {GL_FOG, -1}, {GL_LIGHTING, -1},
+    {GL_CULL_FACE, -1}, {GL_NORMALIZE, -1}, {GL_TEXTURE_2D, -1},
+    {GL_LIGHT0, -1}, {GL_LIGHT1, -1}, {GL_LIGHT2, -1}, {GL_LIGHT3, -1},
+    {GL_LIGHT4, -1}, {GL_LIGHT5, -1}, {GL_LIGHT6, -1}, {GL_LIGHT7, -1}
+};
+#define CAP_COUNT ((int)(sizeof(caps) / sizeof(caps[0])))
+
+// Profundidad y blending
+static bool depth_mask_known = false;
+static GLboolean depth_mask_value = GL_TRUE;
+static bool depth_func_known = false;
+static GLenum depth_func_value = GL_LESS;
+static bool blend_func_known = false;
+static GLenum blend_src_value = GL_ONE;
+static GLenum blend_dst_value = GL_ZERO;
+
+// Material actual (FRONT_AND_BACK)
+static bool material_known[4] = {false, false, false, false};
+static GLMaterial material_value;
+
+// Niebla actual
+static bool fog_known = false;
+static GLFog fog_value;
+
+// Parámetros de cada luz (POSITION no se cachea: depende de la modelview al llamar)
+typedef struct {
+    bool known[3];
+    GLfloat color[3][4];       // AMBIENT, DIFFUSE, SPECULAR
+    bool scalar_known[4];
+    GLfloat scalar[4];         // CONSTANT, LINEAR, QUADRATIC, SPOT_CUTOFF
+} LightState;
+
+static LightState lights[GL_STATE_MAX_LIGHTS];
+
+// Cola de dibujos de la pasada ordenada
+typedef struct {
+    const GLMaterial* material;
+    GLDrawFunc draw;
+    void* data;
+    int order;
+} DrawEntry;
+
+static DrawEntry draw_queue[GL_STATE_MAX_DRAWS];
+static int draw_count = 0;
+
+static void count_issued() {
+    gl_state_stats.calls_issued++;
+}
+
+static void count_filtered() {
+    gl_state_stats.calls_filtered++;
+}
+
+static bool vec4_equal(const GLfloat* a, const GLfloat* b) {
+    return a[0] == b[0] && a[1] == b[1] && a[2] == b[2] && a[3] == b[3];
+}
+
+void init_gl_state() {
+    gl_state_invalidate();
+    memset(&gl_state_stats, 0, sizeof(gl_state_stats));
+    gl_state_last_frame = gl_state_stats;
+    draw_count = 0;
+}
+
+void gl_state_invalidate() {
+    // Olvidar todo: la siguiente llamada de cada tipo llegará al driver
+    for (int i = 0; i < CAP_COUNT; i++) caps[i].enabled = -1;
+    depth_mask_known = false;
+    depth_func_known = false;
+    blend_func_known = false;
+    for (int i = 0; i < 4; i++) material_known[i] = false;
+    fog_known = false;
+    memset(lights, 0, sizeof(lights));
+}
+
+void gl_state_begin_frame() {
+    gl_state_last_frame = gl_state_stats;
+    memset(&gl_state_stats, 0, sizeof(gl_state_stats));
+}
+
+void gl_state_count_draw(long vertices) {
+    gl_state_stats.draw_calls++;
+    gl_state_stats.vertices += vertices;
+}
+
+void gl_state_enable(GLenum cap, bool enabled) {
+    for (int i = 0; i < CAP_COUNT; i++) {
+        if (caps[i].cap != cap) continue;
+        if (caps[i].enabled == (enabled ? 1 : 0)) {
+            count_filtered();
+            return;
+        }
+        caps[i].enabled = enabled ? 1 : 0;
+        break;
+    }
+
+    // Capacidades no sombreadas pasan siempre
+    if (enabled) {
+        glEnable(cap);
+    } else {
+        glDisable(cap);
+    }
+    count_issued();
+}
+
+bool gl_state_is_enabled(GLenum cap) {
+    for (int i = 0; i < CAP_COUNT; i++) {
+        if (caps[i].cap != cap) continue;
+        // Desconocido: se pregunta una vez al driver y queda en la caché
+        if (caps[i].enabled < 0) caps[i].enabled = glIsEnabled(cap) ? 1 : 0;
+        return caps[i].enabled == 1;
+    }
+    return glIsEnabled(cap) == GL_TRUE;
+}
+
+void gl_state_depth_mask(GLboolean mask) {
+    if (depth_mask_known && depth_mask_value == mask) {
+        count_filtered();
+        return;
+    }
+    depth_mask_known = true;
+    depth_mask_value = mask;
+    glDepthMask(mask);
+    count_issued();
+}
+
+void gl_state_depth_func(GLenum func) {
+    if (depth_func_known && depth_func_value == func) {
+        count_filtered();
+        return;
+    }
+    depth_func_known = true;
+    depth_func_value = func;
+    glDepthFunc(func);
+    count_issued();
+}
+
+void gl_state_blend_func(GLenum src, GLenum dst) {
+    if (blend_func_known && blend_src_value == src && blend_dst_value == dst) {
+        count_filtered();
+        return;
+    }
+    blend_func_known = true;
+    blend_src_value = src;
+    blend_dst_value = dst;
+    glBlendFunc(src, dst);
+    count_issued();
+}
+
+void gl_state_material(const GLMaterial* material) {
+    // Cada componente se compara por separado: los materiales comparten valores
+    if (material_known[0] && vec4_equal(material_value.ambient, material->ambient)) {
+        count_filtered();
+    } else {
+        memcpy(material_value.ambient, material->ambient, sizeof(material->ambient));
+        material_known[0] = true;
+        glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, material->ambient);
+        count_issued();
+    }
+
+    if (material_known[1] && vec4_equal(material_value.diffuse, material->diffuse)) {
+        count_filtered();
+    } else {
+        memcpy(material_value.diffuse, material->diffuse, sizeof(material->diffuse));
+        material_known[1] = true;
+        glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, material->diffuse);
+        count_issued();
+    }
+
+    if (material_known[2] && vec4_equal(material_value.specular, material->specular)) {
+        count_filtered();
+    } else {
+        memcpy(material_value.specular, material->specular, sizeof(material->specular));
+        material_known[2] = true;
+        glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, material->specular);
+        count_issued();
+    }
+
+    if (material_known[3] && material_value.shininess == material->shininess) {
+        count_filtered();
+    } else {
+        material_value.shininess = material->shininess;
+        material_known[3] = true;
+        glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, material->shininess);
+        count_issued();
+    }
+}
+
+void gl_state_fog(const GLFog* fog) {
+    if (fog_known && fog_value.mode == fog->mode && fog_value.density == fog->density &&
+        fog_value.start == fog->start && fog_value.end == fog->end &&
+        vec4_equal(fog_value.color, fog->color)) {
+        // Modo, densidad, inicio, fin y color
+        gl_state_stats.calls_filtered += 5;
+        return;
+    }
+
+    fog_known = true;
+    fog_value = *fog;
+    glFogi(GL_FOG_MODE, fog->mode);
+    glFogf(GL_FOG_DENSITY, fog->density);
+    glFogf(GL_FOG_START, fog->start);
+    glFogf(GL_FOG_END, fog->end);
+    glFogfv(GL_FOG_COLOR, fog->color);
+    gl_state_stats.calls_issued += 5;
+}
+
+void gl_state_light(GLenum light, GLenum pname, const GLfloat* params) {
+    int index = (int)(light - GL_LIGHT0);
+    int slot = -1;
+    if (pname == GL_AMBIENT) slot = 0;
+    else if (pname == GL_DIFFUSE) slot = 1;
+    else if (pname == GL_SPECULAR) slot = 2;
+
+    if (index >= 0 && index < GL_STATE_MAX_LIGHTS && slot >= 0) {
+        LightState* state = &lights[index];
+        if (state->known[slot] && vec4_equal(state->color[slot], params)) {
+            count_filtered();
+            return;
+        }
+        state->known[slot] = true;
+        memcpy(state->color[slot], params, sizeof(state->color[slot]));
+    }
+
+    glLightfv(light, pname, params);
+    count_issued();
+}
+
+void gl_state_lightf(GLenum light, GLenum pname, GLfloat param) {
+    int index = (int)(light - GL_LIGHT0);
+    int slot = -1;
+    if (pname == GL_CONSTANT_ATTENUATION) slot = 0;
+    else if (pname == GL_LINEAR_ATTENUATION) slot = 1;
+    else if (pname == GL_QUADRATIC_ATTENUATION) slot = 2;
+    else if (pname == GL_SPOT_CUTOFF) slot = 3;
+
+    if (index >= 0 && index < GL_STATE_MAX_LIGHTS && slot >= 0) {
+        LightState* state = &lights[index];
+        if (state->scalar_known[slot] && state->scalar[slot] == param) {
+            count_filtered();
+            return;
+        }
+        state->scalar_known[slot] = true;
+        state->scalar[slot] = param;
+    }
+
+    glLightf(light, pname, param);
+    count_issued();
+}
+
+void gl_state_submit(const GLMaterial* material, GLDrawFunc draw, void* data) {
+    if (draw_count >= GL_STATE_MAX_DRAWS) {
+        // Cola llena: dibujar directamente sin ordenar
+        if (material) gl_state_material(material);
+        draw(data);
+        return;
+    }
+
+    DrawEntry* entry = &draw_queue[draw_count];
+    entry->material = material;
+    entry->draw = draw;
+    entry->data = data;
+    entry->order = draw_count;
+    draw_count++;
+}
+
+static bool draw_entry_before(const DrawEntry* a, const DrawEntry* b) {
+    uintptr_t ma = (uintptr_t)a->material;
+    uintptr_t mb = (uintptr_t)b->material;
+    if (ma != mb) return ma < mb;
+    return a->order < b->order;
+}
+
+void gl_state_flush_draws() {
+    // Ordenación por inserción: la cola es corta y casi siempre llega ordenada
+    for (int i = 1; i < draw_count; i++) {
+        DrawEntry entry = draw_queue[i];
+        int j = i - 1;
+        while (j >= 0 && draw_entry_before(&entry, &draw_queue[j])) {
+            draw_queue[j + 1] = draw_queue[j];
+            j--;
+        }
+        draw_queue[j + 1] = entry;
+    }
+
+    // Los dibujos con el mismo material quedan contiguos y solo el primero lo cambia
+    for (int i = 0; i < draw_count; i++) {
+        if (draw_queue[i].material) gl_state_material(draw_queue[i].material);
+        draw_queue[i].draw(draw_queue[i].data);
+    }
+    draw_count = 0;
+}
@@ -0,0 +1,61 @@
+// gl_state.h - Caché del estado fijo de OpenGL para filtrar llamadas redundantes
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <GL/gl.h>
+#include <stdbool.h>
+
+// Máximo de dibujos encolados por pasada ordenada
+#define GL_STATE_MAX_DRAWS 64
+
+// Material completo (los cuatro parámetros que usan los módulos)
+typedef struct {
+    GLfloat ambient[4];
+    GLfloat diffuse[4];
+    GLfloat specular[4];
+    GLfloat shininess;
+} GLMaterial;
+
+// Parámetros de niebla
+typedef struct {
+    GLint mode;
+    GLfloat density;
+    GLfloat start;
+    GLfloat end;
+    GLfloat color[4];
+} GLFog;
+
+// Contadores de llamadas GL de estado
+typedef struct {
+    long calls_issued;     // Llamadas que llegaron al driver
+    long calls_filtered;   // Llamadas descartadas por redundantes
+    long draw_calls;       // Llamadas de dibujo del mundo (glBegin/glDrawArrays)
+    long vertices;         // Vértices enviados en esas llamadas
+} GLStateStats;
+
+// Función de dibujo encolable
+typedef void (*GLDrawFunc)(void* data);
+
+extern GLStateStats gl_state_stats;        // Frame en curso
+extern GLStateStats gl_state_last_frame;   // Último frame completo
+
+// Funciones de la caché (requieren un contexto activo)
+void init_gl_state();
+void gl_state_invalidate();
+void gl_state_begin_frame();
+void gl_state_enable(GLenum cap, bool enabled);
+bool gl_state_is_enabled(GLenum cap);     // Valor de la caché (o del driver si no se conoce)
+void gl_state_depth_mask(GLboolean mask);
+void gl_state_depth_func(GLenum func);
+void gl_state_blend_func(GLenum src, GLenum dst);
+void gl_state_material(const GLMaterial* material);
+void gl_state_fog(const GLFog* fog);
+void gl_state_light(GLenum light, GLenum pname, const GLfloat* params);
+void gl_state_lightf(GLenum light, GLenum pname, GLfloat param);
+void gl_state_count_draw(long vertices);   // Contabilizar una llamada de dibujo
+
+// Pasada de dibujo ordenada por material
+void gl_state_submit(const GLMaterial* material, GLDrawFunc draw, void* data);
+void gl_state_flush_draws();
+
+#endif // GL_STATE_H
@@ -0,0 +1,145 @@
+// headless.c - Contexto OpenGL sin ventana para el benchmark (EGL surfaceless / ventana oculta)
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include "headless.h"
+#include "gl_ext.h"
+#include <stdio.h>
+
+#ifndef _WIN32
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+static EGLDisplay egl_display = EGL_NO_DISPLAY;
+static EGLContext egl_context = EGL_NO_CONTEXT;
+#else
+static GLFWwindow* hidden_window = NULL;
+#endif
+
+// Framebuffer en el que se dibuja en lugar de la ventana
+static GLuint framebuffer = 0;
+static GLuint renderbuffers[2] = {0, 0};
+
+#ifndef _WIN32
+static GLProc egl_proc_address(const char* name) {
+    return (GLProc)eglGetProcAddress(name);
+}
+
+// Sin GLFW: el reloj es el de timer.c, así que sirve cualquier versión de GLFW
+static bool create_context() {
+    // Display surfaceless de Mesa: sin X11/Wayland ni GPU; si no existe, el display por defecto
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (get_platform_display) {
+        egl_display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    }
+    if (egl_display == EGL_NO_DISPLAY) egl_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (egl_display == EGL_NO_DISPLAY || !eglInitialize(egl_display, NULL, NULL)) {
+        printf("Error al inicializar EGL\n");
+        return false;
+    }
+
+    // Perfil de compatibilidad: el renderer usa el pipeline fijo
+    eglBindAPI(EGL_OPENGL_API);
+    const EGLint config_attributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config = NULL;
+    EGLint config_count = 0;
+    eglChooseConfig(egl_display, config_attributes, &config, 1, &config_count);
+
+    const EGLint context_attributes[] = {
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT,
+        EGL_NONE
+    };
+    egl_context = eglCreateContext(egl_display, config_count > 0 ? config : (EGLConfig)0,
+                                   EGL_NO_CONTEXT, context_attributes);
+    if (egl_context == EGL_NO_CONTEXT ||
+        !eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, egl_context)) {
+        printf("Error al crear el contexto EGL sin superficie\n");
+        return false;
+    }
+
+    init_gl_extensions_with_loader(egl_proc_address);
+    return true;
+}
+#else
+static bool create_context() {
+    if (!glfwInit()) {
+        printf("Error al inicializar GLFW\n");
+        return false;
+    }
+
+    // Ventana que nunca se muestra: solo aporta el contexto
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    hidden_window = glfwCreateWindow(64, 64, "Deeper - Benchmark", NULL, NULL);
+    if (!hidden_window) {
+        printf("No se pudo crear la ventana oculta\n");
+        return false;
+    }
+    glfwMakeContextCurrent(hidden_window);
+    glfwSwapInterval(0);
+
+    init_gl_extensions();
+    return true;
+}
+#endif
+
+bool init_headless_context(int width, int height) {
+    if (!create_context()) return false;
+
+    if (!gl_has_framebuffers) {
+        printf("El contexto no soporta framebuffers: benchmark sin ventana no disponible\n");
+        return false;
+    }
+
+    // Color RGBA8 y profundidad de 24 bits, como la ventana del juego
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glGenRenderbuffers(2, renderbuffers);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        printf("Framebuffer sin ventana incompleto\n");
+        return false;
+    }
+
+    glDrawBuffer(GL_COLOR_ATTACHMENT0);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    printf("Contexto sin ventana: %dx%d en %s\n", width, height, (const char*)glGetString(GL_RENDERER));
+    return true;
+}
+
+void cleanup_headless_context() {
+    if (framebuffer) {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteRenderbuffers(2, renderbuffers);
+        glDeleteFramebuffers(1, &framebuffer);
+        framebuffer = 0;
+    }
+#ifndef _WIN32
+    if (egl_display != EGL_NO_DISPLAY) {
+        eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (egl_context != EGL_NO_CONTEXT) eglDestroyContext(egl_display, egl_context);
+        eglTerminate(egl_display);
+        egl_display = EGL_NO_DISPLAY;
+        egl_context = EGL_NO_CONTEXT;
+    }
+#else
+    if (hidden_window) {
+        glfwDestroyWindow(hidden_window);
+        hidden_window = NULL;
+    }
+    glfwTerminate();
+#endif
+}
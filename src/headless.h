@@ -0,0 +1,13 @@
+// headless.h - Contexto OpenGL sin ventana para el benchmark (EGL surfaceless / ventana oculta)
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <stdbool.h>
+
+// Crea el contexto, carga las extensiones y deja activo un framebuffer de width x height.
+// Linux: EGL surfaceless de Mesa (funciona sin GPU con llvmpipe), sin inicializar GLFW.
+// Windows: ventana oculta de GLFW.
+bool init_headless_context(int width, int height);
+void cleanup_headless_context();
+
+#endif // HEADLESS_H
@@ -1,6 +1,7 @@
 // input.c - Sistema de input para Backrooms 3D
 #include "input.h"
 #include "player.h"
+#include "profiler.h"
 #include <stdio.h>
 
 // Definir M_PI si no está definido
@@ -90,6 +91,9 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
             case GLFW_KEY_SPACE:
                 // El salto se maneja en handle_jumping()
                 break;
+            case PROFILER_TOGGLE_KEY:
+                profiler_toggle_overlay();
+                break;
             case GLFW_KEY_ESCAPE:
                 if (mouseCaptured) {
                     mouseCaptured = false;
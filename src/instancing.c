@@ -0,0 +1,285 @@
+// instancing.c - Muros y decoración dibujados con instancing por hardware
+#include "instancing.h"
+#include "gl_ext.h"
+#include "gl_state.h"
+#include "render.h"
+#include "map.h"
+#include "player.h"
+#include "frustum.h"
+#include "occlusion.h"
+#include "pvs.h"
+#include "wall_mesh.h"
+#include "light_clusters.h"
+#include "lod.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Atributos por instancia (índices asignados por gl_build_program desde 1)
+#define ATTRIB_INSTANCE_POSITION 1
+#define ATTRIB_INSTANCE_SIZE 2
+
+bool instancing_ready = false;
+InstancingStats instancing_stats = {0, 0, 0};
+
+static GLuint program = 0;
+static GLuint cube_vbo = 0;
+static GLuint instance_vbo = 0;
+
+// Instancias del frame: muros desde el inicio, decoración desde el final
+static float* instances = NULL;
+static int max_instances = 0;
+
+// Reproduce la iluminación fija por vértice (como la ruta de chunks) y la niebla EXP2
+static const char* vertex_source =
+    "#version 120\n"
+    "attribute vec3 instance_position;\n"
+    "attribute vec2 instance_size;\n"
+    "void main() {\n"
+    "    vec3 scale = vec3(instance_size.x, instance_size.y, instance_size.x);\n"
+    "    vec4 world = vec4(instance_position + gl_Vertex.xyz * scale, 1.0);\n"
+    "    vec4 eye = gl_ModelViewMatrix * world;\n"
+    "    vec3 n = normalize(gl_NormalMatrix * gl_Normal);\n"
+    "    vec4 color = gl_FrontLightModelProduct.sceneColor;\n"
+    "    for (int i = 0; i < 3; i++) {\n"
+    "        vec4 light_position = gl_LightSource[i].position;\n"
+    "        vec3 l = light_position.xyz - eye.xyz * light_position.w;\n"
+    "        float d = length(l);\n"
+    "        l /= d;\n"
+    "        float attenuation = 1.0;\n"
+    "        if (light_position.w != 0.0) {\n"
+    "            attenuation = 1.0 / (gl_LightSource[i].constantAttenuation +\n"
+    "                                 gl_LightSource[i].linearAttenuation * d +\n"
+    "                                 gl_LightSource[i].quadraticAttenuation * d * d);\n"
+    "        }\n"
+    "        float n_dot_l = max(dot(n, l), 0.0);\n"
+    "        vec4 term = gl_FrontLightProduct[i].ambient + gl_FrontLightProduct[i].diffuse * n_dot_l;\n"
+    "        if (n_dot_l > 0.0) {\n"
+    "            vec3 h = normalize(l + vec3(0.0, 0.0, 1.0));\n"
+    "            term += gl_FrontLightProduct[i].specular *\n"
+    "                    pow(max(dot(n, h), 0.0), gl_FrontMaterial.shininess);\n"
+    "        }\n"
+    "        color += term * attenuation;\n"
+    "    }\n"
+    "    gl_FrontColor = vec4(color.rgb, 1.0);\n"
+    "    gl_FogFragCoord = abs(eye.z);\n"
+    "    gl_Position = gl_ProjectionMatrix * eye;\n"
+    "}\n";
+
+static const char* fragment_source =
+    "#version 120\n"
+    "void main() {\n"
+    "    float f = gl_Fog.density * gl_FogFragCoord;\n"
+    "    float fog = clamp(exp(-f * f), 0.0, 1.0);\n"
+    "    gl_FragColor = vec4(mix(gl_Fog.color.rgb, gl_Color.rgb, fog), 1.0);\n"
+    "}\n";
+
+// Cubo unitario: [-0.5, 0.5] en X/Z y [0, 1] en Y, mismo orden que draw_cube
+static const float cube_vertices[] = {
+    // Cara frontal (Z+)
+    0, 0, 1,  -0.5f, 0, 0.5f,   0, 0, 1,  0.5f, 0, 0.5f,
+    0, 0, 1,  0.5f, 1, 0.5f,    0, 0, 1,  -0.5f, 1, 0.5f,
+    // Cara trasera (Z-)
+    0, 0, -1,  -0.5f, 0, -0.5f,  0, 0, -1,  -0.5f, 1, -0.5f,
+    0, 0, -1,  0.5f, 1, -0.5f,   0, 0, -1,  0.5f, 0, -0.5f,
+    // Cara izquierda (X-)
+    -1, 0, 0,  -0.5f, 0, -0.5f,  -1, 0, 0,  -0.5f, 0, 0.5f,
+    -1, 0, 0,  -0.5f, 1, 0.5f,   -1, 0, 0,  -0.5f, 1, -0.5f,
+    // Cara derecha (X+)
+    1, 0, 0,  0.5f, 0, -0.5f,  1, 0, 0,  0.5f, 1, -0.5f,
+    1, 0, 0,  0.5f, 1, 0.5f,   1, 0, 0,  0.5f, 0, 0.5f,
+    // Cara superior (Y+)
+    0, 1, 0,  -0.5f, 1, -0.5f,  0, 1, 0,  -0.5f, 1, 0.5f,
+    0, 1, 0,  0.5f, 1, 0.5f,    0, 1, 0,  0.5f, 1, -0.5f,
+    // Cara inferior (Y-)
+    0, -1, 0,  -0.5f, 0, -0.5f,  0, -1, 0,  0.5f, 0, -0.5f,
+    0, -1, 0,  0.5f, 0, 0.5f,    0, -1, 0,  -0.5f, 0, 0.5f
+};
+#define CUBE_VERTEX_COUNT 24
+
+bool init_instancing() {
+    instancing_ready = false;
+    if (!gl_has_instancing) {
+        printf("Instancing no disponible: se usará la ruta de chunks\n");
+        return false;
+    }
+
+    const char* attributes[] = {"instance_position", "instance_size"};
+    program = gl_build_program(vertex_source, fragment_source, attributes, 2);
+    if (!program) {
+        printf("Instancing desactivado: el programa GLSL no compiló\n");
+        return false;
+    }
+
+    // Una instancia como máximo por celda de la ventana alrededor del jugador
+    // (o del mapa entero si es más pequeño)
+    int window = 2 * INSTANCING_MAX_RADIUS + 2;
+    max_instances = window * window;
+    if (max_instances > maze_width * maze_height) max_instances = maze_width * maze_height;
+    instances = (float*)malloc(sizeof(float) * INSTANCE_FLOATS * (size_t)max_instances);
+    if (!instances) {
+        printf("Error: Sin memoria para las instancias\n");
+        cleanup_instancing();
+        return false;
+    }
+
+    glGenBuffers(1, &cube_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, cube_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(cube_vertices), cube_vertices, GL_STATIC_DRAW);
+
+    glGenBuffers(1, &instance_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(sizeof(float) * INSTANCE_FLOATS * max_instances),
+                 NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    instancing_ready = true;
+    printf("Instancing listo: hasta %d instancias por frame\n", max_instances);
+    return true;
+}
+
+static void put_instance(float* out, float x, float y, float z, float width, float height) {
+    out[0] = x;
+    out[1] = y;
+    out[2] = z;
+    out[3] = width;
+    out[4] = height;
+}
+
+// Recoge las celdas visibles con los mismos tests que la ruta inmediata
+static void collect_instances(float render_distance, int* wall_count, int* decor_count) {
+    if (render_distance > INSTANCING_MAX_RADIUS) render_distance = INSTANCING_MAX_RADIUS;
+    float render_distance_sq = render_distance * render_distance;
+    int walls = 0;
+    int decor = 0;
+
+    int start_x = (int)(player.x - render_distance);
+    int end_x = (int)(player.x + render_distance);
+    int start_z = (int)(player.z - render_distance);
+    int end_z = (int)(player.z + render_distance);
+    if (start_x < 0) start_x = 0;
+    if (end_x >= maze_width) end_x = maze_width - 1;
+    if (start_z < 0) start_z = 0;
+    if (end_z >= maze_height) end_z = maze_height - 1;
+
+    const unsigned char* pvs = pvs_lookup(player.x, player.z);
+    int chunk_cols = (maze_width + WALL_CHUNK_SIZE - 1) / WALL_CHUNK_SIZE;
+
+    for (int x = start_x; x <= end_x; x++) {
+        for (int z = start_z; z <= end_z; z++) {
+            int cell = maze_cell(x, z);
+            if (cell == 0) continue;
+            if (pvs && !pvs_bit(pvs, (z / WALL_CHUNK_SIZE) * chunk_cols + x / WALL_CHUNK_SIZE)) continue;
+
+            float dx = x - player.x;
+            float dz = z - player.z;
+            if (dx * dx + dz * dz > render_distance_sq) continue;
+            if (!occlusion_cell_visible(x, z)) continue;
+
+            float height = cell == 1 ? (float)MAZE_LEVELS : 0.4f;
+            if (!frustum_test_box(x - 0.5f, 0.0f, z - 0.5f, x + 0.5f, height, z + 0.5f)) {
+                frustum_stats.cells_rejected++;
+                continue;
+            }
+            frustum_stats.cells_accepted++;
+
+            if (cell == 1) {
+                // Columna completa de muro
+                put_instance(instances + walls * INSTANCE_FLOATS, x, 0.0f, z, 1.0f, (float)MAZE_LEVELS);
+                walls++;
+            } else if (cell == 2) {
+                // La decoración lejana queda oculta por la niebla
+                if (lod_cell_tier(x, z, dx * dx + dz * dz) == LOD_TIER_FAR) continue;
+
+                // Cubo decorativo de 0.2 centrado a 0.3 de altura (como draw_cube)
+                decor++;
+                put_instance(instances + (max_instances - decor) * INSTANCE_FLOATS,
+                             x, 0.2f, z, 0.2f, 0.2f);
+            }
+        }
+    }
+
+    *wall_count = walls;
+    *decor_count = decor;
+}
+
+static void draw_instances(int first, int count) {
+    if (count == 0) return;
+    size_t offset = sizeof(float) * INSTANCE_FLOATS * (size_t)first;
+    GLsizei stride = sizeof(float) * INSTANCE_FLOATS;
+    glVertexAttribPointer(ATTRIB_INSTANCE_POSITION, 3, GL_FLOAT, GL_FALSE, stride, (const void*)offset);
+    glVertexAttribPointer(ATTRIB_INSTANCE_SIZE, 2, GL_FLOAT, GL_FALSE, stride,
+                          (const void*)(offset + sizeof(float) * 3));
+    glDrawArraysInstanced(GL_QUADS, 0, CUBE_VERTEX_COUNT, count);
+    instancing_stats.draw_calls++;
+    gl_state_count_draw((long)CUBE_VERTEX_COUNT * count);
+}
+
+void render_instanced_walls(float render_distance) {
+    instancing_stats.wall_instances = 0;
+    instancing_stats.decor_instances = 0;
+    instancing_stats.draw_calls = 0;
+    if (!instancing_ready) return;
+
+    int wall_count = 0;
+    int decor_count = 0;
+    collect_instances(render_distance, &wall_count, &decor_count);
+    instancing_stats.wall_instances = wall_count;
+    instancing_stats.decor_instances = decor_count;
+    if (wall_count + decor_count == 0) return;
+
+    // Subir solo los tramos usados; el buffer se huérfana para no esperar a la GPU
+    glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(sizeof(float) * INSTANCE_FLOATS * max_instances),
+                 NULL, GL_STREAM_DRAW);
+    if (wall_count > 0) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(sizeof(float) * INSTANCE_FLOATS * wall_count),
+                        instances);
+    }
+    if (decor_count > 0) {
+        GLintptr offset = (GLintptr)(sizeof(float) * INSTANCE_FLOATS * (max_instances - decor_count));
+        glBufferSubData(GL_ARRAY_BUFFER, offset, (GLsizeiptr)(sizeof(float) * INSTANCE_FLOATS * decor_count),
+                        instances + (max_instances - decor_count) * INSTANCE_FLOATS);
+    }
+
+    // Muros y decoración comparten material: lo lee el shader vía gl_FrontMaterial
+    gl_state_enable(GL_BLEND, false);
+    gl_state_depth_mask(GL_TRUE);
+    gl_state_material(&material_wall);
+    if (!clustered_lighting_bind(true)) glUseProgram(program);
+
+    // Geometría del cubo desde los arrays fijos (gl_Vertex / gl_Normal)
+    glBindBuffer(GL_ARRAY_BUFFER, cube_vbo);
+    glInterleavedArrays(GL_N3F_V3F, 0, (const GLvoid*)0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+    glEnableVertexAttribArray(ATTRIB_INSTANCE_POSITION);
+    glEnableVertexAttribArray(ATTRIB_INSTANCE_SIZE);
+    glVertexAttribDivisor(ATTRIB_INSTANCE_POSITION, 1);
+    glVertexAttribDivisor(ATTRIB_INSTANCE_SIZE, 1);
+
+    // Una llamada para todos los muros y otra para toda la decoración
+    draw_instances(0, wall_count);
+    draw_instances(max_instances - decor_count, decor_count);
+
+    glVertexAttribDivisor(ATTRIB_INSTANCE_POSITION, 0);
+    glVertexAttribDivisor(ATTRIB_INSTANCE_SIZE, 0);
+    glDisableVertexAttribArray(ATTRIB_INSTANCE_POSITION);
+    glDisableVertexAttribArray(ATTRIB_INSTANCE_SIZE);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    if (!clustered_lighting_bind(false)) glUseProgram(0);
+}
+
+void cleanup_instancing() {
+    if (cube_vbo) glDeleteBuffers(1, &cube_vbo);
+    if (instance_vbo) glDeleteBuffers(1, &instance_vbo);
+    if (program) glDeleteProgram(program);
+    cube_vbo = 0;
+    instance_vbo = 0;
+    program = 0;
+    free(instances);
+    instances = NULL;
+    max_instances = 0;
+    instancing_ready = false;
+}
@@ -0,0 +1,26 @@
+// instancing.h - Muros y decoración dibujados con instancing por hardware
+#ifndef INSTANCING_H
+#define INSTANCING_H
+
+#include <stdbool.h>
+
+// Formato de instancia: x, y base, z, ancho, alto
+#define INSTANCE_FLOATS 5
+#define INSTANCING_MAX_RADIUS 48    // Celdas alrededor del jugador que caben en el buffer
+
+// Estadísticas del último frame
+typedef struct {
+    int wall_instances;
+    int decor_instances;
+    int draw_calls;
+} InstancingStats;
+
+extern bool instancing_ready;
+extern InstancingStats instancing_stats;
+
+// Funciones del renderizador instanciado (requieren un contexto activo)
+bool init_instancing();
+void render_instanced_walls(float render_distance);
+void cleanup_instancing();
+
+#endif // INSTANCING_H
@@ -0,0 +1,485 @@
+// light_clusters.c - Iluminación por clusters en GLSL para todos los lightPoints[]
+#include "light_clusters.h"
+#include "gl_ext.h"
+#include "map.h"
+#include "player.h"
+#include "frustum.h"
+#include "light_visibility.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Unidades de textura reservadas (la 0 queda libre para texturas normales)
+#define UNIT_LIGHTS 1
+#define UNIT_CLUSTERS 2
+#define UNIT_INDICES 3
+#define UNIT_VISIBILITY 4
+
+bool clustered_lighting_ready = false;
+bool clustered_lighting_enabled = true;
+LightClusterStats light_cluster_stats = {0, 0, 0, 0, 0};
+
+static GLuint programs[2] = {0, 0};      // [0] geometría normal, [1] instanciada
+static GLuint light_texture = 0;         // 2 filas por luz: (x, y, z, rango) y (r, g, b, 0)
+static GLuint cluster_texture = 0;       // (primer índice, número de luces) por cluster
+static GLuint index_texture = 0;         // Índices de luz consecutivos por cluster
+static GLuint visibility_texture = 0;    // Celdas visibles de cada luz (0 o 255)
+static bool active = false;
+static GLint offset_location = -1;      // object_offset del programa de geometría normal
+static float bound_offset_x = 0.0f;     // Último valor subido a object_offset
+static float bound_offset_z = 0.0f;
+
+// Rejilla de clusters (cubre el mapa: cada celda x ocupa [x - 0.5, x + 0.5])
+static int cluster_cols = 0;
+static int cluster_rows = 0;
+static float grid_origin_x = -0.5f;
+static float grid_origin_z = -0.5f;
+
+// Tablas dimensionadas al crear los clusters según las luces del mapa
+static int light_slots = 0;             // Luces que caben en las tablas y en visible_lights[]
+static int light_table_rows = 0;        // Filas de la textura de luces (2 por cada fila de luces)
+static int visibility_tiles_per_row = 0;
+static int visibility_tile_rows = 0;
+static int visibility_lights = 0;       // Luces con ventana de visibilidad en el mosaico
+
+// Datos en CPU reconstruidos cada frame
+static float* cluster_data = NULL;      // 4 floats por cluster
+static float* index_data = NULL;        // LIGHT_CLUSTER_MAX_INDICES floats
+static int* cluster_counts = NULL;
+static int* visible_lights = NULL;      // Una entrada por luz del mapa
+
+// El vértice reproduce la iluminación fija de LIGHT0..LIGHT2 (linterna, enemigo y
+// ambiental); el fragmento suma solo las luces del mapa de su cluster que ven su
+// celda y aplica la niebla
+static const char* vertex_source =
+    "#ifdef INSTANCED\n"
+    "in vec3 instance_position;\n"
+    "in vec2 instance_size;\n"
+    "#endif\n"
+    "uniform vec2 object_offset;\n"
+    "out vec3 world_position;\n"
+    "out vec3 world_normal;\n"
+    "out float fog_depth;\n"
+    "void main() {\n"
+    "    vec4 world = gl_Vertex;\n"
+    "#ifdef INSTANCED\n"
+    "    vec3 scale = vec3(instance_size.x, instance_size.y, instance_size.x);\n"
+    "    world = vec4(instance_position + gl_Vertex.xyz * scale, 1.0);\n"
+    "#endif\n"
+    "    vec4 eye = gl_ModelViewMatrix * world;\n"
+    "    vec3 n = normalize(gl_NormalMatrix * gl_Normal);\n"
+    "    vec4 color = gl_FrontLightModelProduct.sceneColor;\n"
+    "    for (int i = 0; i < 3; i++) {\n"
+    "        vec4 light_position = gl_LightSource[i].position;\n"
+    "        vec3 l = light_position.xyz - eye.xyz * light_position.w;\n"
+    "        float d = length(l);\n"
+    "        l /= d;\n"
+    "        float attenuation = 1.0;\n"
+    "        if (light_position.w != 0.0) {\n"
+    "            attenuation = 1.0 / (gl_LightSource[i].constantAttenuation +\n"
+    "                                 gl_LightSource[i].linearAttenuation * d +\n"
+    "                                 gl_LightSource[i].quadraticAttenuation * d * d);\n"
+    "        }\n"
+    "        float n_dot_l = max(dot(n, l), 0.0);\n"
+    "        vec4 term = gl_FrontLightProduct[i].ambient + gl_FrontLightProduct[i].diffuse * n_dot_l;\n"
+    "        if (n_dot_l > 0.0) {\n"
+    "            vec3 h = normalize(l + vec3(0.0, 0.0, 1.0));\n"
+    "            term += gl_FrontLightProduct[i].specular *\n"
+    "                    pow(max(dot(n, h), 0.0), gl_FrontMaterial.shininess);\n"
+    "        }\n"
+    "        color += term * attenuation;\n"
+    "    }\n"
+    "    gl_FrontColor = vec4(color.rgb, 1.0);\n"
+    "    world_position = world.xyz + vec3(object_offset.x, 0.0, object_offset.y);\n"
+    "    world_normal = gl_Normal;\n"
+    "    fog_depth = abs(eye.z);\n"
+    "    gl_Position = gl_ProjectionMatrix * eye;\n"
+    "}\n";
+
+static const char* fragment_source =
+    "uniform sampler2D light_data;\n"
+    "uniform sampler2D cluster_data;\n"
+    "uniform sampler2D light_indices;\n"
+    "uniform sampler2D light_visibility;\n"
+    "uniform int visibility_radius;\n"
+    "uniform int visibility_tiles_per_row;\n"
+    "uniform int visibility_lights;\n"
+    "uniform int light_table_width;\n"
+    "uniform vec2 cluster_origin;\n"
+    "uniform float cluster_size;\n"
+    "uniform ivec2 cluster_count;\n"
+    "uniform int index_width;\n"
+    "in vec3 world_position;\n"
+    "in vec3 world_normal;\n"
+    "in float fog_depth;\n"
+    "void main() {\n"
+    "    vec3 color = gl_Color.rgb;\n"
+    "    ivec2 cell = ivec2(floor((world_position.xz - cluster_origin) / cluster_size));\n"
+    "    if (all(greaterThanEqual(cell, ivec2(0))) && all(lessThan(cell, cluster_count))) {\n"
+    "        vec4 cluster = texelFetch(cluster_data, cell, 0);\n"
+    "        int first = int(cluster.x);\n"
+    "        int count = int(cluster.y);\n"
+    "        vec3 n = normalize(world_normal);\n"
+    "        ivec2 sample_cell = ivec2(floor(world_position.xz + n.xz * 0.25 + 0.5));\n"
+    "        for (int i = 0; i < count; i++) {\n"
+    "            int slot = first + i;\n"
+    "            int index = int(texelFetch(light_indices, ivec2(slot % index_width, slot / index_width), 0).r);\n"
+    "            ivec2 light_texel = ivec2(index % light_table_width, (index / light_table_width) * 2);\n"
+    "            vec4 position = texelFetch(light_data, light_texel, 0);\n"
+    "            vec3 l = position.xyz - world_position;\n"
+    "            float d = length(l);\n"
+    "            if (d < position.w && index < visibility_lights) {\n"
+    "                // Celda (desplazada hacia la cara en los muros) dentro de la ventana de la luz\n"
+    "                ivec2 offset = sample_cell - ivec2(floor(position.xz + 0.5)) + ivec2(visibility_radius);\n"
+    "                ivec2 tile = ivec2(index % visibility_tiles_per_row, index / visibility_tiles_per_row);\n"
+    "                int size = visibility_radius * 2 + 1;\n"
+    "                if (any(lessThan(offset, ivec2(0))) || any(greaterThanEqual(offset, ivec2(size))) ||\n"
+    "                    texelFetch(light_visibility, tile * size + offset, 0).r < 0.5) d = position.w;\n"
+    "            }\n"
+    "            if (d < position.w) {\n"
+    "                float falloff = 1.0 - d / position.w;\n"
+    "                vec3 light_color = texelFetch(light_data, light_texel + ivec2(0, 1), 0).rgb;\n"
+    "                color += gl_FrontMaterial.diffuse.rgb * light_color *\n"
+    "                         max(dot(n, l / d), 0.0) * falloff * falloff;\n"
+    "            }\n"
+    "        }\n"
+    "    }\n"
+    "    float f = gl_Fog.density * fog_depth;\n"
+    "    float fog = clamp(exp(-f * f), 0.0, 1.0);\n"
+    "    gl_FragColor = vec4(mix(gl_Fog.color.rgb, color, fog), 1.0);\n"
+    "}\n";
+
+static GLuint create_data_texture(GLenum internal_format, GLenum format, GLenum type, int width, int height) {
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, type, NULL);
+    return texture;
+}
+
+// Color cálido de los fluorescentes escalado por la intensidad de cada luz.
+// La luz i ocupa la columna i % ancho de las filas 2 * (i / ancho) y la siguiente
+static void upload_light_table() {
+    float* rows = (float*)calloc((size_t)LIGHT_CLUSTER_TABLE_WIDTH * light_table_rows * 4, sizeof(float));
+    if (!rows) return;
+
+    for (int i = 0; i < lightCount; i++) {
+        float* position = rows + ((i / LIGHT_CLUSTER_TABLE_WIDTH) * 2 * LIGHT_CLUSTER_TABLE_WIDTH +
+                                  i % LIGHT_CLUSTER_TABLE_WIDTH) * 4;
+        float* color = position + LIGHT_CLUSTER_TABLE_WIDTH * 4;
+        position[0] = lightPoints[i].x;
+        position[1] = LIGHT_POINT_HEIGHT;
+        position[2] = lightPoints[i].z;
+        position[3] = lightPoints[i].range;
+        color[0] = LIGHT_POINT_RED * lightPoints[i].intensity;
+        color[1] = LIGHT_POINT_GREEN * lightPoints[i].intensity;
+        color[2] = LIGHT_POINT_BLUE * lightPoints[i].intensity;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, light_texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, LIGHT_CLUSTER_TABLE_WIDTH, light_table_rows, GL_RGBA, GL_FLOAT, rows);
+    free(rows);
+}
+
+// Ventanas de visibilidad precalculadas al generar el mapa, una baldosa por luz
+static void upload_light_visibility() {
+    static unsigned char tile[LIGHT_VISIBILITY_SIZE * LIGHT_VISIBILITY_SIZE];
+
+    glBindTexture(GL_TEXTURE_2D, visibility_texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int i = 0; i < visibility_lights; i++) {
+        const LightVisibility* visibility = light_visibility_get(i);
+        for (int c = 0; c < LIGHT_VISIBILITY_SIZE * LIGHT_VISIBILITY_SIZE; c++) {
+            tile[c] = visibility ? (unsigned char)(visibility->cells[c] ? 255 : 0) : 255;
+        }
+        glTexSubImage2D(GL_TEXTURE_2D, 0, (i % visibility_tiles_per_row) * LIGHT_VISIBILITY_SIZE,
+                        (i / visibility_tiles_per_row) * LIGHT_VISIBILITY_SIZE,
+                        LIGHT_VISIBILITY_SIZE, LIGHT_VISIBILITY_SIZE, GL_RED, GL_UNSIGNED_BYTE, tile);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+static void set_program_uniforms(GLuint program) {
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "light_data"), UNIT_LIGHTS);
+    glUniform1i(glGetUniformLocation(program, "cluster_data"), UNIT_CLUSTERS);
+    glUniform1i(glGetUniformLocation(program, "light_indices"), UNIT_INDICES);
+    glUniform2f(glGetUniformLocation(program, "cluster_origin"), grid_origin_x, grid_origin_z);
+    glUniform1f(glGetUniformLocation(program, "cluster_size"), LIGHT_CLUSTER_SIZE);
+    glUniform2i(glGetUniformLocation(program, "cluster_count"), cluster_cols, cluster_rows);
+    glUniform1i(glGetUniformLocation(program, "index_width"), LIGHT_CLUSTER_INDEX_WIDTH);
+    glUniform1i(glGetUniformLocation(program, "light_visibility"), UNIT_VISIBILITY);
+    glUniform1i(glGetUniformLocation(program, "visibility_radius"), LIGHT_VISIBILITY_RADIUS);
+    glUniform1i(glGetUniformLocation(program, "visibility_tiles_per_row"), visibility_tiles_per_row);
+    glUniform1i(glGetUniformLocation(program, "visibility_lights"), visibility_lights);
+    glUniform1i(glGetUniformLocation(program, "light_table_width"), LIGHT_CLUSTER_TABLE_WIDTH);
+    glUseProgram(0);
+}
+
+bool init_clustered_lighting() {
+    cleanup_clustered_lighting();
+    if (!gl_has_shaders) {
+        printf("Iluminación por clusters no disponible: sin shaders\n");
+        return false;
+    }
+
+    // GLSL 1.30 (texelFetch y enteros) en perfil de compatibilidad
+    const char* attributes[] = {"instance_position", "instance_size"};
+    programs[0] = gl_build_program_prefixed("#version 130\n", vertex_source, fragment_source, NULL, 0);
+    programs[1] = gl_build_program_prefixed("#version 130\n#define INSTANCED\n",
+                                            vertex_source, fragment_source, attributes, 2);
+    if (!programs[0] || !programs[1]) {
+        printf("Iluminación por clusters desactivada: el programa GLSL no compiló\n");
+        cleanup_clustered_lighting();
+        return false;
+    }
+    offset_location = glGetUniformLocation(programs[0], "object_offset");
+    bound_offset_x = bound_offset_z = 0.0f;
+
+    cluster_cols = (int)((maze_width + LIGHT_CLUSTER_SIZE - 1) / LIGHT_CLUSTER_SIZE);
+    cluster_rows = (int)((maze_height + LIGHT_CLUSTER_SIZE - 1) / LIGHT_CLUSTER_SIZE);
+    int cluster_total = cluster_cols * cluster_rows;
+
+    // Tablas según las luces del mapa: filas de luces y mosaico de visibilidad
+    // tan ancho como permita el driver
+    light_slots = lightCount > 0 ? lightCount : 1;
+    light_table_rows = 2 * ((light_slots + LIGHT_CLUSTER_TABLE_WIDTH - 1) / LIGHT_CLUSTER_TABLE_WIDTH);
+    GLint max_texture_size = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
+    int max_tiles = max_texture_size / LIGHT_VISIBILITY_SIZE;
+    visibility_tiles_per_row = light_slots < max_tiles ? light_slots : max_tiles;
+    visibility_tile_rows = (light_slots + visibility_tiles_per_row - 1) / visibility_tiles_per_row;
+    if (visibility_tile_rows > max_tiles) visibility_tile_rows = max_tiles;
+    visibility_lights = light_visibility_count;
+    if (visibility_lights > visibility_tiles_per_row * visibility_tile_rows) {
+        visibility_lights = visibility_tiles_per_row * visibility_tile_rows;   // El resto sin máscara
+    }
+
+    cluster_data = (float*)calloc((size_t)cluster_total * 4, sizeof(float));
+    cluster_counts = (int*)calloc((size_t)cluster_total, sizeof(int));
+    index_data = (float*)calloc(LIGHT_CLUSTER_MAX_INDICES, sizeof(float));
+    visible_lights = (int*)malloc(sizeof(int) * (size_t)light_slots);
+    if (!cluster_data || !cluster_counts || !index_data || !visible_lights) {
+        printf("Error: Sin memoria para los clusters de luz\n");
+        cleanup_clustered_lighting();
+        return false;
+    }
+
+    // Texturas de datos en coma flotante (OpenGL 3.0)
+    while (glGetError() != GL_NO_ERROR) {}
+    light_texture = create_data_texture(GL_RGBA32F, GL_RGBA, GL_FLOAT, LIGHT_CLUSTER_TABLE_WIDTH, light_table_rows);
+    cluster_texture = create_data_texture(GL_RGBA32F, GL_RGBA, GL_FLOAT, cluster_cols, cluster_rows);
+    index_texture = create_data_texture(GL_R32F, GL_RED, GL_FLOAT, LIGHT_CLUSTER_INDEX_WIDTH,
+                                        LIGHT_CLUSTER_MAX_INDICES / LIGHT_CLUSTER_INDEX_WIDTH);
+    visibility_texture = create_data_texture(GL_R8, GL_RED, GL_UNSIGNED_BYTE,
+                                             visibility_tiles_per_row * LIGHT_VISIBILITY_SIZE,
+                                             visibility_tile_rows * LIGHT_VISIBILITY_SIZE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    if (glGetError() != GL_NO_ERROR) {
+        printf("Iluminación por clusters desactivada: sin texturas float\n");
+        cleanup_clustered_lighting();
+        return false;
+    }
+
+    upload_light_table();
+    upload_light_visibility();
+    set_program_uniforms(programs[0]);
+    set_program_uniforms(programs[1]);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    clustered_lighting_ready = true;
+    if (map_verbose) {
+        printf("Iluminación por clusters: %d luces del mapa, rejilla %dx%d de %.0f unidades\n",
+               lightCount, cluster_cols, cluster_rows, LIGHT_CLUSTER_SIZE);
+    }
+    return true;
+}
+
+void refresh_clustered_lights() {
+    if (!clustered_lighting_ready) return;
+
+    // Más luces de las que caben: rehacer las tablas desde cero
+    if (lightCount > light_slots) {
+        init_clustered_lighting();
+        return;
+    }
+
+    visibility_lights = light_visibility_count;
+    if (visibility_lights > visibility_tiles_per_row * visibility_tile_rows) {
+        visibility_lights = visibility_tiles_per_row * visibility_tile_rows;
+    }
+    upload_light_table();
+    upload_light_visibility();
+    set_program_uniforms(programs[0]);
+    set_program_uniforms(programs[1]);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// Esfera de la luz contra los 6 planos del frustum
+static bool light_in_frustum(float x, float y, float z, float radius) {
+    for (int i = 0; i < 6; i++) {
+        const FrustumPlane* p = &frustum_planes[i];
+        if (p->a * x + p->b * y + p->c * z + p->d < -radius) return false;
+    }
+    return true;
+}
+
+static void light_cluster_bounds(const LightPoint* light, int* x0, int* z0, int* x1, int* z1) {
+    *x0 = (int)((light->x - light->range - grid_origin_x) / LIGHT_CLUSTER_SIZE);
+    *z0 = (int)((light->z - light->range - grid_origin_z) / LIGHT_CLUSTER_SIZE);
+    *x1 = (int)((light->x + light->range - grid_origin_x) / LIGHT_CLUSTER_SIZE);
+    *z1 = (int)((light->z + light->range - grid_origin_z) / LIGHT_CLUSTER_SIZE);
+    if (*x0 < 0) *x0 = 0;
+    if (*z0 < 0) *z0 = 0;
+    if (*x1 >= cluster_cols) *x1 = cluster_cols - 1;
+    if (*z1 >= cluster_rows) *z1 = cluster_rows - 1;
+}
+
+void update_light_clusters(float render_distance) {
+    memset(&light_cluster_stats, 0, sizeof(light_cluster_stats));
+    if (!clustered_lighting_ready || !clustered_lighting_enabled) return;
+
+    int cluster_total = cluster_cols * cluster_rows;
+    memset(cluster_counts, 0, sizeof(int) * (size_t)cluster_total);
+
+    // 1) Descartar luces fuera del frustum o más allá de la distancia de render
+    int visible = 0;
+    for (int i = 0; i < lightCount; i++) {
+        const LightPoint* light = &lightPoints[i];
+        if (!light->active) continue;
+        light_cluster_stats.lights_total++;
+
+        float dx = light->x - player.x;
+        float dz = light->z - player.z;
+        float reach = render_distance + light->range;
+        if (dx * dx + dz * dz > reach * reach) continue;
+        if (!light_in_frustum(light->x, LIGHT_POINT_HEIGHT, light->z, light->range)) continue;
+        visible_lights[visible++] = i;
+    }
+    light_cluster_stats.lights_visible = visible;
+
+    // 2) Contar luces por cluster según la caja de cada esfera en XZ
+    for (int v = 0; v < visible; v++) {
+        int x0, z0, x1, z1;
+        light_cluster_bounds(&lightPoints[visible_lights[v]], &x0, &z0, &x1, &z1);
+        for (int cz = z0; cz <= z1; cz++) {
+            for (int cx = x0; cx <= x1; cx++) cluster_counts[cz * cluster_cols + cx]++;
+        }
+    }
+
+    // 3) Desplazamientos por suma prefija (sin pasar del tamaño de la lista)
+    int offset = 0;
+    for (int c = 0; c < cluster_total; c++) {
+        int n = cluster_counts[c];
+        if (offset + n > LIGHT_CLUSTER_MAX_INDICES) n = LIGHT_CLUSTER_MAX_INDICES - offset;
+        cluster_data[c * 4 + 0] = (float)offset;
+        cluster_data[c * 4 + 1] = 0.0f;
+        cluster_counts[c] = n;
+        offset += n;
+        if (n > 0) light_cluster_stats.clusters_lit++;
+        if (n > light_cluster_stats.max_per_cluster) light_cluster_stats.max_per_cluster = n;
+    }
+    light_cluster_stats.indices = offset;
+
+    // 4) Rellenar la lista de índices
+    for (int v = 0; v < visible; v++) {
+        int x0, z0, x1, z1;
+        light_cluster_bounds(&lightPoints[visible_lights[v]], &x0, &z0, &x1, &z1);
+        for (int cz = z0; cz <= z1; cz++) {
+            for (int cx = x0; cx <= x1; cx++) {
+                float* cluster = cluster_data + (cz * cluster_cols + cx) * 4;
+                int c = cz * cluster_cols + cx;
+                if ((int)cluster[1] >= cluster_counts[c]) continue;
+                index_data[(int)cluster[0] + (int)cluster[1]] = (float)visible_lights[v];
+                cluster[1] += 1.0f;
+            }
+        }
+    }
+
+    // Subir solo las filas de índices usadas
+    glBindTexture(GL_TEXTURE_2D, cluster_texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, cluster_cols, cluster_rows, GL_RGBA, GL_FLOAT, cluster_data);
+    if (offset > 0) {
+        int rows = (offset + LIGHT_CLUSTER_INDEX_WIDTH - 1) / LIGHT_CLUSTER_INDEX_WIDTH;
+        glBindTexture(GL_TEXTURE_2D, index_texture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, LIGHT_CLUSTER_INDEX_WIDTH, rows, GL_RED, GL_FLOAT, index_data);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void clustered_lighting_begin() {
+    active = false;
+    if (!clustered_lighting_ready || !clustered_lighting_enabled) return;
+
+    glActiveTexture(GL_TEXTURE0 + UNIT_LIGHTS);
+    glBindTexture(GL_TEXTURE_2D, light_texture);
+    glActiveTexture(GL_TEXTURE0 + UNIT_CLUSTERS);
+    glBindTexture(GL_TEXTURE_2D, cluster_texture);
+    glActiveTexture(GL_TEXTURE0 + UNIT_INDICES);
+    glBindTexture(GL_TEXTURE_2D, index_texture);
+    glActiveTexture(GL_TEXTURE0 + UNIT_VISIBILITY);
+    glBindTexture(GL_TEXTURE_2D, visibility_texture);
+    glActiveTexture(GL_TEXTURE0);
+
+    glUseProgram(programs[0]);
+    active = true;
+}
+
+bool clustered_lighting_bind(bool instanced) {
+    if (!active) return false;
+    glUseProgram(programs[instanced ? 1 : 0]);
+    return true;
+}
+
+void clustered_lighting_set_offset(float x, float z) {
+    if (!active || (x == bound_offset_x && z == bound_offset_z)) return;
+    glUniform2f(offset_location, x, z);
+    bound_offset_x = x;
+    bound_offset_z = z;
+}
+
+void clustered_lighting_end() {
+    if (!active) return;
+    clustered_lighting_set_offset(0.0f, 0.0f);
+    glUseProgram(0);
+
+    glActiveTexture(GL_TEXTURE0 + UNIT_VISIBILITY);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0 + UNIT_INDICES);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0 + UNIT_CLUSTERS);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0 + UNIT_LIGHTS);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    active = false;
+}
+
+void cleanup_clustered_lighting() {
+    for (int i = 0; i < 2; i++) {
+        if (programs[i]) glDeleteProgram(programs[i]);
+        programs[i] = 0;
+    }
+    if (light_texture) glDeleteTextures(1, &light_texture);
+    if (cluster_texture) glDeleteTextures(1, &cluster_texture);
+    if (index_texture) glDeleteTextures(1, &index_texture);
+    if (visibility_texture) glDeleteTextures(1, &visibility_texture);
+    light_texture = 0;
+    cluster_texture = 0;
+    index_texture = 0;
+    visibility_texture = 0;
+    free(cluster_data);
+    free(cluster_counts);
+    free(index_data);
+    free(visible_lights);
+    cluster_data = NULL;
+    cluster_counts = NULL;
+    index_data = NULL;
+    visible_lights = NULL;
+    clustered_lighting_ready = false;
+    active = false;
+}
@@ -0,0 +1,36 @@
+// light_clusters.h - Iluminación por clusters en GLSL para todos los lightPoints[]
+#ifndef LIGHT_CLUSTERS_H
+#define LIGHT_CLUSTERS_H
+
+#include <stdbool.h>
+
+// Rejilla de clusters sobre el plano XZ del mapa
+#define LIGHT_CLUSTER_SIZE 8.0f           // Lado de cada cluster en unidades de mundo
+#define LIGHT_CLUSTER_TABLE_WIDTH 256     // Luces por fila de la textura de luces (2 filas por luz)
+#define LIGHT_CLUSTER_INDEX_WIDTH 1024    // Ancho de la textura de índices
+#define LIGHT_CLUSTER_MAX_INDICES (LIGHT_CLUSTER_INDEX_WIDTH * 8)
+
+// Estadísticas del último frame
+typedef struct {
+    int lights_total;       // Luces activas del mapa
+    int lights_visible;     // Luces que tocan el frustum y la distancia de render
+    int clusters_lit;       // Clusters con al menos una luz
+    int max_per_cluster;    // Luces en el cluster más cargado
+    int indices;            // Entradas totales en la lista de índices
+} LightClusterStats;
+
+extern bool clustered_lighting_ready;
+extern bool clustered_lighting_enabled;
+extern LightClusterStats light_cluster_stats;
+
+// Funciones de iluminación por clusters (requieren un contexto activo)
+bool init_clustered_lighting();
+void refresh_clustered_lights();    // Las luces del mapa cambiaron: subirlas sin recompilar
+void update_light_clusters(float render_distance);
+void clustered_lighting_begin();
+bool clustered_lighting_bind(bool instanced);
+void clustered_lighting_set_offset(float x, float z);   // Traslación de la malla que se dibuja (sin instancing)
+void clustered_lighting_end();
+void cleanup_clustered_lighting();
+
+#endif // LIGHT_CLUSTERS_H
@@ -0,0 +1,161 @@
+// light_visibility.c - Visibilidad 2D de cada luz del mapa (shadowcasting sobre la rejilla)
+#include "light_visibility.h"
+#include "timer.h"
+#include "map.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+bool light_visibility_ready = false;
+double light_visibility_bake_ms = 0.0;
+int light_visibility_count = 0;
+
+static LightVisibility* visibility = NULL;
+
+// Rejilla que tapa las luces: la del mapa (cells NULL) o un bloque lineal x * height + z
+typedef struct {
+    const unsigned char* cells;
+    int width, height;
+} VisibilityGrid;
+
+static bool grid_wall(const VisibilityGrid* grid, int x, int z) {
+    if (!grid->cells) return is_wall(x, z);
+    if (x < 0 || x >= grid->width || z < 0 || z >= grid->height) return true;
+    return (grid->cells[x * grid->height + z] & CELL_WALL) != 0;
+}
+
+// Transformación de cada octante: (columna, fila) -> (dx, dz)
+static const int octants[8][4] = {
+    { 1,  0,  0,  1}, { 0,  1,  1,  0}, { 0, -1,  1,  0}, {-1,  0,  0,  1},
+    {-1,  0,  0, -1}, { 0, -1, -1,  0}, { 0,  1, -1,  0}, { 1,  0,  0, -1}
+};
+
+static void mark_visible(LightVisibility* v, int dx, int dz) {
+    unsigned char* cell = &v->cells[(dz + LIGHT_VISIBILITY_RADIUS) * LIGHT_VISIBILITY_SIZE +
+                                    (dx + LIGHT_VISIBILITY_RADIUS)];
+    if (!*cell) {
+        *cell = 1;
+        v->visible_cells++;
+    }
+}
+
+// Shadowcasting recursivo de un octante: recorre filas desde la luz entre dos
+// pendientes y se divide cada vez que un muro tapa parte del barrido.
+// Los muros alcanzados también se marcan (sus caras reciben luz)
+static void cast_octant(const VisibilityGrid* grid, LightVisibility* v, const int* t, int row, float start, float end) {
+    if (start < end) return;
+    int radius_sq = v->radius * v->radius;
+    float next_start = start;
+
+    for (int j = row; j <= v->radius; j++) {
+        bool blocked = false;
+        for (int i = -j; i <= 0; i++) {
+            // Pendientes de las esquinas de la celda vistas desde el centro de la luz
+            float left = (i - 0.5f) / (-j + 0.5f);
+            float right = (i + 0.5f) / (-j - 0.5f);
+            if (start < right) continue;
+            if (end > left) break;
+
+            int dx = i * t[0] + -j * t[1];
+            int dz = i * t[2] + -j * t[3];
+            if (i * i + j * j <= radius_sq) mark_visible(v, dx, dz);
+
+            bool wall = grid_wall(grid, v->cell_x + dx, v->cell_z + dz);
+            if (blocked) {
+                if (wall) {
+                    next_start = right;
+                } else {
+                    blocked = false;
+                    start = next_start;
+                }
+            } else if (wall && j < v->radius) {
+                blocked = true;
+                cast_octant(grid, v, t, j + 1, start, left);
+                next_start = right;
+            }
+        }
+        if (blocked) break;
+    }
+}
+
+static void bake_light(const VisibilityGrid* grid, const LightPoint* light, LightVisibility* v) {
+    memset(v, 0, sizeof(*v));
+    if (!light->active) return;
+
+    v->cell_x = (int)floorf(light->x + 0.5f);
+    v->cell_z = (int)floorf(light->z + 0.5f);
+    v->radius = (int)ceilf(light->range);
+    if (v->radius > LIGHT_VISIBILITY_RADIUS) v->radius = LIGHT_VISIBILITY_RADIUS;
+
+    mark_visible(v, 0, 0);
+    for (int o = 0; o < 8; o++) cast_octant(grid, v, octants[o], 1, 1.0f, 0.0f);
+}
+
+void bake_light_visibility() {
+    cleanup_light_visibility();
+    double start = timer_seconds();
+    int count = lightCount;
+    long total_cells = 0;
+
+    visibility = (LightVisibility*)malloc(sizeof(LightVisibility) * (size_t)(count > 0 ? count : 1));
+    if (!visibility) {
+        printf("Error: Sin memoria para la visibilidad de las luces\n");
+        return;
+    }
+
+    VisibilityGrid grid = {NULL, maze_width, maze_height};
+    for (int i = 0; i < count; i++) {
+        bake_light(&grid, &lightPoints[i], &visibility[i]);
+        total_cells += visibility[i].visible_cells;
+    }
+
+    light_visibility_count = count;
+    light_visibility_ready = true;
+    light_visibility_bake_ms = (timer_seconds() - start) * 1000.0;
+    if (map_verbose) {
+        printf("Visibilidad de luces: %d luces, %ld celdas iluminadas en %.2f ms\n",
+               count, total_cells, light_visibility_bake_ms);
+    }
+}
+
+void compute_light_visibility(const LightPoint* light, const unsigned char* cells, int width, int height,
+                              LightVisibility* out) {
+    VisibilityGrid grid = {cells, width, height};
+    bake_light(&grid, light, out);
+}
+
+void set_light_visibility(const LightVisibility* windows, int count) {
+    cleanup_light_visibility();
+    visibility = (LightVisibility*)malloc(sizeof(LightVisibility) * (size_t)(count > 0 ? count : 1));
+    if (!visibility) {
+        printf("Error: Sin memoria para la visibilidad de las luces\n");
+        return;
+    }
+    if (count > 0) memcpy(visibility, windows, sizeof(LightVisibility) * (size_t)count);
+    light_visibility_count = count;
+    light_visibility_ready = true;
+}
+
+const LightVisibility* light_visibility_get(int light) {
+    if (!light_visibility_ready || light < 0 || light >= light_visibility_count) return NULL;
+    return &visibility[light];
+}
+
+bool light_visibility_test(int light, float x, float z) {
+    const LightVisibility* v = light_visibility_get(light);
+    if (!v) return true;    // Sin datos la luz no se enmascara
+
+    int dx = (int)floorf(x + 0.5f) - v->cell_x;
+    int dz = (int)floorf(z + 0.5f) - v->cell_z;
+    if (dx < -LIGHT_VISIBILITY_RADIUS || dx > LIGHT_VISIBILITY_RADIUS ||
+        dz < -LIGHT_VISIBILITY_RADIUS || dz > LIGHT_VISIBILITY_RADIUS) return false;
+    return v->cells[(dz + LIGHT_VISIBILITY_RADIUS) * LIGHT_VISIBILITY_SIZE + (dx + LIGHT_VISIBILITY_RADIUS)] != 0;
+}
+
+void cleanup_light_visibility() {
+    free(visibility);
+    visibility = NULL;
+    light_visibility_count = 0;
+    light_visibility_ready = false;
+}
@@ -0,0 +1,36 @@
+// light_visibility.h - Visibilidad 2D de cada luz del mapa (shadowcasting sobre la rejilla)
+#ifndef LIGHT_VISIBILITY_H
+#define LIGHT_VISIBILITY_H
+
+#include <stdbool.h>
+#include "map.h"
+
+// Ventana de celdas alrededor de cada luz (el radio cubre el mayor rango de luz)
+#define LIGHT_VISIBILITY_RADIUS 18
+#define LIGHT_VISIBILITY_SIZE (LIGHT_VISIBILITY_RADIUS * 2 + 1)
+
+// Celdas que ve una luz: la unión de las celdas marcadas forma su polígono de
+// visibilidad sobre la rejilla (ventana centrada en la celda de la luz)
+typedef struct {
+    int cell_x, cell_z;         // Celda de la luz
+    int radius;                 // Rango de la luz redondeado hacia arriba, en celdas
+    int visible_cells;
+    unsigned char cells[LIGHT_VISIBILITY_SIZE * LIGHT_VISIBILITY_SIZE]; // 1 = visible
+} LightVisibility;
+
+extern bool light_visibility_ready;
+extern double light_visibility_bake_ms;
+extern int light_visibility_count;     // Ventanas horneadas (una por lightPoints[])
+
+// Se calcula una vez al generar el mapa y sirve hasta que el mapa cambia
+void bake_light_visibility();
+// Una luz sobre un bloque lineal externo (x * height + z, fuera cuenta como muro).
+// No toca el mapa ni el estado global: sirve desde un hilo de fondo
+void compute_light_visibility(const LightPoint* light, const unsigned char* cells, int width, int height,
+                              LightVisibility* out);
+void set_light_visibility(const LightVisibility* windows, int count);  // Ventanas ya calculadas, en orden de lightPoints[]
+const LightVisibility* light_visibility_get(int light);
+bool light_visibility_test(int light, float x, float z);   // ¿Ilumina la luz la celda de (x, z)?
+void cleanup_light_visibility();
+
+#endif // LIGHT_VISIBILITY_H
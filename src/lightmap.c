@@ -0,0 +1,390 @@
+// lightmap.c - Lightmaps estáticos horneados para las luces del mapa
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include "timer.h"
+#include "lightmap.h"
+#include "gl_ext.h"
+#include "gl_state.h"
+#include "map.h"
+#include "render.h"
+#include "thread_pool.h"
+#include "light_visibility.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+bool lightmaps_ready = false;
+double lightmap_bake_ms = 0.0;
+
+// Cara de muro registrada por la malla (un tramo fundido de altura completa)
+typedef struct {
+    int dx, dz;             // Normal de la cara
+    float fixed;            // Coordenada constante (z para caras Z, x para caras X)
+    float from, to;         // Extremos del tramo a lo largo de la cara
+    int atlas_x, atlas_y;   // Esquina del rectángulo (incluye el borde)
+    int width;              // Texels a lo largo del tramo (sin borde)
+} LightmapFace;
+
+static LightmapFace* faces = NULL;
+static int face_count = 0;
+static int face_capacity = 0;
+static int faces_dropped = 0;
+static bool faces_enabled = false;  // El mapa cabe en el límite de horneado
+
+// Estanterías del atlas: todas las caras tienen la misma altura
+static int shelf_x = 0;
+static int shelf_y = 0;
+
+// Texels del atlas y de los planos de suelo y techo (RGB)
+static unsigned char* atlas_pixels = NULL;
+static int atlas_height = 0;
+static unsigned char* floor_pixels = NULL;
+static unsigned char* ceiling_pixels = NULL;
+static int plane_width = 0;
+static int plane_height = 0;
+
+static GLuint atlas_texture = 0;
+static GLuint floor_texture = 0;
+static GLuint ceiling_texture = 0;
+static bool active = false;
+
+// Luces activas copiadas antes de repartir el trabajo entre hilos
+typedef struct {
+    int index;          // En lightPoints[] (para su visibilidad precalculada)
+    float x, y, z;
+    float range;
+    float color[3];
+} BakeLight;
+
+static BakeLight* bake_lights = NULL;
+static int bake_light_count = 0;
+
+#define FACE_TEXELS_HIGH (MAZE_LEVELS * LIGHTMAP_TEXELS_PER_UNIT)
+#define FACE_RECT_HIGH (FACE_TEXELS_HIGH + 2 * LIGHTMAP_PADDING)
+#define DARK_BLOCK 2    // Texels negros reservados en la esquina del atlas
+
+static int next_pow2(int value) {
+    int result = 1;
+    while (result < value) result <<= 1;
+    return result;
+}
+
+void lightmap_reset_faces() {
+    face_count = 0;
+    faces_dropped = 0;
+    shelf_x = DARK_BLOCK;
+    shelf_y = 0;
+    faces_enabled = maze_width * maze_height <= LIGHTMAP_MAX_MAP_CELLS;
+}
+
+void lightmap_dark_uv(float* uv) {
+    // Centro del bloque negro: el filtrado no alcanza ningún texel iluminado
+    uv[0] = uv[2] = DARK_BLOCK * 0.5f;
+    uv[1] = uv[3] = DARK_BLOCK * 0.5f;
+}
+
+// Alguna luz activa alcanza la cara por su lado abierto
+static bool face_reaches_light(int dx, int dz, float fixed, float from, float to) {
+    for (int i = 0; i < lightCount; i++) {
+        const LightPoint* light = &lightPoints[i];
+        if (!light->active) continue;
+
+        float along = dz != 0 ? light->x : light->z;
+        float across = dz != 0 ? light->z : light->x;
+        float side = (across - fixed) * (float)(dz != 0 ? dz : dx);
+        if (side <= 0.0f || side >= light->range) continue;
+
+        float gap = 0.0f;
+        if (along < from) gap = from - along;
+        else if (along > to) gap = along - to;
+        if (gap * gap + side * side < light->range * light->range) return true;
+    }
+    return false;
+}
+
+void lightmap_add_wall_face(int dx, int dz, float fixed, float from, float to, float* uv) {
+    // Las caras que ninguna luz alcanza comparten el bloque negro
+    if (!faces_enabled || !face_reaches_light(dx, dz, fixed, from, to)) {
+        lightmap_dark_uv(uv);
+        return;
+    }
+
+    int width = (int)((to - from) * LIGHTMAP_TEXELS_PER_UNIT + 0.5f);
+    int rect_width = width + 2 * LIGHTMAP_PADDING;
+    if (shelf_x + rect_width > LIGHTMAP_ATLAS_WIDTH) {
+        shelf_x = 0;
+        shelf_y += FACE_RECT_HIGH;
+    }
+    if (shelf_y + FACE_RECT_HIGH > LIGHTMAP_ATLAS_MAX_HEIGHT) {
+        faces_dropped++;
+        lightmap_dark_uv(uv);
+        return;
+    }
+
+    if (face_count >= face_capacity) {
+        int new_capacity = face_capacity > 0 ? face_capacity * 2 : 256;
+        LightmapFace* grown = (LightmapFace*)realloc(faces, sizeof(LightmapFace) * (size_t)new_capacity);
+        if (!grown) {
+            faces_dropped++;
+            lightmap_dark_uv(uv);
+            return;
+        }
+        faces = grown;
+        face_capacity = new_capacity;
+    }
+
+    LightmapFace* face = &faces[face_count++];
+    face->dx = dx;
+    face->dz = dz;
+    face->fixed = fixed;
+    face->from = from;
+    face->to = to;
+    face->atlas_x = shelf_x;
+    face->atlas_y = shelf_y;
+    face->width = width;
+    shelf_x += rect_width;
+
+    // Coordenadas en texels: la matriz de textura las normaliza al dibujar
+    uv[0] = (float)(face->atlas_x + LIGHTMAP_PADDING);
+    uv[1] = (float)(face->atlas_y + LIGHTMAP_PADDING);
+    uv[2] = uv[0] + (float)width;
+    uv[3] = uv[1] + (float)FACE_TEXELS_HIGH;
+}
+
+// Luz directa de todas las luces activas sobre un punto, ya multiplicada por el difuso
+static void light_texel(float px, float py, float pz, float nx, float ny, float nz,
+                        const GLfloat* diffuse, unsigned char* out) {
+    float rgb[3] = {0.0f, 0.0f, 0.0f};
+
+    for (int i = 0; i < bake_light_count; i++) {
+        const BakeLight* light = &bake_lights[i];
+        float lx = light->x - px;
+        float ly = light->y - py;
+        float lz = light->z - pz;
+        float d_sq = lx * lx + ly * ly + lz * lz;
+        if (d_sq >= light->range * light->range) continue;
+
+        float d = sqrtf(d_sq);
+        float n_dot_l = (nx * lx + ny * ly + nz * lz) / d;
+        if (n_dot_l <= 0.0f) continue;
+        if (!light_visibility_test(light->index, px, pz)) continue;  // Tapada por muros
+
+        // Misma caída que el shader por clusters
+        float falloff = 1.0f - d / light->range;
+        float k = n_dot_l * falloff * falloff;
+        for (int c = 0; c < 3; c++) rgb[c] += diffuse[c] * light->color[c] * k;
+    }
+
+    for (int c = 0; c < 3; c++) {
+        float v = rgb[c] > 1.0f ? 1.0f : rgb[c];
+        out[c] = (unsigned char)(v * 255.0f + 0.5f);
+    }
+}
+
+static unsigned char* atlas_texel(int x, int y) {
+    return atlas_pixels + ((size_t)y * LIGHTMAP_ATLAS_WIDTH + x) * 3;
+}
+
+static void bake_face_task(void* data, int index) {
+    (void)data;
+    const LightmapFace* face = &faces[index];
+    int x0 = face->atlas_x + LIGHTMAP_PADDING;
+    int y0 = face->atlas_y + LIGHTMAP_PADDING;
+
+    // Punto de muestreo apenas separado de la cara, dentro de la celda abierta
+    const float offset = 0.01f;
+    for (int j = 0; j < FACE_TEXELS_HIGH; j++) {
+        float y = (j + 0.5f) / LIGHTMAP_TEXELS_PER_UNIT;
+        for (int i = 0; i < face->width; i++) {
+            float along = face->from + (i + 0.5f) / LIGHTMAP_TEXELS_PER_UNIT;
+            float px, pz;
+            if (face->dz != 0) {
+                px = along;
+                pz = face->fixed + face->dz * offset;
+            } else {
+                px = face->fixed + face->dx * offset;
+                pz = along;
+            }
+            light_texel(px, y, pz, (float)face->dx, 0.0f, (float)face->dz,
+                        material_wall.diffuse, atlas_texel(x0 + i, y0 + j));
+        }
+    }
+
+    // Borde: repetir los texels exteriores para que el bilineal no mezcle caras vecinas
+    for (int j = 0; j < FACE_TEXELS_HIGH; j++) {
+        memcpy(atlas_texel(x0 - 1, y0 + j), atlas_texel(x0, y0 + j), 3);
+        memcpy(atlas_texel(x0 + face->width, y0 + j), atlas_texel(x0 + face->width - 1, y0 + j), 3);
+    }
+    int rect_width = face->width + 2 * LIGHTMAP_PADDING;
+    memcpy(atlas_texel(face->atlas_x, y0 - 1), atlas_texel(face->atlas_x, y0), (size_t)rect_width * 3);
+    memcpy(atlas_texel(face->atlas_x, y0 + FACE_TEXELS_HIGH),
+           atlas_texel(face->atlas_x, y0 + FACE_TEXELS_HIGH - 1), (size_t)rect_width * 3);
+}
+
+// Una fila de celdas del suelo (índices [0, alto)) o del techo (índices [alto, 2 * alto))
+static void bake_plane_task(void* data, int index) {
+    (void)data;
+    bool ceiling = index >= maze_height;
+    int z = ceiling ? index - maze_height : index;
+    unsigned char* pixels = ceiling ? ceiling_pixels : floor_pixels;
+    const GLMaterial* material = ceiling ? &material_ceiling : &material_floor;
+    float y = ceiling ? CEILING_HEIGHT : 0.0f;
+    float ny = ceiling ? -1.0f : 1.0f;
+
+    // Un texel por celda, desplazado uno por el borde negro
+    for (int x = 0; x < maze_width; x++) {
+        unsigned char* out = pixels + ((size_t)(z + 1) * plane_width + (x + 1)) * 3;
+        light_texel((float)x, y, (float)z, 0.0f, ny, 0.0f, material->diffuse, out);
+    }
+}
+
+static GLuint upload_lightmap(const unsigned char* pixels, int width, int height) {
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return texture;
+}
+
+static void free_bake_buffers() {
+    free(atlas_pixels);
+    free(floor_pixels);
+    free(ceiling_pixels);
+    free(bake_lights);
+    atlas_pixels = NULL;
+    floor_pixels = NULL;
+    ceiling_pixels = NULL;
+    bake_lights = NULL;
+    bake_light_count = 0;
+}
+
+void bake_lightmaps() {
+    // Las caras ya están registradas: solo se liberan las texturas anteriores
+    lightmaps_ready = false;
+    if (atlas_texture) glDeleteTextures(1, &atlas_texture);
+    if (floor_texture) glDeleteTextures(1, &floor_texture);
+    if (ceiling_texture) glDeleteTextures(1, &ceiling_texture);
+    atlas_texture = floor_texture = ceiling_texture = 0;
+    if (!faces_enabled) {
+        printf("Lightmaps omitidos: mapa de %dx%d celdas (límite %d)\n", maze_width, maze_height, LIGHTMAP_MAX_MAP_CELLS);
+        return;
+    }
+    double start = timer_seconds();
+
+    atlas_height = next_pow2(shelf_y + FACE_RECT_HIGH);
+    plane_width = next_pow2(maze_width + 2);
+    plane_height = next_pow2(maze_height + 2);
+    atlas_pixels = (unsigned char*)calloc((size_t)LIGHTMAP_ATLAS_WIDTH * atlas_height, 3);
+    floor_pixels = (unsigned char*)calloc((size_t)plane_width * plane_height, 3);
+    ceiling_pixels = (unsigned char*)calloc((size_t)plane_width * plane_height, 3);
+    bake_lights = (BakeLight*)malloc(sizeof(BakeLight) * (size_t)(lightCount > 0 ? lightCount : 1));
+    if (!atlas_pixels || !floor_pixels || !ceiling_pixels || !bake_lights) {
+        printf("Error: Sin memoria para los lightmaps\n");
+        free_bake_buffers();
+        return;
+    }
+
+    for (int i = 0; i < lightCount; i++) {
+        const LightPoint* light = &lightPoints[i];
+        if (!light->active) continue;
+        BakeLight* baked = &bake_lights[bake_light_count++];
+        baked->index = i;
+        baked->x = light->x;
+        baked->y = LIGHT_POINT_HEIGHT;
+        baked->z = light->z;
+        baked->range = light->range;
+        baked->color[0] = LIGHT_POINT_RED * light->intensity;
+        baked->color[1] = LIGHT_POINT_GREEN * light->intensity;
+        baked->color[2] = LIGHT_POINT_BLUE * light->intensity;
+    }
+
+    // Caras y filas son independientes: repartirlas entre los hilos
+    thread_pool_run(bake_face_task, NULL, face_count);
+    thread_pool_run(bake_plane_task, NULL, maze_height * 2);
+
+    atlas_texture = upload_lightmap(atlas_pixels, LIGHTMAP_ATLAS_WIDTH, atlas_height);
+    floor_texture = upload_lightmap(floor_pixels, plane_width, plane_height);
+    ceiling_texture = upload_lightmap(ceiling_pixels, plane_width, plane_height);
+    int lights = bake_light_count;
+    free_bake_buffers();
+
+    lightmaps_ready = true;
+    lightmap_bake_ms = (timer_seconds() - start) * 1000.0;
+
+    printf("Lightmaps horneados: %d luces, %d caras de muro en atlas %dx%d, suelo y techo %dx%d en %.1f ms (%d hilos)\n",
+           lights, face_count, LIGHTMAP_ATLAS_WIDTH, atlas_height, plane_width, plane_height,
+           lightmap_bake_ms, thread_pool_size());
+    if (faces_dropped > 0) {
+        printf("Aviso: %d caras sin espacio en el atlas quedan sin luz horneada\n", faces_dropped);
+    }
+}
+
+void lightmap_begin() {
+    active = lightmaps_ready;
+    if (!active) return;
+
+    // La luz horneada se suma a la iluminación fija antes de la niebla
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_ADD);
+}
+
+void lightmap_bind(LightmapSurface surface) {
+    if (!active) return;
+    gl_state_enable(GL_TEXTURE_2D, true);
+
+    if (surface == LIGHTMAP_SURFACE_WALLS) {
+        glBindTexture(GL_TEXTURE_2D, atlas_texture);
+        glMatrixMode(GL_TEXTURE);
+        glLoadIdentity();
+        glScalef(1.0f / LIGHTMAP_ATLAS_WIDTH, 1.0f / atlas_height, 1.0f);
+        glMatrixMode(GL_MODELVIEW);
+        return;
+    }
+
+    // Suelo y techo: un texel por celda generado desde la posición en XZ
+    glBindTexture(GL_TEXTURE_2D, surface == LIGHTMAP_SURFACE_FLOOR ? floor_texture : ceiling_texture);
+    GLfloat plane_s[] = {1.0f / plane_width, 0.0f, 0.0f, 1.5f / plane_width};
+    GLfloat plane_t[] = {0.0f, 0.0f, 1.0f / plane_height, 1.5f / plane_height};
+    glTexGeni(GL_S, GL_TEXTURE_GEN_MODE, GL_OBJECT_LINEAR);
+    glTexGeni(GL_T, GL_TEXTURE_GEN_MODE, GL_OBJECT_LINEAR);
+    glTexGenfv(GL_S, GL_OBJECT_PLANE, plane_s);
+    glTexGenfv(GL_T, GL_OBJECT_PLANE, plane_t);
+    glEnable(GL_TEXTURE_GEN_S);
+    glEnable(GL_TEXTURE_GEN_T);
+}
+
+void lightmap_unbind() {
+    if (!active) return;
+    glDisable(GL_TEXTURE_GEN_S);
+    glDisable(GL_TEXTURE_GEN_T);
+    glMatrixMode(GL_TEXTURE);
+    glLoadIdentity();
+    glMatrixMode(GL_MODELVIEW);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    gl_state_enable(GL_TEXTURE_2D, false);
+}
+
+void lightmap_end() {
+    if (!active) return;
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    active = false;
+}
+
+void cleanup_lightmaps() {
+    if (atlas_texture) glDeleteTextures(1, &atlas_texture);
+    if (floor_texture) glDeleteTextures(1, &floor_texture);
+    if (ceiling_texture) glDeleteTextures(1, &ceiling_texture);
+    atlas_texture = floor_texture = ceiling_texture = 0;
+    free(faces);
+    faces = NULL;
+    face_count = 0;
+    face_capacity = 0;
+    free_bake_buffers();
+    lightmaps_ready = false;
+    active = false;
+}
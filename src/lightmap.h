@@ -0,0 +1,39 @@
+// lightmap.h - Lightmaps estáticos horneados para las luces del mapa
+#ifndef LIGHTMAP_H
+#define LIGHTMAP_H
+
+#include <stdbool.h>
+
+// Resolución y tamaño del atlas de caras de muro
+#define LIGHTMAP_TEXELS_PER_UNIT 2      // Texels por unidad de mundo en los muros
+#define LIGHTMAP_ATLAS_WIDTH 1024
+#define LIGHTMAP_ATLAS_MAX_HEIGHT 4096
+#define LIGHTMAP_PADDING 1              // Borde copiado alrededor de cada cara (filtrado bilineal)
+#define LIGHTMAP_MAX_MAP_CELLS (256 * 256)  // Mapas mayores se iluminan solo por clusters
+
+// Superficies que muestrean los lightmaps
+typedef enum {
+    LIGHTMAP_SURFACE_FLOOR,     // Suelo y variaciones del terreno (texgen en XZ)
+    LIGHTMAP_SURFACE_CEILING,   // Techo (texgen en XZ)
+    LIGHTMAP_SURFACE_WALLS      // Caras de muro con coordenadas del atlas en la malla
+} LightmapSurface;
+
+extern bool lightmaps_ready;
+extern double lightmap_bake_ms;
+
+// Registro de caras de muro (durante bake_wall_meshes)
+void lightmap_reset_faces();
+void lightmap_add_wall_face(int dx, int dz, float fixed, float from, float to, float* uv);
+void lightmap_dark_uv(float* uv);
+
+// Horneado tras generar el mapa y la malla de muros (requiere un contexto activo)
+void bake_lightmaps();
+
+// Pasada opaca: begin/end la activan, bind/unbind eligen la superficie
+void lightmap_begin();
+void lightmap_bind(LightmapSurface surface);
+void lightmap_unbind();
+void lightmap_end();
+void cleanup_lightmaps();
+
+#endif // LIGHTMAP_H
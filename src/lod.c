@@ -0,0 +1,82 @@
+// lod.c - Niveles de detalle por distancia con histéresis
+#include "lod.h"
+#include "map.h"
+#include <math.h>
+#include <stdlib.h>
+
+float lod_mid_distance = 0.0f;
+float lod_far_distance = 0.0f;
+LodStats lod_stats = {0};
+
+// Nivel anterior de cada celda (la histéresis necesita recordarlo), con el tamaño del mapa
+static unsigned char* cell_tiers = NULL;
+static int tiers_width = 0;
+static int tiers_height = 0;
+
+// Niebla con la que se calcularon los umbrales
+static GLFog lod_fog = {0};
+static bool lod_fog_valid = false;
+
+// Distancia a la que la niebla deja pasar solo esta fracción del color de la superficie
+static float fog_distance_for_visibility(const GLFog* fog, float visibility) {
+    switch (fog->mode) {
+        case GL_LINEAR:
+            return fog->end - visibility * (fog->end - fog->start);
+        case GL_EXP:
+            return -logf(visibility) / fog->density;
+        case GL_EXP2:
+        default:
+            return sqrtf(-logf(visibility)) / fog->density;
+    }
+}
+
+void lod_begin_frame(const GLFog* fog) {
+    lod_stats.near_count = 0;
+    lod_stats.mid_count = 0;
+    lod_stats.far_count = 0;
+
+    // Recalcular solo si la niebla cambia
+    if (lod_fog_valid && fog->mode == lod_fog.mode && fog->density == lod_fog.density &&
+        fog->start == lod_fog.start && fog->end == lod_fog.end) {
+        return;
+    }
+    lod_fog = *fog;
+    lod_fog_valid = true;
+    lod_mid_distance = fog_distance_for_visibility(fog, LOD_MID_FOG_VISIBILITY);
+    lod_far_distance = fog_distance_for_visibility(fog, LOD_FAR_FOG_VISIBILITY);
+}
+
+int lod_next_tier(int tier, float distance) {
+    float thresholds[3] = {0.0f, lod_mid_distance, lod_far_distance};
+
+    // Cambiar de nivel solo al cruzar el umbral más el margen en cualquier sentido
+    while (tier < LOD_TIER_FAR && distance > thresholds[tier + 1] + LOD_HYSTERESIS) tier++;
+    while (tier > LOD_TIER_NEAR && distance < thresholds[tier] - LOD_HYSTERESIS) tier--;
+
+    if (tier == LOD_TIER_NEAR) lod_stats.near_count++;
+    else if (tier == LOD_TIER_MID) lod_stats.mid_count++;
+    else lod_stats.far_count++;
+    return tier;
+}
+
+int lod_cell_tier(int x, int z, float distance_sq) {
+    if (!cell_tiers || tiers_width != maze_width || tiers_height != maze_height) {
+        // Primer uso con este mapa: todas las celdas empiezan en el nivel cercano
+        free(cell_tiers);
+        cell_tiers = (unsigned char*)calloc((size_t)maze_width * maze_height, 1);
+        tiers_width = cell_tiers ? maze_width : 0;
+        tiers_height = cell_tiers ? maze_height : 0;
+        if (!cell_tiers) return lod_next_tier(LOD_TIER_NEAR, sqrtf(distance_sq));
+    }
+    unsigned char* previous = &cell_tiers[x * maze_height + z];
+    int tier = lod_next_tier(*previous, sqrtf(distance_sq));
+    *previous = (unsigned char)tier;
+    return tier;
+}
+
+void cleanup_lod() {
+    free(cell_tiers);
+    cell_tiers = NULL;
+    tiers_width = 0;
+    tiers_height = 0;
+}
@@ -0,0 +1,34 @@
+// lod.h - Niveles de detalle por distancia con histéresis
+#ifndef LOD_H
+#define LOD_H
+
+#include "gl_state.h"
+
+// Niveles de detalle (de más a menos detalle)
+#define LOD_TIER_NEAR 0     // Detalle completo
+#define LOD_TIER_MID 1      // Muros como un solo bloque fusionado
+#define LOD_TIER_FAR 2      // Sin decoración (la niebla ya la oculta)
+
+// Fracción del color de la superficie que deja pasar la niebla en cada umbral
+#define LOD_MID_FOG_VISIBILITY 0.25f
+#define LOD_FAR_FOG_VISIBILITY (4.0f / 255.0f)
+#define LOD_HYSTERESIS 1.0f    // Margen (unidades) a cada lado del umbral para evitar saltos
+
+// Celdas y chunks asignados a cada nivel en el frame actual
+typedef struct {
+    int near_count;
+    int mid_count;
+    int far_count;
+} LodStats;
+
+extern float lod_mid_distance;
+extern float lod_far_distance;
+extern LodStats lod_stats;
+
+// Funciones de LOD
+void lod_begin_frame(const GLFog* fog);   // Desde setup_fog(): umbrales según la niebla activa
+int lod_next_tier(int tier, float distance);
+int lod_cell_tier(int x, int z, float distance_sq);
+void cleanup_lod();
+
+#endif // LOD_H
@@ -7,6 +7,7 @@
 #include <stdbool.h>
 #include <math.h>
 #include <time.h>
+#include <string.h>
 
 // Incluir módulos del sistema
 #include "player.h"
@@ -15,12 +16,80 @@
 #include "map.h"
 #include "events.h"
 #include "enemy.h"
+#include "particles.h"
+#include "gl_ext.h"
+#include "wall_mesh.h"
+#include "benchmark.h"
+#include "headless.h"
+#include "profiler.h"
+#include "timer.h"
+#include "ui_batch.h"
+#include "thread_pool.h"
+#include "occlusion.h"
+#include "gl_state.h"
+#include "instancing.h"
+#include "light_clusters.h"
+#include "lightmap.h"
+#include "pvs.h"
+#include "world_stream.h"
 
 // Variables globales
 GLFWwindow* window;
 int windowWidth = 1920;
 int windowHeight = 1080;
 
+// Posición del jugador al inicio del último tick (para interpolar el render)
+static float previous_player_x = 0.0f;
+static float previous_player_y = 0.0f;
+static float previous_player_z = 0.0f;
+
+// Un tick de simulación: toda la lógica del juego avanza a paso fijo
+static void simulation_tick() {
+    previous_player_x = player.x;
+    previous_player_y = player.y;
+    previous_player_z = player.z;
+    
+    profiler_begin(PROFILE_UPDATE_PLAYER);
+    update_player();
+    profiler_end(PROFILE_UPDATE_PLAYER);
+    benchmark_record_pose();
+    
+    profiler_begin(PROFILE_UPDATE_ENEMY);
+    update_enemy();
+    profiler_end(PROFILE_UPDATE_ENEMY);
+    update_particles();
+    
+    profiler_begin(PROFILE_PROCESS_EVENTS);
+    process_events();
+    profiler_end(PROFILE_PROCESS_EVENTS);
+    simulation_ticks++;
+}
+
+// Renderizar interpolando entre los dos últimos ticks: el jugador y el enemigo aquí,
+// las partículas y las animaciones con render_alpha
+static void render_interpolated(float alpha) {
+    float current_x = player.x;
+    float current_y = player.y;
+    float current_z = player.z;
+    float enemy_x = enemy.x;
+    float enemy_z = enemy.z;
+    
+    player.x = previous_player_x + (current_x - previous_player_x) * alpha;
+    player.y = previous_player_y + (current_y - previous_player_y) * alpha;
+    player.z = previous_player_z + (current_z - previous_player_z) * alpha;
+    enemy.x = enemy.previous_x + (enemy_x - enemy.previous_x) * alpha;
+    enemy.z = enemy.previous_z + (enemy_z - enemy.previous_z) * alpha;
+    render_alpha = alpha;
+    render_world();
+    render_alpha = 1.0f;
+    
+    player.x = current_x;
+    player.y = current_y;
+    player.z = current_z;
+    enemy.x = enemy_x;
+    enemy.z = enemy_z;
+}
+
 // Función para configurar OpenGL 3D
 void setup_opengl() {
     // Configurar OpenGL para renderizado 3D
@@ -36,12 +105,12 @@ void setup_opengl() {
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // Fondo negro
     
     // Configurar depth testing correctamente
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
-    glDepthMask(GL_TRUE);
+    gl_state_enable(GL_DEPTH_TEST, true);
+    gl_state_depth_func(GL_LESS);
+    gl_state_depth_mask(GL_TRUE);
     
     // Configurar culling para mejor rendimiento
-    glEnable(GL_CULL_FACE);
+    gl_state_enable(GL_CULL_FACE, true);
     glCullFace(GL_BACK);
     glFrontFace(GL_CCW);
 }
@@ -60,113 +129,261 @@ void window_size_callback(GLFWwindow* window, int width, int height) {
     glMatrixMode(GL_MODELVIEW);
 }
 
-int main() {
-    // Inicializar GLFW
-    if (!glfwInit()) {
-        printf("Error al inicializar GLFW\n");
-        return -1;
+int main(int argc, char** argv) {
+    // Modo benchmark: mapa con semilla fija y medición de frames
+    bool benchmark_mode = false;
+    bool instanced_mode = false;
+    bool headless_mode = false;
+    bool endless_mode = false;
+    const char* benchmark_json = BENCHMARK_JSON_FILE;
+    const char* benchmark_path = NULL;
+    const char* record_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--benchmark") == 0) {
+            benchmark_mode = true;
+        } else if (strcmp(argv[i], "--headless") == 0) {
+            // Benchmark en un framebuffer sin ventana (EGL surfaceless en Linux)
+            headless_mode = true;
+            benchmark_mode = true;
+        } else if (strcmp(argv[i], "--benchmark-json") == 0 && i + 1 < argc) {
+            benchmark_json = argv[++i];
+        } else if (strcmp(argv[i], "--benchmark-path") == 0 && i + 1 < argc) {
+            benchmark_path = argv[++i];
+        } else if (strcmp(argv[i], "--record-path") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--instanced") == 0) {
+            instanced_mode = true;
+        } else if (strcmp(argv[i], "--fixed-lighting") == 0) {
+            clustered_lighting_enabled = false;
+        } else if (strcmp(argv[i], "--tiled-map") == 0) {
+            // Rejilla del mapa en bloques de 8x8 celdas
+            set_map_layout(MAP_LAYOUT_TILED);
+        } else if (strcmp(argv[i], "--endless") == 0) {
+            // Mundo infinito por chunks en lugar de un mapa fijo con salida
+            endless_mode = true;
+        } else if (strcmp(argv[i], "--map-size") == 0 && i + 1 < argc) {
+            // Lado del mapa (N) o ancho y alto (WxH) en celdas
+            int map_width = 0, map_height = 0;
+            int parsed = sscanf(argv[++i], "%dx%d", &map_width, &map_height);
+            if (parsed == 1) map_height = map_width;
+            if (parsed < 1 || !set_map_size(map_width, map_height)) {
+                return -1;
+            }
+        }
     }
     
-    // Crear ventana en pantalla completa
-    GLFWmonitor* monitor = glfwGetPrimaryMonitor();
-    const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-    
-    window = glfwCreateWindow(mode->width, mode->height, "Deeper - Laberinto 3D", monitor, NULL);
-    if (!window) {
-        printf("No se pudo crear la ventana\n");
-        glfwTerminate();
-        return -1;
+    // El benchmark necesita un mapa fijo; el mundo infinito usa la ventana de chunks
+    if (endless_mode && benchmark_mode) {
+        printf("Modo infinito ignorado en el benchmark\n");
+        endless_mode = false;
+    } else if (endless_mode) {
+        set_map_size(WORLD_WINDOW_CELLS, WORLD_WINDOW_CELLS);
     }
     
-    // Actualizar dimensiones para pantalla completa
-    windowWidth = mode->width;
-    windowHeight = mode->height;
-    
-    glfwMakeContextCurrent(window);
-    glfwSetWindowSizeCallback(window, window_size_callback);
+    if (headless_mode) {
+        // Sin ventana: resolución fija del benchmark (ya carga las extensiones)
+        window = NULL;
+        windowWidth = BENCHMARK_WIDTH;
+        windowHeight = BENCHMARK_HEIGHT;
+        if (!init_headless_context(windowWidth, windowHeight)) {
+            cleanup_headless_context();
+            return -1;
+        }
+    } else {
+        // Inicializar GLFW
+        if (!glfwInit()) {
+            printf("Error al inicializar GLFW\n");
+            return -1;
+        }
+        
+        // Crear ventana en pantalla completa
+        GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+        const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+        
+        window = glfwCreateWindow(mode->width, mode->height, "Deeper - Laberinto 3D", monitor, NULL);
+        if (!window) {
+            printf("No se pudo crear la ventana\n");
+            glfwTerminate();
+            return -1;
+        }
+        
+        // Actualizar dimensiones para pantalla completa
+        windowWidth = mode->width;
+        windowHeight = mode->height;
+        
+        glfwMakeContextCurrent(window);
+        glfwSetWindowSizeCallback(window, window_size_callback);
+        init_gl_extensions();
+    }
     
-    // Configurar OpenGL
+    // Configurar OpenGL (la caché de estado parte de un contexto recién creado)
+    init_gl_state();
     setup_opengl();
+    init_ui_batch();
     
     // Inicializar sistemas modulares
+    init_thread_pool(0);
+    init_profiler();
     init_input();
     init_player();
+    if (benchmark_mode) {
+        set_map_seed(BENCHMARK_SEED);
+    }
     init_map();
     init_renderer();
     init_events();
     init_enemy();
     
     // Configurar callbacks de input
-    setup_input_callbacks(window);
+    if (window) setup_input_callbacks(window);
     
     // PRECARGAR MAPA COMPLETO CON PANTALLA DE CARGA
     printf("=== INICIANDO PRECARGA DEL MAPA ===\n");
     
-    // Mostrar pantalla de carga mientras se precarga el mapa
-    while (!is_map_ready()) {
-        // Mostrar pantalla de carga
-        render_map_loading_screen();
-        glfwSwapBuffers(window);
-        glfwPollEvents();
-        
-        // Precargar mapa en el hilo principal
-        preload_map();
+    // El mapa se genera en un hilo de fondo; mientras tanto la pantalla de carga
+    // sigue respondiendo y muestra el progreso real de cada etapa
+    if (endless_mode) {
+        // Los chunks de la ventana inicial se generan aquí; el resto, en el hilo de fondo
+        init_world_stream();
+    } else {
+        start_map_generation();
+        while (window && !is_map_ready()) {
+            render_map_loading_screen();
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+        finish_map_generation();
+    }
+    
+    // Hornear la geometría estática de muros (al recentrar, el mundo infinito solo
+    // sube los chunks que entran, ya horneados en el hilo de fondo)
+    bake_wall_meshes();
+    init_occlusion();
+    
+    // Las luces del mapa son estáticas: hornearlas sobre muros, suelo y techo.
+    // En el mundo infinito cambian con la ventana y solo las aplican los clusters
+    if (!endless_mode) bake_lightmaps();
+    
+    // Luces del mapa en GLSL (sin shaders se mantiene la iluminación fija)
+    init_clustered_lighting();
+    
+    // Instancing a petición si el driver lo soporta; si no, se quedan los chunks
+    if (init_instancing() && instanced_mode) {
+        wall_render_mode = WALL_RENDER_INSTANCED;
     }
     
     printf("=== MAPA PRECARGADO EXITOSAMENTE ===\n");
+    printf("Tiempo de horneado: PVS %.1f ms, lightmaps %.1f ms\n", pvs_bake_ms, lightmap_bake_ms);
     
-    printf("=== MOTOR 3D - BACKROOMS (MODULAR) ===\n");
-    printf("Laberinto 3D generado dinámicamente con UNA SOLA salida\n");
-    printf("Sistema de iluminación dinámica y niebla realista activado\n");
-    printf("Controles:\n");
-    printf("WASD - Mover (adelante/atrás/izquierda/derecha)\n");
-    printf("Flechas - Rotar cámara\n");
-    printf("Mouse - Rotar cámara 3D (click izquierdo para activar)\n");
-    printf("ESPACIO - Saltar\n");
-    printf("SHIFT - Agacharse (próximamente)\n");
-    printf("ESC - Liberar mouse / Salir\n");
-    printf("Posición inicial: (%.1f, %.1f, %.1f)\n", player.x, player.y, player.z);
-    printf("Escala 3D: 200x200x8 - Altura %d unidades (MAPA MASIVO CON ALTURA)\n", MAZE_LEVELS);
-    printf("Luz: Rango %.1f unidades - Niebla: %.1f-%.1f unidades\n", LIGHT_RANGE, FOG_START_DISTANCE, FOG_END_DISTANCE);
-    printf("Carga progresiva: Solo se renderiza lo que está iluminado\n");
-    printf("Sistema modular inicializado\n");
-    
-    // Loop principal
-    while (!glfwWindowShouldClose(window)) {
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (benchmark_mode) {
+        run_render_benchmark(window, benchmark_json, benchmark_path);
+        if (window) glfwSetWindowShouldClose(window, GLFW_TRUE);
+    } else if (record_path) {
+        benchmark_start_recording(record_path);
+    }
+    
+    // Sin ventana solo se ejecuta el benchmark
+    bool running = window != NULL;
+    if (running) {
+        printf("=== MOTOR 3D - BACKROOMS (MODULAR) ===\n");
+        printf("Laberinto 3D generado dinámicamente con UNA SOLA salida\n");
+        printf("Sistema de iluminación dinámica y niebla realista activado\n");
+        printf("Controles:\n");
+        printf("WASD - Mover (adelante/atrás/izquierda/derecha)\n");
+        printf("Flechas - Rotar cámara\n");
+        printf("Mouse - Rotar cámara 3D (click izquierdo para activar)\n");
+        printf("ESPACIO - Saltar\n");
+        printf("SHIFT - Agacharse (próximamente)\n");
+        printf("ESC - Liberar mouse / Salir\n");
+        printf("Posición inicial: (%.1f, %.1f, %.1f)\n", player.x, player.y, player.z);
+        printf("Escala 3D: 200x200x8 - Altura %d unidades (MAPA MASIVO CON ALTURA)\n", MAZE_LEVELS);
+        printf("Luz: Rango %.1f unidades - Niebla: %.1f-%.1f unidades\n", LIGHT_RANGE, FOG_START_DISTANCE, FOG_END_DISTANCE);
+        printf("Carga progresiva: Solo se renderiza lo que está iluminado\n");
+        printf("Sistema modular inicializado\n");
+    }
+    
+    // Loop principal: la simulación avanza en ticks fijos de SIMULATION_TICK_RATE Hz
+    // y el render corre sin límite, interpolando entre los dos últimos ticks
+    const double tick_seconds = 1.0 / SIMULATION_TICK_RATE;
+    double previous_time = timer_seconds();
+    double accumulator = 0.0;
+    previous_player_x = player.x;
+    previous_player_y = player.y;
+    previous_player_z = player.z;
+    
+    while (running && !glfwWindowShouldClose(window)) {
+        double now = timer_seconds();
+        accumulator += now - previous_time;
+        previous_time = now;
         
-        // Actualizar sistemas
-        update_player();
-        update_enemy();
-        process_events();
+        // Tras un parón (p. ej. arrastrar la ventana) se descarta el retraso en lugar de
+        // encadenar ticks que harían cada frame aún más lento
+        if (accumulator > SIMULATION_MAX_TICKS_PER_FRAME * tick_seconds) {
+            accumulator = SIMULATION_MAX_TICKS_PER_FRAME * tick_seconds;
+        }
         
+        while (accumulator >= tick_seconds) {
+            simulation_tick();
+            accumulator -= tick_seconds;
+            
+            // Mundo infinito: recentrar también la posición interpolada del tick anterior
+            float shift_x, shift_z;
+            if (update_world_stream(&shift_x, &shift_z)) {
+                previous_player_x -= shift_x;
+                previous_player_z -= shift_z;
+            }
+            
             // Verificar si el jugador está muerto
             if (is_player_dead()) {
                 printf("¡GAME OVER! El enemigo te ha alcanzado.\n");
+                running = false;
                 break;
             }
             
-            // Verificar si el jugador llegó a la salida
-            if (check_exit_reached(player.x, player.z)) {
+            // Verificar si el jugador llegó a la salida (el mundo infinito no tiene)
+            if (!endless_mode && check_exit_reached(player.x, player.z)) {
                 printf("¡FELICIDADES! Has escapado de los Backrooms.\n");
+                running = false;
                 break;
             }
+        }
+        if (!running) break;
         
-        // Renderizar mundo 3D
-        render_world();
+        // Renderizar mundo 3D en la fracción del tick que ya ha transcurrido
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        render_interpolated((float)(accumulator / tick_seconds));
+        render_profiler_overlay();
         
+        profiler_begin(PROFILE_SWAP_BUFFERS);
         glfwSwapBuffers(window);
+        profiler_end(PROFILE_SWAP_BUFFERS);
         glfwPollEvents();
+        profiler_end_frame();
     }
     
     // Limpiar recursos
     cleanup_player();
+    cleanup_enemy();
     cleanup_input();
+    cleanup_world_stream();
     cleanup_map();
+    cleanup_wall_meshes();
+    cleanup_occlusion();
+    cleanup_instancing();
+    cleanup_clustered_lighting();
+    cleanup_lightmaps();
     cleanup_renderer();
     cleanup_events();
+    cleanup_thread_pool();
+    cleanup_profiler();
+    cleanup_ui_batch();
+    benchmark_stop_recording();
     
-    glfwDestroyWindow(window);
-    glfwTerminate();
+    if (window) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    } else {
+        cleanup_headless_context();
+    }
     return 0;
 }
\ No newline at end of file
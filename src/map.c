@@ -1,8 +1,13 @@
 // map.c - Sistema de mapas para Backrooms 3D
 #include "map.h"
 #include "render.h"
+#include "pvs.h"
+#include "light_visibility.h"
+#include "connectivity.h"
+#include "thread_pool.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <math.h>
 
@@ -12,56 +17,306 @@
 #endif
 
 // Variables globales del mapa
-int maze[MAZE_WIDTH][MAZE_HEIGHT];
+int maze_width = MAP_DEFAULT_SIZE;
+int maze_height = MAP_DEFAULT_SIZE;
+unsigned char* maze_cells = NULL;
+MapLayout map_layout = MAP_LAYOUT_LINEAR;
+int map_tiles_z = 0;
+uint64_t* wall_bits = NULL;
+int wall_bits_stride = 0;
 
 // Estructuras de datos avanzadas
-Room rooms[100];
-Corridor corridors[200];
-Column columns[150];
-LightPoint lightPoints[50];
+Room* rooms = NULL;
+Corridor* corridors = NULL;
+Column* columns = NULL;
+LightPoint* lightPoints = NULL;
 int roomCount = 0;
 int corridorCount = 0;
 int columnCount = 0;
 int lightCount = 0;
+int roomCapacity = 0;
+int corridorCapacity = 0;
+int columnCapacity = 0;
+int lightCapacity = 0;
+
+// Tamaño con el que se reservó la memoria actual
+static int allocated_width = 0;
+static int allocated_height = 0;
+static MapLayout allocated_layout = MAP_LAYOUT_LINEAR;
 
 // Variables de renderizado optimizado
 bool map_preloaded = false;
 bool map_generation_complete = false;
 
+// Semilla de generación
+unsigned int map_seed = 0;
+static bool map_seed_fixed = false;
+bool map_verbose = true;
+
+// Etapa publicada por el hilo generador. Hasta MAP_STAGE_READY el mapa es solo
+// suyo; el store de liberación de READY publica todo lo generado de una vez
+static volatile long map_stage = MAP_STAGE_IDLE;
+
+// Peso de cada etapa en la barra de progreso (medido: el PVS es casi todo el tiempo)
+static const float map_stage_weights[MAP_STAGE_COUNT] = {
+    0.0f,   // IDLE
+    0.01f,  // ROOMS
+    0.01f,  // CORRIDORS
+    0.01f,  // COLUMNS
+    0.01f,  // LIGHTS
+    0.04f,  // CONNECTIVITY
+    0.92f,  // VISIBILITY
+    0.0f    // READY
+};
+
+static const char* map_stage_names[MAP_STAGE_COUNT] = {
+    "En espera",
+    "Salas",
+    "Pasillos",
+    "Columnas",
+    "Luces",
+    "Conectividad",
+    "Visibilidad (PVS)",
+    "Listo"
+};
+
 // Variables globales para tracking de salida
 static int exit_side = -1;
 static int exit_pos = -1;
 
+static void set_map_stage(MapStage stage) {
+    // Un mapa ya publicado sigue listo aunque se regenere la rejilla (benchmark de disposiciones)
+    if (atomic_load_long(&map_stage) == MAP_STAGE_READY) return;
+    atomic_store_long(&map_stage, stage);
+}
+
+bool set_map_size(int width, int height) {
+    if (width < MAP_MIN_SIZE || width > MAP_MAX_SIZE || height < MAP_MIN_SIZE || height > MAP_MAX_SIZE) {
+        printf("Tamaño de mapa %dx%d fuera de rango (%d-%d)\n", width, height, MAP_MIN_SIZE, MAP_MAX_SIZE);
+        return false;
+    }
+    maze_width = width;
+    maze_height = height;
+    return true;
+}
+
+void set_map_layout(MapLayout layout) {
+    map_layout = layout;
+}
+
+// Celdas reservadas en maze_cells: en bloques se redondea a bloques completos
+static size_t maze_storage_cells() {
+    return (size_t)grid_storage_cells(map_layout, maze_width, maze_height);
+}
+
+// Cantidades de la generación, ajustadas para 100x100, escaladas al área del mapa
+static int scale_to_area(int count) {
+    long long scaled = (long long)count * maze_width * maze_height / MAP_REFERENCE_CELLS;
+    return scaled > 0 ? (int)scaled : 1;
+}
+
+// Longitudes que recorren el mapa de lado a lado, escaladas a su lado mayor
+static int scale_to_span(int count) {
+    int span = maze_width > maze_height ? maze_width : maze_height;
+    return count * span / MAP_DEFAULT_SIZE;
+}
+
+static void free_map_storage() {
+    free(maze_cells);
+    free(wall_bits);
+    free(rooms);
+    free(corridors);
+    free(columns);
+    free(lightPoints);
+    maze_cells = NULL;
+    wall_bits = NULL;
+    wall_bits_stride = 0;
+    rooms = NULL;
+    corridors = NULL;
+    columns = NULL;
+    lightPoints = NULL;
+    roomCapacity = corridorCapacity = columnCapacity = lightCapacity = 0;
+    allocated_width = allocated_height = 0;
+}
+
+// Rejilla contigua y arrays de estructuras para el tamaño actual (se reutilizan si no cambia)
+static bool allocate_map_storage() {
+    if (maze_cells && allocated_width == maze_width && allocated_height == maze_height &&
+        allocated_layout == map_layout) return true;
+    free_map_storage();
+
+    roomCapacity = scale_to_area(100);
+    corridorCapacity = scale_to_area(200);
+    columnCapacity = scale_to_area(150);
+    lightCapacity = scale_to_area(50);
+
+    wall_bits_stride = (maze_height + 63) / 64;
+    map_tiles_z = (maze_height + MAP_TILE_SIZE - 1) >> MAP_TILE_SHIFT;
+    maze_cells = (unsigned char*)calloc(maze_storage_cells(), 1);
+    wall_bits = (uint64_t*)calloc((size_t)maze_width * wall_bits_stride, sizeof(uint64_t));
+    rooms = (Room*)malloc(sizeof(Room) * (size_t)roomCapacity);
+    corridors = (Corridor*)malloc(sizeof(Corridor) * (size_t)corridorCapacity);
+    columns = (Column*)malloc(sizeof(Column) * (size_t)columnCapacity);
+    lightPoints = (LightPoint*)malloc(sizeof(LightPoint) * (size_t)lightCapacity);
+    if (!maze_cells || !wall_bits || !rooms || !corridors || !columns || !lightPoints) {
+        free_map_storage();
+        return false;
+    }
+    allocated_width = maze_width;
+    allocated_height = maze_height;
+    allocated_layout = map_layout;
+    return true;
+}
+
+// Bits de la última palabra de cada columna que corresponden a celdas reales
+static uint64_t last_word_mask() {
+    int used = maze_height - (wall_bits_stride - 1) * 64;
+    return used == 64 ? ~(uint64_t)0 : ((uint64_t)1 << used) - 1;
+}
+
+// Plano de bits desde los bytes de la rejilla, 64 celdas de la columna por palabra
+static void rebuild_wall_bits() {
+    uint64_t padding = ~last_word_mask();
+    for (int x = 0; x < maze_width; x++) {
+        uint64_t* words = &wall_bits[x * wall_bits_stride];
+        for (int w = 0; w < wall_bits_stride; w++) {
+            int z0 = w * 64;
+            int z1 = z0 + 64 < maze_height ? z0 + 64 : maze_height;
+            uint64_t bits = w == wall_bits_stride - 1 ? padding : 0;
+            for (int z = z0; z < z1; z++) {
+                bits |= (uint64_t)(maze_flags(x, z) & CELL_WALL) << (z - z0);
+            }
+            words[w] = bits;
+        }
+    }
+}
+
+uint64_t maze_wall_word(int x, int word) {
+    if (x < 0 || x >= maze_width || word < 0 || word >= wall_bits_stride) return ~(uint64_t)0;
+    return wall_bits[x * wall_bits_stride + word];
+}
+
+uint64_t maze_exposed_walls(int x, int word, int dx, int dz) {
+    uint64_t walls = maze_wall_word(x, word);
+    uint64_t neighbours;
+    if (dx != 0) {
+        neighbours = maze_wall_word(x + dx, word);
+    } else if (dz > 0) {
+        // Vecina z + 1: desplazar la columna y traer el bit bajo de la palabra siguiente
+        neighbours = (walls >> 1) | (maze_wall_word(x, word + 1) << 63);
+    } else {
+        neighbours = (walls << 1) | (maze_wall_word(x, word - 1) >> 63);
+    }
+    uint64_t exposed = walls & ~neighbours;
+    return word == wall_bits_stride - 1 ? exposed & last_word_mask() : exposed;
+}
+
+long count_maze_walls() {
+    long count = 0;
+    uint64_t last = last_word_mask();
+    for (int x = 0; x < maze_width; x++) {
+        const uint64_t* words = &wall_bits[x * wall_bits_stride];
+        for (int w = 0; w < wall_bits_stride - 1; w++) count += __builtin_popcountll(words[w]);
+        count += __builtin_popcountll(words[wall_bits_stride - 1] & last);
+    }
+    return count;
+}
+
 void init_map() {
     // Inicializar sistema de mapas
-    srand((unsigned int)time(NULL));
+    if (!map_seed_fixed) {
+        map_seed = (unsigned int)time(NULL);
+    }
+    srand(map_seed);
     map_preloaded = false;
     map_generation_complete = false;
+    atomic_store_long(&map_stage, MAP_STAGE_IDLE);
+    
+    // Rejilla vacía hasta la generación (el enemigo se coloca antes)
+    if (!allocate_map_storage()) {
+        printf("Error: Sin memoria para un mapa de %dx%d celdas\n", maze_width, maze_height);
+        exit(1);
+    }
 }
 
 void preload_map() {
     if (map_preloaded) return;
     
     printf("=== PRECARGANDO MAPA COMPLETO ===\n");
-    printf("Generando mapa de %dx%d celdas...\n", MAZE_WIDTH, MAZE_HEIGHT);
+    printf("Generando mapa de %dx%d celdas (semilla %u)...\n", maze_width, maze_height, map_seed);
     
-    // Generar mapa completo
+    // Generar mapa completo (la semilla se reaplica porque otros módulos usan rand())
+    srand(map_seed);
     generate_map();
     
+    // El laberinto ya no cambia: precalcular la visibilidad entre celdas y chunks
+    // y la de cada luz
+    set_map_stage(MAP_STAGE_VISIBILITY);
+    bake_pvs();
+    bake_light_visibility();
+    
     // Marcar como precargado
     map_preloaded = true;
     map_generation_complete = true;
     
     printf("=== MAPA PRECARGADO COMPLETAMENTE ===\n");
-    printf("Total de celdas: %d\n", MAZE_WIDTH * MAZE_HEIGHT);
+    printf("Total de celdas: %d\n", maze_width * maze_height);
     printf("Salas generadas: %d\n", roomCount);
     printf("Pasillos generados: %d\n", corridorCount);
     printf("Columnas generadas: %d\n", columnCount);
     printf("Puntos de luz: %d\n", lightCount);
+    
+    // Publicar el mapa terminado al resto de hilos
+    set_map_stage(MAP_STAGE_READY);
+}
+
+static void map_generation_task(void* data) {
+    (void)data;
+    preload_map();
+}
+
+void start_map_generation() {
+    if (is_map_ready()) return;
+    
+    // Sin hilo disponible se genera aquí mismo
+    set_map_stage(MAP_STAGE_ROOMS);
+    if (!start_background_task(map_generation_task, NULL)) {
+        preload_map();
+    }
+}
+
+void finish_map_generation() {
+    wait_background_task();
+}
+
+MapStage map_generation_stage() {
+    return (MapStage)atomic_load_long(&map_stage);
+}
+
+float map_generation_progress() {
+    MapStage stage = map_generation_stage();
+    if (stage >= MAP_STAGE_READY) return 1.0f;
+    
+    // Etapas terminadas más la parte hecha de la actual (solo el PVS la informa)
+    float progress = 0.0f;
+    for (int i = 0; i < (int)stage; i++) progress += map_stage_weights[i];
+    if (stage == MAP_STAGE_VISIBILITY) progress += map_stage_weights[stage] * pvs_bake_progress();
+    return progress;
+}
+
+const char* map_stage_name(MapStage stage) {
+    if (stage < 0 || stage >= MAP_STAGE_COUNT) return "";
+    return map_stage_names[stage];
+}
+
+void set_map_seed(unsigned int seed) {
+    // Fijar la semilla para generar siempre el mismo mapa
+    map_seed = seed;
+    map_seed_fixed = true;
 }
 
 bool is_map_ready() {
-    return map_preloaded && map_generation_complete;
+    return atomic_load_long(&map_stage) == MAP_STAGE_READY;
 }
 
 void show_loading_progress() {
@@ -74,16 +329,18 @@ void show_loading_progress() {
 }
 
 void generate_map() {
-    printf("Iniciando generación de mapa...\n");
+    if (map_verbose) printf("Iniciando generación de mapa...\n");
+    set_map_stage(MAP_STAGE_ROOMS);
     
-    // Inicializar todo como paredes
-        for (int x = 0; x < MAZE_WIDTH; x++) {
-        for (int z = 0; z < MAZE_HEIGHT; z++) {
-            maze[x][z] = 1;
-        }
+    if (!allocate_map_storage()) {
+        printf("Error: Sin memoria para un mapa de %dx%d celdas\n", maze_width, maze_height);
+        exit(1);
     }
     
-    printf("Mapa inicializado con %d x %d = %d celdas\n", MAZE_WIDTH, MAZE_HEIGHT, MAZE_WIDTH * MAZE_HEIGHT);
+    // Inicializar todo como paredes (sin banderas)
+    memset(maze_cells, CELL_WALL, maze_storage_cells());
+    
+    if (map_verbose) printf("Mapa inicializado con %d x %d = %d celdas\n", maze_width, maze_height, maze_width * maze_height);
     
     // Resetear contadores
     roomCount = 0;
@@ -92,11 +349,11 @@ void generate_map() {
     lightCount = 0;
     
     // PRIMERO: Crear área del jugador en el centro
-    int centerX = MAZE_WIDTH / 2;
-    int centerZ = MAZE_HEIGHT / 2;
+    int centerX = maze_width / 2;
+    int centerZ = maze_height / 2;
         for (int x = centerX - 5; x <= centerX + 5; x++) {
         for (int z = centerZ - 5; z <= centerZ + 5; z++) {
-            maze[x][z] = 0; // Área libre 11x11 (más ancha)
+            set_maze_cell(x, z, 0); // Área libre 11x11 (más ancha)
         }
     }
     
@@ -107,22 +364,42 @@ void generate_map() {
     generate_advanced_backrooms();
     
     // CUARTO: Verificar conectividad y corregir si es necesario
+    set_map_stage(MAP_STAGE_CONNECTIVITY);
     ensure_connectivity();
     
+    // El plano de bits se construye una vez con la rejilla final
+    rebuild_wall_bits();
+    
+    // Banderas de celdas con luz (misma celda que su visibilidad precalculada)
+    for (int i = 0; i < lightCount; i++) {
+        int x = (int)floorf(lightPoints[i].x + 0.5f);
+        int z = (int)floorf(lightPoints[i].z + 0.5f);
+        if (maze_in_bounds(x, z)) set_maze_flag(x, z, CELL_LIGHT);
+    }
+    
     // Debug: contar muros finales
-    int wall_count = 0;
-    for (int x = 0; x < MAZE_WIDTH; x++) {
-        for (int z = 0; z < MAZE_HEIGHT; z++) {
-            if (maze[x][z] == 1) wall_count++;
-        }
+    long wall_count = count_maze_walls();
+    long grid_bytes = (long)maze_storage_cells() + (long)sizeof(uint64_t) * maze_width * wall_bits_stride;
+    if (map_verbose) {
+        printf("Mapa generado: %ld muros de %d celdas totales (rejilla %s y plano de bits: %ld KB)\n",
+               wall_count, maze_width * maze_height,
+               map_layout == MAP_LAYOUT_TILED ? "en bloques de 8x8" : "lineal", grid_bytes / 1024);
     }
-    printf("Mapa generado: %d muros de %d celdas totales\n", wall_count, MAZE_WIDTH * MAZE_HEIGHT);
+}
+
+// Rejilla escrita fuera de generate_map (ventana del mundo infinito): reconstruir el
+// plano de bits y publicar el mapa como listo. Sin PVS: se usa el test de distancia
+void commit_map_cells() {
+    rebuild_wall_bits();
+    map_preloaded = true;
+    map_generation_complete = true;
+    set_map_stage(MAP_STAGE_READY);
 }
 
 // Función para detectar si el jugador llegó a la salida
 bool check_exit_reached(float x, float z) {
     // Verificar si está cerca de los bordes del mapa (salida)
-    if (x <= 2.0f || x >= MAZE_WIDTH - 2.0f || z <= 2.0f || z >= MAZE_HEIGHT - 2.0f) {
+    if (x <= 2.0f || x >= maze_width - 2.0f || z <= 2.0f || z >= maze_height - 2.0f) {
         return true;
     }
     return false;
@@ -132,34 +409,34 @@ void generate_classic_maze() {
     // Crear pasillos principales de diferentes anchos (estilo backrooms)
     
     // Pasillos horizontales principales (muy anchos)
-    for (int x = 5; x < MAZE_WIDTH - 5; x += 8) {
-        for (int z = 5; z < MAZE_HEIGHT - 5; z++) {
+    for (int x = 5; x < maze_width - 5; x += 8) {
+        for (int z = 5; z < maze_height - 5; z++) {
             // Pasillo principal de 3-4 unidades de ancho
-            maze[x][z] = 0;
-            if (z < MAZE_HEIGHT - 6) maze[x][z+1] = 0;
-            if (z < MAZE_HEIGHT - 7) maze[x][z+2] = 0;
-            if (rand() % 2 == 0 && z < MAZE_HEIGHT - 8) maze[x][z+3] = 0; // A veces 4 de ancho
+            set_maze_cell(x, z, 0);
+            if (z < maze_height - 6) set_maze_cell(x, z+1, 0);
+            if (z < maze_height - 7) set_maze_cell(x, z+2, 0);
+            if (rand() % 2 == 0 && z < maze_height - 8) set_maze_cell(x, z+3, 0); // A veces 4 de ancho
         }
     }
     
     // Pasillos verticales principales (muy anchos)
-    for (int z = 5; z < MAZE_HEIGHT - 5; z += 8) {
-        for (int x = 5; x < MAZE_WIDTH - 5; x++) {
+    for (int z = 5; z < maze_height - 5; z += 8) {
+        for (int x = 5; x < maze_width - 5; x++) {
             if (rand() % 2 == 0) { // 50% de probabilidad de pasillo vertical
                 // Pasillo de 2-3 unidades de ancho
-                maze[x][z] = 0;
-                if (x < MAZE_WIDTH - 6) maze[x+1][z] = 0;
-                if (rand() % 2 == 0 && x < MAZE_WIDTH - 7) maze[x+2][z] = 0; // A veces 3 de ancho
+                set_maze_cell(x, z, 0);
+                if (x < maze_width - 6) set_maze_cell(x+1, z, 0);
+                if (rand() % 2 == 0 && x < maze_width - 7) set_maze_cell(x+2, z, 0); // A veces 3 de ancho
             }
         }
     }
     
     // Crear pasillos secundarios más estrechos
-    for (int x = 2; x < MAZE_WIDTH - 2; x += 4) {
-        for (int z = 2; z < MAZE_HEIGHT - 2; z++) {
+    for (int x = 2; x < maze_width - 2; x += 4) {
+        for (int z = 2; z < maze_height - 2; z++) {
             if (rand() % 3 == 0) { // 33% de probabilidad
-                maze[x][z] = 0; // Pasillo de 1 unidad
-                if (rand() % 2 == 0) maze[x][z+1] = 0; // A veces 2 de ancho
+                set_maze_cell(x, z, 0); // Pasillo de 1 unidad
+                if (rand() % 2 == 0) set_maze_cell(x, z+1, 0); // A veces 2 de ancho
             }
         }
     }
@@ -168,16 +445,16 @@ void generate_classic_maze() {
 void generate_room_maze() {
     // Crear salas grandes de diferentes tamaños (estilo backrooms)
     for (int room = 0; room < 20; room++) { // Más salas
-        int roomX = rand() % (MAZE_WIDTH - 20) + 10;
-        int roomZ = rand() % (MAZE_HEIGHT - 20) + 10;
+        int roomX = rand() % (maze_width - 20) + 10;
+        int roomZ = rand() % (maze_height - 20) + 10;
         int roomW = rand() % 12 + 8; // 8-19 de ancho (salas más grandes)
         int roomH = rand() % 12 + 8; // 8-19 de alto (salas más grandes)
         
         // Asegurar que la habitación quepa
-        if (roomX + roomW < MAZE_WIDTH - 2 && roomZ + roomH < MAZE_HEIGHT - 2) {
+        if (roomX + roomW < maze_width - 2 && roomZ + roomH < maze_height - 2) {
             for (int x = roomX; x < roomX + roomW; x++) {
                 for (int z = roomZ; z < roomZ + roomH; z++) {
-                    maze[x][z] = 0;
+                    set_maze_cell(x, z, 0);
                 }
             }
         }
@@ -185,15 +462,15 @@ void generate_room_maze() {
     
     // Crear salas medianas
     for (int room = 0; room < 20; room++) {
-        int roomX = rand() % (MAZE_WIDTH - 8) + 3;
-        int roomZ = rand() % (MAZE_HEIGHT - 8) + 3;
+        int roomX = rand() % (maze_width - 8) + 3;
+        int roomZ = rand() % (maze_height - 8) + 3;
         int roomW = rand() % 4 + 3; // 3-6 de ancho
         int roomH = rand() % 4 + 3; // 3-6 de alto
         
-        if (roomX + roomW < MAZE_WIDTH - 2 && roomZ + roomH < MAZE_HEIGHT - 2) {
+        if (roomX + roomW < maze_width - 2 && roomZ + roomH < maze_height - 2) {
                 for (int x = roomX; x < roomX + roomW; x++) {
                 for (int z = roomZ; z < roomZ + roomH; z++) {
-                    maze[x][z] = 0;
+                    set_maze_cell(x, z, 0);
                 }
             }
         }
@@ -201,28 +478,28 @@ void generate_room_maze() {
     
     // Conectar habitaciones con pasillos de diferentes anchos
     for (int i = 0; i < 25; i++) {
-        int x = rand() % (MAZE_WIDTH - 2) + 1;
-        int z = rand() % (MAZE_HEIGHT - 2) + 1;
-        maze[x][z] = 0;
+        int x = rand() % (maze_width - 2) + 1;
+        int z = rand() % (maze_height - 2) + 1;
+        set_maze_cell(x, z, 0);
         
         // A veces crear pasillos de conexión más anchos
         if (rand() % 3 == 0) {
-            if (x < MAZE_WIDTH - 3) maze[x+1][z] = 0;
-            if (z < MAZE_HEIGHT - 3) maze[x][z+1] = 0;
+            if (x < maze_width - 3) set_maze_cell(x+1, z, 0);
+            if (z < maze_height - 3) set_maze_cell(x, z+1, 0);
         }
     }
 }
 
 void generate_winding_corridors() {
     // Crear pasillos serpenteantes de diferentes anchos
-    int startX = MAZE_WIDTH / 2;
-    int startZ = MAZE_HEIGHT / 2;
+    int startX = maze_width / 2;
+    int startZ = maze_height / 2;
     int currentX = startX;
     int currentZ = startZ;
     
     for (int steps = 0; steps < 300; steps++) {
         // Crear pasillo en la posición actual
-        maze[currentX][currentZ] = 0;
+        set_maze_cell(currentX, currentZ, 0);
         
         // A veces crear pasillos más anchos
         int corridor_width = 1;
@@ -231,8 +508,8 @@ void generate_winding_corridors() {
         
         // Expandir el pasillo según el ancho
         for (int w = 1; w < corridor_width; w++) {
-            if (currentX + w < MAZE_WIDTH - 1) maze[currentX + w][currentZ] = 0;
-            if (currentZ + w < MAZE_HEIGHT - 1) maze[currentX][currentZ + w] = 0;
+            if (currentX + w < maze_width - 1) set_maze_cell(currentX + w, currentZ, 0);
+            if (currentZ + w < maze_height - 1) set_maze_cell(currentX, currentZ + w, 0);
         }
         
         int direction = rand() % 4;
@@ -241,10 +518,10 @@ void generate_winding_corridors() {
                 if (currentZ > 1) currentZ--;
                 break;
             case 1: // Sur (Z positivo)
-                if (currentZ < MAZE_HEIGHT - 2) currentZ++;
+                if (currentZ < maze_height - 2) currentZ++;
                 break;
             case 2: // Este (X positivo)
-                if (currentX < MAZE_WIDTH - 2) currentX++;
+                if (currentX < maze_width - 2) currentX++;
                 break;
             case 3: // Oeste (X negativo)
                 if (currentX > 1) currentX--;
@@ -258,51 +535,51 @@ void generate_backrooms_pattern() {
     
     // Crear grandes salas abiertas (como las típicas de backrooms)
     for (int room = 0; room < 15; room++) { // Más salas grandes
-        int roomX = rand() % (MAZE_WIDTH - 25) + 12;
-        int roomZ = rand() % (MAZE_HEIGHT - 25) + 12;
+        int roomX = rand() % (maze_width - 25) + 12;
+        int roomZ = rand() % (maze_height - 25) + 12;
         int roomW = rand() % 15 + 10; // 10-24 de ancho (salas muy grandes)
         int roomH = rand() % 15 + 10; // 10-24 de alto (salas muy grandes)
         
-        if (roomX + roomW < MAZE_WIDTH - 2 && roomZ + roomH < MAZE_HEIGHT - 2) {
+        if (roomX + roomW < maze_width - 2 && roomZ + roomH < maze_height - 2) {
             for (int x = roomX; x < roomX + roomW; x++) {
                 for (int z = roomZ; z < roomZ + roomH; z++) {
-                    maze[x][z] = 0;
+                    set_maze_cell(x, z, 0);
                 }
             }
         }
     }
     
     // Crear pasillos principales muy anchos (como los típicos de backrooms)
-    for (int x = 3; x < MAZE_WIDTH - 3; x += 6) {
-        for (int z = 3; z < MAZE_HEIGHT - 3; z++) {
+    for (int x = 3; x < maze_width - 3; x += 6) {
+        for (int z = 3; z < maze_height - 3; z++) {
             if (rand() % 2 == 0) { // 50% de probabilidad
                 // Pasillo de 3-5 unidades de ancho
-                maze[x][z] = 0;
-                if (z < MAZE_HEIGHT - 4) maze[x][z+1] = 0;
-                if (z < MAZE_HEIGHT - 5) maze[x][z+2] = 0;
-                if (rand() % 2 == 0 && z < MAZE_HEIGHT - 6) maze[x][z+3] = 0;
-                if (rand() % 3 == 0 && z < MAZE_HEIGHT - 7) maze[x][z+4] = 0;
+                set_maze_cell(x, z, 0);
+                if (z < maze_height - 4) set_maze_cell(x, z+1, 0);
+                if (z < maze_height - 5) set_maze_cell(x, z+2, 0);
+                if (rand() % 2 == 0 && z < maze_height - 6) set_maze_cell(x, z+3, 0);
+                if (rand() % 3 == 0 && z < maze_height - 7) set_maze_cell(x, z+4, 0);
             }
         }
     }
     
     // Crear pasillos secundarios de diferentes anchos
-    for (int x = 2; x < MAZE_WIDTH - 2; x += 3) {
-        for (int z = 2; z < MAZE_HEIGHT - 2; z++) {
+    for (int x = 2; x < maze_width - 2; x += 3) {
+        for (int z = 2; z < maze_height - 2; z++) {
             if (rand() % 4 == 0) { // 25% de probabilidad
-                maze[x][z] = 0; // Pasillo base
-                if (rand() % 2 == 0) maze[x][z+1] = 0; // A veces 2 de ancho
-                if (rand() % 3 == 0) maze[x+1][z] = 0; // A veces también en X
+                set_maze_cell(x, z, 0); // Pasillo base
+                if (rand() % 2 == 0) set_maze_cell(x, z+1, 0); // A veces 2 de ancho
+                if (rand() % 3 == 0) set_maze_cell(x+1, z, 0); // A veces también en X
             }
         }
     }
     
     // Crear callejones sin salida (muy típicos de backrooms)
     for (int i = 0; i < 40; i++) {
-        int startX = rand() % (MAZE_WIDTH - 6) + 3;
-        int startZ = rand() % (MAZE_HEIGHT - 6) + 3;
+        int startX = rand() % (maze_width - 6) + 3;
+        int startZ = rand() % (maze_height - 6) + 3;
         
-        if (maze[startX][startZ] == 0) { // Empezar desde un pasillo existente
+        if (maze_cell(startX, startZ) == 0) { // Empezar desde un pasillo existente
             int length = rand() % 12 + 4; // Longitud del callejón 4-15
             int direction = rand() % 4;
             int width = rand() % 2 + 1; // Ancho 1-2
@@ -311,30 +588,30 @@ void generate_backrooms_pattern() {
                 switch (direction) {
                     case 0: // Norte
                         if (startZ - j > 0) {
-                            maze[startX][startZ - j] = 0;
-                            if (width == 2 && startX + 1 < MAZE_WIDTH - 1) 
-                                maze[startX + 1][startZ - j] = 0;
+                            set_maze_cell(startX, startZ - j, 0);
+                            if (width == 2 && startX + 1 < maze_width - 1) 
+                                set_maze_cell(startX + 1, startZ - j, 0);
                         }
                         break;
                     case 1: // Sur
-                        if (startZ + j < MAZE_HEIGHT - 1) {
-                            maze[startX][startZ + j] = 0;
-                            if (width == 2 && startX + 1 < MAZE_WIDTH - 1) 
-                                maze[startX + 1][startZ + j] = 0;
+                        if (startZ + j < maze_height - 1) {
+                            set_maze_cell(startX, startZ + j, 0);
+                            if (width == 2 && startX + 1 < maze_width - 1) 
+                                set_maze_cell(startX + 1, startZ + j, 0);
                         }
                         break;
                     case 2: // Este
-                        if (startX + j < MAZE_WIDTH - 1) {
-                            maze[startX + j][startZ] = 0;
-                            if (width == 2 && startZ + 1 < MAZE_HEIGHT - 1) 
-                                maze[startX + j][startZ + 1] = 0;
+                        if (startX + j < maze_width - 1) {
+                            set_maze_cell(startX + j, startZ, 0);
+                            if (width == 2 && startZ + 1 < maze_height - 1) 
+                                set_maze_cell(startX + j, startZ + 1, 0);
                         }
                         break;
                     case 3: // Oeste
                         if (startX - j > 0) {
-                            maze[startX - j][startZ] = 0;
-                            if (width == 2 && startZ + 1 < MAZE_HEIGHT - 1) 
-                                maze[startX - j][startZ + 1] = 0;
+                            set_maze_cell(startX - j, startZ, 0);
+                            if (width == 2 && startZ + 1 < maze_height - 1) 
+                                set_maze_cell(startX - j, startZ + 1, 0);
                         }
                         break;
                 }
@@ -344,44 +621,44 @@ void generate_backrooms_pattern() {
     
     // Crear columnas sueltas de diferentes tamaños (típicas de backrooms)
     for (int i = 0; i < 80; i++) { // Muchas más columnas
-        int x = rand() % (MAZE_WIDTH - 6) + 3;
-        int z = rand() % (MAZE_HEIGHT - 6) + 3;
+        int x = rand() % (maze_width - 6) + 3;
+        int z = rand() % (maze_height - 6) + 3;
         
         // Solo crear columnas en espacios abiertos
-        if (maze[x][z] == 0) {
+        if (maze_cell(x, z) == 0) {
             int columnType = rand() % 4; // 4 tipos de columnas
             
             switch (columnType) {
                 case 0: // Columna simple 1x1
-                    maze[x][z] = 1;
+                    set_maze_cell(x, z, 1);
                     break;
                 case 1: // Columna 2x2
-                    if (x < MAZE_WIDTH - 2 && z < MAZE_HEIGHT - 2) {
-                        maze[x][z] = 1;
-                        maze[x+1][z] = 1;
-                        maze[x][z+1] = 1;
-                        maze[x+1][z+1] = 1;
+                    if (x < maze_width - 2 && z < maze_height - 2) {
+                        set_maze_cell(x, z, 1);
+                        set_maze_cell(x+1, z, 1);
+                        set_maze_cell(x, z+1, 1);
+                        set_maze_cell(x+1, z+1, 1);
                     }
                     break;
                 case 2: // Columna 3x3
-                    if (x < MAZE_WIDTH - 3 && z < MAZE_HEIGHT - 3) {
+                    if (x < maze_width - 3 && z < maze_height - 3) {
                         for (int dx = 0; dx < 3; dx++) {
                             for (int dz = 0; dz < 3; dz++) {
-                                maze[x+dx][z+dz] = 1;
+                                set_maze_cell(x+dx, z+dz, 1);
                             }
                         }
                     }
                     break;
                 case 3: // Columna rectangular 2x1 o 1x2
                     if (rand() % 2 == 0) { // 2x1
-                        if (x < MAZE_WIDTH - 2) {
-                            maze[x][z] = 1;
-                            maze[x+1][z] = 1;
+                        if (x < maze_width - 2) {
+                            set_maze_cell(x, z, 1);
+                            set_maze_cell(x+1, z, 1);
                         }
                     } else { // 1x2
-                        if (z < MAZE_HEIGHT - 2) {
-                            maze[x][z] = 1;
-                            maze[x][z+1] = 1;
+                        if (z < maze_height - 2) {
+                            set_maze_cell(x, z, 1);
+                            set_maze_cell(x, z+1, 1);
                         }
                     }
                     break;
@@ -397,41 +674,46 @@ void ensure_single_exit() {
     
     switch (exit_side) {
         case 0: // Norte (Z=0) - Salida estrecha
-            exit_pos = rand() % (MAZE_WIDTH - 2) + 1; // Posición aleatoria
-            maze[exit_pos][0] = 0; // Solo una celda de salida
+            exit_pos = rand() % (maze_width - 2) + 1; // Posición aleatoria
+            set_maze_cell(exit_pos, 0, 0); // Solo una celda de salida
             break;
-        case 1: // Sur (Z=MAZE_HEIGHT-1) - Salida estrecha
-            exit_pos = rand() % (MAZE_WIDTH - 2) + 1;
-            maze[exit_pos][MAZE_HEIGHT - 1] = 0; // Solo una celda de salida
+        case 1: // Sur (Z=maze_height-1) - Salida estrecha
+            exit_pos = rand() % (maze_width - 2) + 1;
+            set_maze_cell(exit_pos, maze_height - 1, 0); // Solo una celda de salida
             break;
-        case 2: // Este (X=MAZE_WIDTH-1) - Salida estrecha
-            exit_pos = rand() % (MAZE_HEIGHT - 2) + 1;
-            maze[MAZE_WIDTH - 1][exit_pos] = 0; // Solo una celda de salida
+        case 2: // Este (X=maze_width-1) - Salida estrecha
+            exit_pos = rand() % (maze_height - 2) + 1;
+            set_maze_cell(maze_width - 1, exit_pos, 0); // Solo una celda de salida
             break;
         case 3: // Oeste (X=0) - Salida estrecha
-            exit_pos = rand() % (MAZE_HEIGHT - 2) + 1;
-            maze[0][exit_pos] = 0; // Solo una celda de salida
+            exit_pos = rand() % (maze_height - 2) + 1;
+            set_maze_cell(0, exit_pos, 0); // Solo una celda de salida
             break;
     }
     
+    // Marcar la celda de salida
+    int exit_x = exit_side == 2 ? maze_width - 1 : exit_side == 3 ? 0 : exit_pos;
+    int exit_z = exit_side == 0 ? 0 : exit_side == 1 ? maze_height - 1 : exit_pos;
+    set_maze_flag(exit_x, exit_z, CELL_TRIGGER);
+    
     // Crear un laberinto complejo que conecte la salida con el centro
     create_complex_path_to_exit(exit_side, exit_pos);
 }
 
 void create_main_corridors(int exits[4]) {
     // Pasillo principal norte-sur (Z)
-    for (int z = 1; z < MAZE_HEIGHT - 1; z++) {
+    for (int z = 1; z < maze_height - 1; z++) {
         if (rand() % 3 == 0) { // 33% de probabilidad
-            maze[exits[0]][z] = 0; // Conectar con salida norte
-            maze[exits[1]][z] = 0; // Conectar con salida sur
+            set_maze_cell(exits[0], z, 0); // Conectar con salida norte
+            set_maze_cell(exits[1], z, 0); // Conectar con salida sur
         }
     }
     
     // Pasillo principal este-oeste (X)
-    for (int x = 1; x < MAZE_WIDTH - 1; x++) {
+    for (int x = 1; x < maze_width - 1; x++) {
         if (rand() % 3 == 0) { // 33% de probabilidad
-            maze[x][exits[2]] = 0; // Conectar con salida este
-            maze[x][exits[3]] = 0; // Conectar con salida oeste
+            set_maze_cell(x, exits[2], 0); // Conectar con salida este
+            set_maze_cell(x, exits[3], 0); // Conectar con salida oeste
         }
     }
 }
@@ -439,26 +721,26 @@ void create_main_corridors(int exits[4]) {
 void connect_exits_to_center(int exits[4]) {
     // Conectar norte al centro
     for (int i = 0; i < 3; i++) {
-        if (exits[0] > 1) maze[exits[0] - 1][1] = 0;
-        if (exits[0] < MAZE_WIDTH - 2) maze[exits[0] + 1][1] = 0;
+        if (exits[0] > 1) set_maze_cell(exits[0] - 1, 1, 0);
+        if (exits[0] < maze_width - 2) set_maze_cell(exits[0] + 1, 1, 0);
     }
     
     // Conectar sur al centro
     for (int i = 0; i < 3; i++) {
-        if (exits[1] > 1) maze[exits[1] - 1][MAZE_HEIGHT - 2] = 0;
-        if (exits[1] < MAZE_WIDTH - 2) maze[exits[1] + 1][MAZE_HEIGHT - 2] = 0;
+        if (exits[1] > 1) set_maze_cell(exits[1] - 1, maze_height - 2, 0);
+        if (exits[1] < maze_width - 2) set_maze_cell(exits[1] + 1, maze_height - 2, 0);
     }
     
     // Conectar este al centro
     for (int i = 0; i < 3; i++) {
-        if (exits[2] > 1) maze[MAZE_WIDTH - 2][exits[2] - 1] = 0;
-        if (exits[2] < MAZE_HEIGHT - 2) maze[MAZE_WIDTH - 2][exits[2] + 1] = 0;
+        if (exits[2] > 1) set_maze_cell(maze_width - 2, exits[2] - 1, 0);
+        if (exits[2] < maze_height - 2) set_maze_cell(maze_width - 2, exits[2] + 1, 0);
     }
     
     // Conectar oeste al centro
     for (int i = 0; i < 3; i++) {
-        if (exits[3] > 1) maze[1][exits[3] - 1] = 0;
-        if (exits[3] < MAZE_HEIGHT - 2) maze[1][exits[3] + 1] = 0;
+        if (exits[3] > 1) set_maze_cell(1, exits[3] - 1, 0);
+        if (exits[3] < maze_height - 2) set_maze_cell(1, exits[3] + 1, 0);
     }
     
     // Crear pasillos principales hacia el centro desde cada salida
@@ -466,8 +748,8 @@ void connect_exits_to_center(int exits[4]) {
 }
 
 void create_complex_path_to_exit(int exit_side, int exit_pos) {
-    int centerX = MAZE_WIDTH / 2;
-    int centerZ = MAZE_HEIGHT / 2;
+    int centerX = maze_width / 2;
+    int centerZ = maze_height / 2;
     
     // Crear un camino serpenteante y complejo desde el centro hacia la salida
     int currentX = centerX;
@@ -480,12 +762,12 @@ void create_complex_path_to_exit(int exit_side, int exit_pos) {
             targetX = exit_pos;
             targetZ = 0;
             break;
-        case 1: // Sur (Z=MAZE_HEIGHT-1)
+        case 1: // Sur (Z=maze_height-1)
             targetX = exit_pos;
-            targetZ = MAZE_HEIGHT - 1;
+            targetZ = maze_height - 1;
             break;
-        case 2: // Este (X=MAZE_WIDTH-1)
-            targetX = MAZE_WIDTH - 1;
+        case 2: // Este (X=maze_width-1)
+            targetX = maze_width - 1;
             targetZ = exit_pos;
             break;
         case 3: // Oeste (X=0)
@@ -495,9 +777,10 @@ void create_complex_path_to_exit(int exit_side, int exit_pos) {
     }
     
     // Crear camino principal con desvíos y callejones sin salida
-    for (int step = 0; step < 200; step++) {
+    int max_steps = scale_to_span(200);
+    for (int step = 0; step < max_steps; step++) {
         // Asegurar que el camino actual esté libre
-        maze[currentX][currentZ] = 0;
+        set_maze_cell(currentX, currentZ, 0);
         
         // Calcular dirección hacia el objetivo
         int dirX = (targetX > currentX) ? 1 : (targetX < currentX) ? -1 : 0;
@@ -514,7 +797,7 @@ void create_complex_path_to_exit(int exit_side, int exit_pos) {
         int newZ = currentZ + dirZ;
         
         // Verificar límites
-        if (newX > 0 && newX < MAZE_WIDTH - 1 && newZ > 0 && newZ < MAZE_HEIGHT - 1) {
+        if (newX > 0 && newX < maze_width - 1 && newZ > 0 && newZ < maze_height - 1) {
             currentX = newX;
             currentZ = newZ;
         }
@@ -531,11 +814,12 @@ void create_complex_path_to_exit(int exit_side, int exit_pos) {
 
 void create_dead_ends() {
     // Crear callejones sin salida de diferentes anchos (típicos de backrooms)
-    for (int i = 0; i < 50; i++) {
-        int startX = rand() % (MAZE_WIDTH - 6) + 3;
-        int startZ = rand() % (MAZE_HEIGHT - 6) + 3;
+    int dead_ends = scale_to_area(50);
+    for (int i = 0; i < dead_ends; i++) {
+        int startX = rand() % (maze_width - 6) + 3;
+        int startZ = rand() % (maze_height - 6) + 3;
         
-        if (maze[startX][startZ] == 0) { // Empezar desde un pasillo existente
+        if (maze_cell(startX, startZ) == 0) { // Empezar desde un pasillo existente
             int length = rand() % 12 + 4; // Longitud del callejón 4-15
             int direction = rand() % 4;
             int width = rand() % 3 + 1; // Ancho 1-3 (más variado)
@@ -544,41 +828,41 @@ void create_dead_ends() {
                 switch (direction) {
                     case 0: // Norte (Z negativo)
                         if (startZ - j > 0) {
-                            maze[startX][startZ - j] = 0;
+                            set_maze_cell(startX, startZ - j, 0);
                             // Expandir según el ancho
                             for (int w = 1; w < width; w++) {
-                                if (startX + w < MAZE_WIDTH - 1) 
-                                    maze[startX + w][startZ - j] = 0;
+                                if (startX + w < maze_width - 1) 
+                                    set_maze_cell(startX + w, startZ - j, 0);
                             }
                         }
                         break;
                     case 1: // Sur (Z positivo)
-                        if (startZ + j < MAZE_HEIGHT - 1) {
-                            maze[startX][startZ + j] = 0;
+                        if (startZ + j < maze_height - 1) {
+                            set_maze_cell(startX, startZ + j, 0);
                             // Expandir según el ancho
                             for (int w = 1; w < width; w++) {
-                                if (startX + w < MAZE_WIDTH - 1) 
-                                    maze[startX + w][startZ + j] = 0;
+                                if (startX + w < maze_width - 1) 
+                                    set_maze_cell(startX + w, startZ + j, 0);
                             }
                         }
                         break;
                     case 2: // Este (X positivo)
-                        if (startX + j < MAZE_WIDTH - 1) {
-                            maze[startX + j][startZ] = 0;
+                        if (startX + j < maze_width - 1) {
+                            set_maze_cell(startX + j, startZ, 0);
                             // Expandir según el ancho
                             for (int w = 1; w < width; w++) {
-                                if (startZ + w < MAZE_HEIGHT - 1) 
-                                    maze[startX + j][startZ + w] = 0;
+                                if (startZ + w < maze_height - 1) 
+                                    set_maze_cell(startX + j, startZ + w, 0);
                             }
                         }
                         break;
                     case 3: // Oeste (X negativo)
                         if (startX - j > 0) {
-                            maze[startX - j][startZ] = 0;
+                            set_maze_cell(startX - j, startZ, 0);
                             // Expandir según el ancho
                             for (int w = 1; w < width; w++) {
-                                if (startZ + w < MAZE_HEIGHT - 1) 
-                                    maze[startX - j][startZ + w] = 0;
+                                if (startZ + w < maze_height - 1) 
+                                    set_maze_cell(startX - j, startZ + w, 0);
                             }
                         }
                         break;
@@ -591,28 +875,28 @@ void create_dead_ends() {
 void add_decorative_elements() {
     // Añadir elementos decorativos aleatorios para ambiente backrooms
     for (int i = 0; i < 25; i++) {
-        int x = rand() % (MAZE_WIDTH - 2) + 1;
-        int z = rand() % (MAZE_HEIGHT - 2) + 1;
-        if (maze[x][z] == 0) { // Solo en espacios vacíos
+        int x = rand() % (maze_width - 2) + 1;
+        int z = rand() % (maze_height - 2) + 1;
+        if (maze_cell(x, z) == 0) { // Solo en espacios vacíos
             // Crear pequeñas estructuras decorativas
             if (rand() % 3 == 0) {
-                maze[x][z] = 2; // Marcar como elemento decorativo
+                set_maze_cell(x, z, 2); // Marcar como elemento decorativo
             }
         }
     }
 }
 
 bool is_wall(int x, int z) {
-    if (x < 0 || x >= MAZE_WIDTH || z < 0 || z >= MAZE_HEIGHT) {
+    if (x < 0 || x >= maze_width || z < 0 || z >= maze_height) {
         return true; // Fuera del mapa = pared
     }
-    return maze[x][z] == 1;
+    return maze_wall_bit(x, z);
 }
 
 void create_guaranteed_path_to_exit() {
     // Crear un camino directo y garantizado desde el centro hasta la salida
-    int centerX = MAZE_WIDTH / 2;
-    int centerZ = MAZE_HEIGHT / 2;
+    int centerX = maze_width / 2;
+    int centerZ = maze_height / 2;
     
     // Si no hay salida definida, crear una
     if (exit_side == -1) {
@@ -630,12 +914,12 @@ void create_guaranteed_path_to_exit() {
             targetX = exit_pos;
             targetZ = 0;
             break;
-        case 1: // Sur (Z=MAZE_HEIGHT-1)
+        case 1: // Sur (Z=maze_height-1)
             targetX = exit_pos;
-            targetZ = MAZE_HEIGHT - 1;
+            targetZ = maze_height - 1;
             break;
-        case 2: // Este (X=MAZE_WIDTH-1)
-            targetX = MAZE_WIDTH - 1;
+        case 2: // Este (X=maze_width-1)
+            targetX = maze_width - 1;
             targetZ = exit_pos;
             break;
         case 3: // Oeste (X=0)
@@ -647,7 +931,7 @@ void create_guaranteed_path_to_exit() {
     // Crear camino directo con algunos desvíos para hacerlo más interesante
     while (currentX != targetX || currentZ != targetZ) {
         // Asegurar que el camino actual esté libre
-        maze[currentX][currentZ] = 0;
+        set_maze_cell(currentX, currentZ, 0);
         
         // Calcular dirección hacia el objetivo
         int dirX = (targetX > currentX) ? 1 : (targetX < currentX) ? -1 : 0;
@@ -664,7 +948,7 @@ void create_guaranteed_path_to_exit() {
         int newZ = currentZ + dirZ;
         
         // Verificar límites
-        if (newX >= 0 && newX < MAZE_WIDTH && newZ >= 0 && newZ < MAZE_HEIGHT) {
+        if (newX >= 0 && newX < maze_width && newZ >= 0 && newZ < maze_height) {
             currentX = newX;
             currentZ = newZ;
         } else {
@@ -680,65 +964,54 @@ void create_guaranteed_path_to_exit() {
         
         // Evitar bucle infinito
         static int steps = 0;
-        if (++steps > MAZE_WIDTH + MAZE_HEIGHT) break;
+        if (++steps > maze_width + maze_height) break;
     }
 }
 
 void ensure_connectivity() {
-    // Verificar si el centro está conectado a la salida
-    int centerX = MAZE_WIDTH / 2;
-    int centerZ = MAZE_HEIGHT / 2;
+    // El jugador aparece en el centro: si una columna lo ha tapado se vuelve a abrir
+    if (maze_cell(maze_width / 2, maze_height / 2) == 1) {
+        set_maze_cell(maze_width / 2, maze_height / 2, 0);
+    }
     
-    if (!is_connected_to_exit(centerX, centerZ)) {
-        // Si no está conectado, crear un camino de emergencia
+    // Etiquetar todas las regiones abiertas y unirlas a la del centro
+    // connectivity.c recorre la rejilla en su propia disposición, sin copias
+    int* labels = malloc(sizeof(int) * maze_storage_cells());
+    int regions = labels ? label_components(maze_cells, maze_width, maze_height, map_layout, labels) : 0;
+    int carved = -1;
+    if (regions > 0) {
+        int main_label = labels[maze_index(maze_width / 2, maze_height / 2)];
+        carved = join_components(maze_cells, maze_width, maze_height, map_layout, labels, regions, main_label);
+    }
+    free(labels);
+    if (carved >= 0 && map_verbose) {
+        printf("Conectividad: %d regiones unidas abriendo %d muros\n", regions, carved);
+    }
+
+    // Sin memoria (o con el centro tapado) queda el camino de emergencia
+    if (!is_connected_to_exit(maze_width / 2, maze_height / 2)) {
         create_guaranteed_path_to_exit();
     }
 }
 
 bool is_connected_to_exit(int startX, int startZ) {
-    // Usar flood fill para verificar conectividad
-    bool visited[MAZE_WIDTH][MAZE_HEIGHT];
-    
-    // Inicializar array de visitados
-    for (int x = 0; x < MAZE_WIDTH; x++) {
-        for (int z = 0; z < MAZE_HEIGHT; z++) {
-            visited[x][z] = false;
-        }
-    }
-    
-    // Hacer flood fill desde el punto de inicio
-    flood_fill_connectivity(startX, startZ, visited);
-    
-    // Verificar si la salida fue visitada
+    if (exit_side < 0) return false;
+
+    int exitX = exit_pos, exitZ = exit_pos;
     switch (exit_side) {
-        case 0: // Norte
-            return visited[exit_pos][0];
-        case 1: // Sur
-            return visited[exit_pos][MAZE_HEIGHT - 1];
-        case 2: // Este
-            return visited[MAZE_WIDTH - 1][exit_pos];
-        case 3: // Oeste
-            return visited[0][exit_pos];
-        default:
-            return false;
+        case 0: exitZ = 0; break;                 // Norte
+        case 1: exitZ = maze_height - 1; break;   // Sur
+        case 2: exitX = maze_width - 1; break;    // Este
+        case 3: exitX = 0; break;                 // Oeste
     }
-}
 
-void flood_fill_connectivity(int x, int z, bool visited[MAZE_WIDTH][MAZE_HEIGHT]) {
-    // Verificar límites
-    if (x < 0 || x >= MAZE_WIDTH || z < 0 || z >= MAZE_HEIGHT) return;
-    
-    // Si ya fue visitado o es una pared, no continuar
-    if (visited[x][z] || maze[x][z] == 1) return;
-    
-    // Marcar como visitado
-    visited[x][z] = true;
-    
-    // Continuar con las 4 direcciones
-    flood_fill_connectivity(x + 1, z, visited); // Este
-    flood_fill_connectivity(x - 1, z, visited); // Oeste
-    flood_fill_connectivity(x, z + 1, visited); // Sur
-    flood_fill_connectivity(x, z - 1, visited); // Norte
+    // Relleno iterativo desde el punto de inicio (sin recursión ni array en la pila)
+    unsigned char* visited = calloc(maze_storage_cells(), 1);
+    if (!visited) return false;
+    scanline_fill(maze_cells, maze_width, maze_height, map_layout, startX, startZ, visited);
+    bool connected = visited[maze_index(exitX, exitZ)] != 0;
+    free(visited);
+    return connected;
 }
 
 // ===== NUEVO SISTEMA DE GENERACIÓN AVANZADA =====
@@ -748,29 +1021,34 @@ void generate_advanced_backrooms() {
     create_room_network();
     
     // Generar pasillos anchos que conecten las salas
+    set_map_stage(MAP_STAGE_CORRIDORS);
     generate_wide_corridors();
     
     // Conectar todas las salas con pasillos
     connect_rooms_with_corridors();
     
     // Colocar columnas sueltas de diferentes tamaños
+    set_map_stage(MAP_STAGE_COLUMNS);
     place_standalone_columns();
     
     // Generar puntos de luz como guías
+    set_map_stage(MAP_STAGE_LIGHTS);
     generate_light_points();
     
     // Aplicar todas las estructuras al mapa
+    set_map_stage(MAP_STAGE_CONNECTIVITY);
     apply_structures_to_maze();
 }
 
 void create_room_network() {
     // Crear salas grandes distribuidas por todo el mapa
-    for (int i = 0; i < 25; i++) {
-        if (roomCount >= 100) break;
+    int attempts = scale_to_area(25);
+    for (int i = 0; i < attempts; i++) {
+        if (roomCount >= roomCapacity) break;
         
         Room newRoom;
-        newRoom.x = rand() % (MAZE_WIDTH - 30) + 15;
-        newRoom.z = rand() % (MAZE_HEIGHT - 30) + 15;
+        newRoom.x = rand() % (maze_width - 30) + 15;
+        newRoom.z = rand() % (maze_height - 30) + 15;
         newRoom.width = rand() % 20 + 15;  // 15-34 de ancho (muy grandes)
         newRoom.height = rand() % 20 + 15; // 15-34 de alto (muy grandes)
         newRoom.type = 0; // Sala
@@ -788,8 +1066,8 @@ void create_room_network() {
             }
         }
         
-        if (canPlace && newRoom.x + newRoom.width < MAZE_WIDTH - 2 && 
-            newRoom.z + newRoom.height < MAZE_HEIGHT - 2) {
+        if (canPlace && newRoom.x + newRoom.width < maze_width - 2 && 
+            newRoom.z + newRoom.height < maze_height - 2) {
             rooms[roomCount] = newRoom;
             roomCount++;
         }
@@ -798,12 +1076,13 @@ void create_room_network() {
 
 void generate_wide_corridors() {
     // Crear pasillos principales muy anchos
-    for (int i = 0; i < 15; i++) {
-        if (corridorCount >= 200) break;
+    int wide_corridors = scale_to_area(15);
+    for (int i = 0; i < wide_corridors; i++) {
+        if (corridorCount >= corridorCapacity) break;
         
         Corridor newCorridor;
-        newCorridor.x1 = rand() % (MAZE_WIDTH - 20) + 10;
-        newCorridor.z1 = rand() % (MAZE_HEIGHT - 20) + 10;
+        newCorridor.x1 = rand() % (maze_width - 20) + 10;
+        newCorridor.z1 = rand() % (maze_height - 20) + 10;
         newCorridor.x2 = newCorridor.x1 + (rand() % 40 - 20); // -20 a +20
         newCorridor.z2 = newCorridor.z1 + (rand() % 40 - 20); // -20 a +20
         newCorridor.width = rand() % 6 + 4; // 4-9 de ancho (muy anchos)
@@ -811,71 +1090,66 @@ void generate_wide_corridors() {
         
         // Asegurar que esté dentro de los límites
         if (newCorridor.x2 < 0) newCorridor.x2 = 0;
-        if (newCorridor.x2 >= MAZE_WIDTH) newCorridor.x2 = MAZE_WIDTH - 1;
+        if (newCorridor.x2 >= maze_width) newCorridor.x2 = maze_width - 1;
         if (newCorridor.z2 < 0) newCorridor.z2 = 0;
-        if (newCorridor.z2 >= MAZE_HEIGHT) newCorridor.z2 = MAZE_HEIGHT - 1;
+        if (newCorridor.z2 >= maze_height) newCorridor.z2 = maze_height - 1;
         
         corridors[corridorCount] = newCorridor;
         corridorCount++;
     }
 }
 
+// Sala más cercana a 'room' que no esté entre las 'chosen_count' ya elegidas; a igual
+// distancia gana el menor índice (el mismo orden que una ordenación estable)
+static int nearest_unchosen_room(int room, const int* chosen, int chosen_count) {
+    int best = -1;
+    float best_distance = 0.0f;
+    for (int j = 0; j < roomCount; j++) {
+        if (j == room) continue;
+        bool taken = false;
+        for (int c = 0; c < chosen_count; c++) {
+            if (chosen[c] == j) taken = true;
+        }
+        if (taken) continue;
+        
+        float distance = sqrt((rooms[room].x - rooms[j].x) * (rooms[room].x - rooms[j].x) + 
+                              (rooms[room].z - rooms[j].z) * (rooms[room].z - rooms[j].z));
+        if (best < 0 || distance < best_distance) {
+            best = j;
+            best_distance = distance;
+        }
+    }
+    return best;
+}
+
 void connect_rooms_with_corridors() {
     // Conectar cada sala con múltiples salas para evitar callejones sin salida
     for (int i = 0; i < roomCount; i++) {
         // Conectar cada sala con 2-3 salas cercanas
         int connectionsNeeded = 2 + (rand() % 2); // 2-3 conexiones por sala
-        int connectionsMade = 0;
+        int chosen[3];
         
-        // Ordenar salas por distancia
-        int sortedRooms[100];
-        float distances[100];
-        for (int j = 0; j < roomCount; j++) {
-            if (i == j) {
-                distances[j] = 999999.0f;
-                continue;
-            }
-            distances[j] = sqrt((rooms[i].x - rooms[j].x) * (rooms[i].x - rooms[j].x) + 
-                               (rooms[i].z - rooms[j].z) * (rooms[i].z - rooms[j].z));
-            sortedRooms[j] = j;
-        }
-        
-        // Ordenar por distancia (bubble sort simple)
-        for (int a = 0; a < roomCount - 1; a++) {
-            for (int b = 0; b < roomCount - 1 - a; b++) {
-                if (distances[b] > distances[b + 1]) {
-                    float tempDist = distances[b];
-                    int tempRoom = sortedRooms[b];
-                    distances[b] = distances[b + 1];
-                    sortedRooms[b] = sortedRooms[b + 1];
-                    distances[b + 1] = tempDist;
-                    sortedRooms[b + 1] = tempRoom;
-                }
-            }
-        }
-        
-        // Conectar con las salas más cercanas
-        for (int k = 0; k < roomCount && connectionsMade < connectionsNeeded; k++) {
-            int targetRoom = sortedRooms[k];
-            if (targetRoom == i) continue;
+        // Conectar con las salas más cercanas, eligiéndolas de una en una
+        // (sin ordenar todas las salas por cada sala: el mapa puede tener miles)
+        for (int k = 0; k < connectionsNeeded && corridorCount < corridorCapacity; k++) {
+            int targetRoom = nearest_unchosen_room(i, chosen, k);
+            if (targetRoom < 0) break;
+            chosen[k] = targetRoom;
             
-            if (corridorCount < 200) {
-                // Crear pasillo de conexión
-                Corridor connection;
-                connection.x1 = rooms[i].x + rooms[i].width / 2;
-                connection.z1 = rooms[i].z + rooms[i].height / 2;
-                connection.x2 = rooms[targetRoom].x + rooms[targetRoom].width / 2;
-                connection.z2 = rooms[targetRoom].z + rooms[targetRoom].height / 2;
-                connection.width = rand() % 4 + 4; // 4-7 de ancho (más anchos)
-                connection.isMain = (connectionsMade == 0); // La primera conexión es principal
-                
-                corridors[corridorCount] = connection;
-                corridorCount++;
-                connectionsMade++;
-                
-                rooms[i].connected = true;
-                rooms[targetRoom].connected = true;
-            }
+            // Crear pasillo de conexión
+            Corridor connection;
+            connection.x1 = rooms[i].x + rooms[i].width / 2;
+            connection.z1 = rooms[i].z + rooms[i].height / 2;
+            connection.x2 = rooms[targetRoom].x + rooms[targetRoom].width / 2;
+            connection.z2 = rooms[targetRoom].z + rooms[targetRoom].height / 2;
+            connection.width = rand() % 4 + 4; // 4-7 de ancho (más anchos)
+            connection.isMain = (k == 0); // La primera conexión es principal
+            
+            corridors[corridorCount] = connection;
+            corridorCount++;
+            
+            rooms[i].connected = true;
+            rooms[targetRoom].connected = true;
         }
     }
     
@@ -885,12 +1159,13 @@ void connect_rooms_with_corridors() {
 
 void place_standalone_columns() {
     // Colocar columnas sueltas de diferentes tamaños
-    for (int i = 0; i < 100; i++) {
-        if (columnCount >= 150) break;
+    int standalone = scale_to_area(100);
+    for (int i = 0; i < standalone; i++) {
+        if (columnCount >= columnCapacity) break;
         
         Column newColumn;
-        newColumn.x = rand() % (MAZE_WIDTH - 10) + 5;
-        newColumn.z = rand() % (MAZE_HEIGHT - 10) + 5;
+        newColumn.x = rand() % (maze_width - 10) + 5;
+        newColumn.z = rand() % (maze_height - 10) + 5;
         newColumn.size = rand() % 3 + 1; // 1-3 de tamaño
         newColumn.type = rand() % 3; // 0 = columna, 1 = pilar, 2 = obstáculo
         
@@ -917,10 +1192,10 @@ void apply_structures_to_maze() {
 }
 
 void apply_room_to_maze(Room room) {
-    for (int x = room.x; x < room.x + room.width && x < MAZE_WIDTH; x++) {
-        for (int z = room.z; z < room.z + room.height && z < MAZE_HEIGHT; z++) {
+    for (int x = room.x; x < room.x + room.width && x < maze_width; x++) {
+        for (int z = room.z; z < room.z + room.height && z < maze_height; z++) {
             if (x >= 0 && z >= 0) {
-                maze[x][z] = 0; // Espacio libre
+                set_maze_cell(x, z, 0); // Espacio libre
             }
         }
     }
@@ -944,8 +1219,8 @@ void apply_corridor_to_maze(Corridor corridor) {
                 int px = x + w - corridor.width / 2;
                 int pz = z + h - corridor.width / 2;
                 
-                if (px >= 0 && px < MAZE_WIDTH && pz >= 0 && pz < MAZE_HEIGHT) {
-                    maze[px][pz] = 0; // Espacio libre
+                if (px >= 0 && px < maze_width && pz >= 0 && pz < maze_height) {
+                    set_maze_cell(px, pz, 0); // Espacio libre
                 }
             }
         }
@@ -954,14 +1229,14 @@ void apply_corridor_to_maze(Corridor corridor) {
 
 void apply_column_to_maze(Column column) {
     // Solo colocar columnas en espacios abiertos
-    if (maze[column.x][column.z] == 0) {
+    if (maze_cell(column.x, column.z) == 0) {
         for (int dx = 0; dx < column.size; dx++) {
             for (int dz = 0; dz < column.size; dz++) {
                 int px = column.x + dx;
                 int pz = column.z + dz;
                 
-                if (px < MAZE_WIDTH && pz < MAZE_HEIGHT) {
-                    maze[px][pz] = 1; // Columna (pared)
+                if (px < maze_width && pz < maze_height) {
+                    set_maze_cell(px, pz, 1); // Columna (pared)
                 }
             }
         }
@@ -970,15 +1245,16 @@ void apply_column_to_maze(Column column) {
 
 void create_additional_connectivity() {
     // Crear pasillos adicionales para garantizar múltiples caminos
-    for (int i = 0; i < 20; i++) {
-        if (corridorCount >= 200) break;
+    int additional_corridors = scale_to_area(20);
+    for (int i = 0; i < additional_corridors; i++) {
+        if (corridorCount >= corridorCapacity) break;
         
         // Crear pasillos aleatorios que conecten áreas distantes
         Corridor additional;
-        additional.x1 = rand() % (MAZE_WIDTH - 20) + 10;
-        additional.z1 = rand() % (MAZE_HEIGHT - 20) + 10;
-        additional.x2 = rand() % (MAZE_WIDTH - 20) + 10;
-        additional.z2 = rand() % (MAZE_HEIGHT - 20) + 10;
+        additional.x1 = rand() % (maze_width - 20) + 10;
+        additional.z1 = rand() % (maze_height - 20) + 10;
+        additional.x2 = rand() % (maze_width - 20) + 10;
+        additional.z2 = rand() % (maze_height - 20) + 10;
         additional.width = rand() % 5 + 3; // 3-7 de ancho
         additional.isMain = false;
         
@@ -987,12 +1263,12 @@ void create_additional_connectivity() {
     }
     
     // Crear pasillos de respaldo que conecten el centro con los bordes
-    int centerX = MAZE_WIDTH / 2;
-    int centerZ = MAZE_HEIGHT / 2;
+    int centerX = maze_width / 2;
+    int centerZ = maze_height / 2;
     
     // Conectar centro con cada borde
     for (int side = 0; side < 4; side++) {
-        if (corridorCount >= 200) break;
+        if (corridorCount >= corridorCapacity) break;
         
         Corridor backup;
         backup.x1 = centerX;
@@ -1002,20 +1278,20 @@ void create_additional_connectivity() {
         
         switch (side) {
             case 0: // Norte
-                backup.x2 = rand() % (MAZE_WIDTH - 10) + 5;
+                backup.x2 = rand() % (maze_width - 10) + 5;
                 backup.z2 = 5;
                 break;
             case 1: // Sur
-                backup.x2 = rand() % (MAZE_WIDTH - 10) + 5;
-                backup.z2 = MAZE_HEIGHT - 5;
+                backup.x2 = rand() % (maze_width - 10) + 5;
+                backup.z2 = maze_height - 5;
                 break;
             case 2: // Este
-                backup.x2 = MAZE_WIDTH - 5;
-                backup.z2 = rand() % (MAZE_HEIGHT - 10) + 5;
+                backup.x2 = maze_width - 5;
+                backup.z2 = rand() % (maze_height - 10) + 5;
                 break;
             case 3: // Oeste
                 backup.x2 = 5;
-                backup.z2 = rand() % (MAZE_HEIGHT - 10) + 5;
+                backup.z2 = rand() % (maze_height - 10) + 5;
                 break;
         }
         
@@ -1028,26 +1304,27 @@ void create_additional_connectivity() {
 
 void generate_light_points() {
     // Colocar luces en salas grandes
-    for (int i = 0; i < roomCount && lightCount < 50; i++) {
+    for (int i = 0; i < roomCount && lightCount < lightCapacity; i++) {
         if (rooms[i].width > 20 && rooms[i].height > 20) { // Solo en salas muy grandes
             place_light_in_room(rooms[i]);
         }
     }
     
     // Colocar luces en pasillos principales
-    for (int i = 0; i < corridorCount && lightCount < 50; i++) {
+    for (int i = 0; i < corridorCount && lightCount < lightCapacity; i++) {
         if (corridors[i].isMain && corridors[i].width > 5) { // Solo en pasillos principales anchos
             place_light_in_corridor(corridors[i]);
         }
     }
     
     // Colocar luces aleatorias en espacios abiertos
-    for (int i = 0; i < 15 && lightCount < 50; i++) {
-        int x = rand() % (MAZE_WIDTH - 10) + 5;
-        int z = rand() % (MAZE_HEIGHT - 10) + 5;
+    int random_lights = scale_to_area(15);
+    for (int i = 0; i < random_lights && lightCount < lightCapacity; i++) {
+        int x = rand() % (maze_width - 10) + 5;
+        int z = rand() % (maze_height - 10) + 5;
         
         // Solo en espacios abiertos
-        if (maze[x][z] == 0) {
+        if (maze_cell(x, z) == 0) {
             LightPoint newLight;
             newLight.x = (float)x + 0.5f;
             newLight.z = (float)z + 0.5f;
@@ -1076,12 +1353,12 @@ void generate_light_points() {
 }
 
 void place_light_in_room(Room room) {
-    if (lightCount >= 50) return;
+    if (lightCount >= lightCapacity) return;
     
     // Colocar 1-2 luces por sala grande
     int lightsInRoom = 1 + (rand() % 2); // 1-2 luces
     
-    for (int i = 0; i < lightsInRoom && lightCount < 50; i++) {
+    for (int i = 0; i < lightsInRoom && lightCount < lightCapacity; i++) {
         LightPoint newLight;
         
         // Posición aleatoria dentro de la sala
@@ -1106,7 +1383,7 @@ void place_light_in_room(Room room) {
 }
 
 void place_light_in_corridor(Corridor corridor) {
-    if (lightCount >= 50) return;
+    if (lightCount >= lightCapacity) return;
     
     // Colocar luces a lo largo del pasillo
     int dx = abs(corridor.x2 - corridor.x1);
@@ -1118,7 +1395,7 @@ void place_light_in_corridor(Corridor corridor) {
     // Colocar 2-4 luces a lo largo del pasillo
     int lightsInCorridor = 2 + (rand() % 3); // 2-4 luces
     
-    for (int i = 0; i < lightsInCorridor && lightCount < 50; i++) {
+    for (int i = 0; i < lightsInCorridor && lightCount < lightCapacity; i++) {
         LightPoint newLight;
         
         // Posición a lo largo del pasillo
@@ -1140,6 +1417,9 @@ void place_light_in_corridor(Corridor corridor) {
 
 void cleanup_map() {
     // Limpiar recursos del mapa (si los hay)
+    cleanup_pvs();
+    cleanup_light_visibility();
+    free_map_storage();
     exit_side = -1;
     exit_pos = -1;
     roomCount = 0;
@@ -3,15 +3,24 @@
 #define MAP_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
-// Constantes del mapa - REDUCIDAS PARA MEJOR RENDIMIENTO
-#define MAZE_WIDTH 100
-#define MAZE_HEIGHT 100
+// Tamaño del mapa: se elige en tiempo de ejecución (set_map_size) antes de generar
+#define MAP_DEFAULT_SIZE 100
+#define MAP_MIN_SIZE 64          // La generación necesita márgenes de ~30 celdas
+#define MAP_MAX_SIZE 4096
+#define MAP_REFERENCE_CELLS (100 * 100)  // Área para la que se ajustaron las cantidades de la generación
 #define MAZE_LEVELS 15  // Número de niveles de altura (reducido para mejor rendimiento)
+#define CEILING_HEIGHT (MAZE_LEVELS + 2.0f)  // Techo por encima de los muros
 
 // Sistema de renderizado optimizado
 #define RENDER_DISTANCE 30.0f    // Distancia de renderizado en unidades
 
+// Simulación a paso fijo: temporizadores y velocidades del juego cuentan ticks
+#define SIMULATION_TICK_RATE 60                                 // Ticks por segundo
+#define SIMULATION_TICK_SECONDS (1.0f / SIMULATION_TICK_RATE)
+#define SIMULATION_MAX_TICKS_PER_FRAME 5                        // Tope para no encadenar retrasos
+
 // Estructuras de datos avanzadas para mapas más realistas
 typedef struct {
     int x, z;
@@ -40,30 +49,160 @@ typedef struct {
     int type; // 0 = luz tenue, 1 = luz normal, 2 = luz brillante
 } LightPoint;
 
-// Variables globales del mapa
-extern int maze[MAZE_WIDTH][MAZE_HEIGHT];
-extern Room rooms[100]; // Hasta 100 salas
-extern Corridor corridors[200]; // Hasta 200 pasillos
-extern Column columns[150]; // Hasta 150 columnas
-extern LightPoint lightPoints[50]; // Hasta 50 puntos de luz
+// Luces del mapa: altura a la que cuelgan y color cálido de los fluorescentes
+#define LIGHT_POINT_HEIGHT 3.0f
+#define LIGHT_POINT_RED 1.0f
+#define LIGHT_POINT_GREEN 0.95f
+#define LIGHT_POINT_BLUE 0.75f
+
+// Celda de un byte: tipo en los dos bits bajos (0 = libre, 1 = muro, 2 = decoración)
+// y banderas en el resto
+#define CELL_WALL 0x01
+#define CELL_DECOR 0x02
+#define CELL_TYPE_MASK (CELL_WALL | CELL_DECOR)
+#define CELL_LIGHT 0x04         // Hay un punto de luz en la celda
+#define CELL_TRIGGER 0x08       // Celda de salida
+#define CELL_EXPLORED 0x10      // El jugador ha pasado por la celda
+
+// Disposición de la rejilla en memoria (se elige antes de generar)
+typedef enum {
+    MAP_LAYOUT_LINEAR,      // Columnas x contiguas: celda (x, z) en x * maze_height + z
+    MAP_LAYOUT_TILED        // Bloques de 8x8 celdas (64 bytes, una línea de caché) en orden de columnas
+} MapLayout;
+
+#define MAP_TILE_SHIFT 3
+#define MAP_TILE_SIZE (1 << MAP_TILE_SHIFT)
+
+// Rejilla del mapa: un bloque contiguo, celda (x, z) en maze_cells[maze_index(x, z)]
+extern int maze_width;
+extern int maze_height;
+extern unsigned char* maze_cells;
+extern MapLayout map_layout;
+extern int map_tiles_z;         // Bloques por columna de bloques en la disposición en bloques
+
+// Posición de la celda en una rejilla en bloques de tiles_z bloques por columna;
+// dentro de un bloque z sigue siendo el eje rápido
+static inline int tiled_index(int tiles_z, int x, int z) {
+    int tile = (x >> MAP_TILE_SHIFT) * tiles_z + (z >> MAP_TILE_SHIFT);
+    return (tile << (2 * MAP_TILE_SHIFT)) | ((x & (MAP_TILE_SIZE - 1)) << MAP_TILE_SHIFT) |
+           (z & (MAP_TILE_SIZE - 1));
+}
+
+// Posición de la celda en maze_cells
+static inline int maze_index(int x, int z) {
+    if (map_layout == MAP_LAYOUT_TILED) return tiled_index(map_tiles_z, x, z);
+    return x * maze_height + z;
+}
+
+// Lo mismo para cualquier rejilla de height celdas por columna (connectivity.c)
+static inline int grid_index(MapLayout layout, int height, int x, int z) {
+    if (layout == MAP_LAYOUT_TILED) return tiled_index((height + MAP_TILE_SIZE - 1) >> MAP_TILE_SHIFT, x, z);
+    return x * height + z;
+}
+
+// Celdas que ocupa una rejilla (en bloques se redondea a bloques completos)
+static inline int grid_storage_cells(MapLayout layout, int width, int height) {
+    if (layout == MAP_LAYOUT_TILED) {
+        int tiles_x = (width + MAP_TILE_SIZE - 1) >> MAP_TILE_SHIFT;
+        int tiles_z = (height + MAP_TILE_SIZE - 1) >> MAP_TILE_SHIFT;
+        return tiles_x * tiles_z * MAP_TILE_SIZE * MAP_TILE_SIZE;
+    }
+    return width * height;
+}
+
+// Plano de bits de muros: la columna x ocupa wall_bits_stride palabras desde
+// wall_bits[x * wall_bits_stride] y la celda z es el bit z % 64 de la palabra z / 64.
+// Los bits sobrantes de la última palabra valen 1 (fuera del mapa cuenta como muro)
+extern uint64_t* wall_bits;
+extern int wall_bits_stride;
+
+// Estructuras generadas; la capacidad de cada array crece con el área del mapa
+extern Room* rooms;
+extern Corridor* corridors;
+extern Column* columns;
+extern LightPoint* lightPoints;
 extern int roomCount;
 extern int corridorCount;
 extern int columnCount;
 extern int lightCount;
+extern int roomCapacity;
+extern int corridorCapacity;
+extern int columnCapacity;
+extern int lightCapacity;
+
+// Acceso a la rejilla sin comprobar límites (las coordenadas deben estar dentro).
+// maze_cell devuelve el tipo; set_maze_cell conserva las banderas. Solo la generación
+// cambia tipos y generate_map reconstruye el plano de bits al terminar
+static inline int maze_cell(int x, int z) {
+    return maze_cells[maze_index(x, z)] & CELL_TYPE_MASK;
+}
+
+static inline void set_maze_cell(int x, int z, int value) {
+    unsigned char* cell = &maze_cells[maze_index(x, z)];
+    *cell = (unsigned char)((*cell & ~CELL_TYPE_MASK) | value);
+}
+
+static inline bool maze_wall_bit(int x, int z) {
+    return (wall_bits[x * wall_bits_stride + (z >> 6)] >> (z & 63)) & 1;
+}
+
+static inline unsigned char maze_flags(int x, int z) {
+    return maze_cells[maze_index(x, z)];
+}
+
+// Solo banderas: el tipo de celda se cambia con set_maze_cell
+static inline void set_maze_flag(int x, int z, unsigned char flag) {
+    maze_cells[maze_index(x, z)] |= flag;
+}
+
+static inline bool maze_in_bounds(int x, int z) {
+    return x >= 0 && x < maze_width && z >= 0 && z < maze_height;
+}
 
 // Variables de renderizado optimizado
 extern bool map_preloaded;
 extern bool map_generation_complete;
 
+// Semilla de generación (fija para benchmarks reproducibles)
+extern unsigned int map_seed;
+extern bool map_verbose;        // Mensajes de generación y horneado (se silencian al regenerar)
+
 // Funciones del mapa
 void init_map();
+void set_map_seed(unsigned int seed);
+bool set_map_size(int width, int height);   // Antes de generar; false si está fuera de rango
+void set_map_layout(MapLayout layout);      // Antes de generar
 void generate_map();
+void commit_map_cells();                    // Tras escribir maze_cells y lightPoints a mano
 bool is_wall(int x, int z);
 void cleanup_map();
 
+// Operaciones sobre el plano de muros de 64 celdas en 64 celdas
+uint64_t maze_wall_word(int x, int word);                       // Columnas fuera del mapa: todo muro
+uint64_t maze_exposed_walls(int x, int word, int dx, int dz);   // Muros con la vecina (x + dx, z + dz) abierta
+long count_maze_walls();
+
+// Etapas de la generación, en orden (el hilo generador publica la actual)
+typedef enum {
+    MAP_STAGE_IDLE,
+    MAP_STAGE_ROOMS,
+    MAP_STAGE_CORRIDORS,
+    MAP_STAGE_COLUMNS,
+    MAP_STAGE_LIGHTS,
+    MAP_STAGE_CONNECTIVITY,
+    MAP_STAGE_VISIBILITY,       // Horneado del PVS
+    MAP_STAGE_READY,
+    MAP_STAGE_COUNT
+} MapStage;
+
 // Sistema de precarga
-void preload_map();
+void preload_map();                 // Síncrona, en el hilo que llama
+void start_map_generation();        // Asíncrona, en un hilo de fondo
+void finish_map_generation();       // Espera al hilo de fondo (inmediato si ya está listo)
 bool is_map_ready();
+MapStage map_generation_stage();
+float map_generation_progress();    // 0..1 según el peso de cada etapa
+const char* map_stage_name(MapStage stage);
 void show_loading_progress();
 
 // Sistema de renderizado optimizado
@@ -83,7 +222,6 @@ void add_decorative_elements();
 void create_guaranteed_path_to_exit();
 void ensure_connectivity();
 bool is_connected_to_exit(int startX, int startZ);
-void flood_fill_connectivity(int x, int z, bool visited[MAZE_WIDTH][MAZE_HEIGHT]);
 
 // Funciones de generación avanzada con estructuras de datos mejoradas
 void generate_advanced_backrooms();
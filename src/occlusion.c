@@ -0,0 +1,177 @@
+// occlusion.c - Oclusión por raycasting 2D (DDA) sobre la rejilla del laberinto
+#include "occlusion.h"
+#include "thread_pool.h"
+#include "frustum.h"
+#include "wall_mesh.h"
+#include "map.h"
+#include "player.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+bool occlusion_enabled = true;
+OcclusionStats occlusion_stats = {0};
+
+// Celdas marcadas como visibles en este frame
+static unsigned char* cell_visible = NULL;
+static unsigned char* chunk_visible = NULL;
+static int chunk_cols = 0;
+static int chunk_rows = 0;
+static bool occlusion_valid = false;
+
+// Cuadrado de celdas que pudo marcar el último frame: es lo único que hay que borrar
+static int marked_x0 = 0, marked_x1 = -1;
+static int marked_z0 = 0, marked_z1 = -1;
+
+// Parámetros compartidos por las tareas de un frame
+typedef struct {
+    float origin_x, origin_z;   // Origen en coordenadas de rejilla
+    float start_angle;
+    float angle_step;
+    int ray_count;
+    float max_distance;
+} RayBundleJob;
+
+void init_occlusion() {
+    cleanup_occlusion();
+    cell_visible = (unsigned char*)calloc((size_t)maze_width * maze_height, 1);
+    chunk_cols = (maze_width + WALL_CHUNK_SIZE - 1) / WALL_CHUNK_SIZE;
+    chunk_rows = (maze_height + WALL_CHUNK_SIZE - 1) / WALL_CHUNK_SIZE;
+    chunk_visible = (unsigned char*)calloc((size_t)chunk_cols * chunk_rows, 1);
+    marked_x0 = marked_z0 = 0;
+    marked_x1 = marked_z1 = -1;
+}
+
+// Recorrido DDA de un rayo: marca celdas hasta chocar con un muro
+static void cast_ray(const RayBundleJob* job, float angle) {
+    // Misma convención que la cámara: yaw = 0 mira hacia Z negativo
+    float dir_x = -sinf(angle);
+    float dir_z = -cosf(angle);
+
+    int cell_x = (int)floorf(job->origin_x);
+    int cell_z = (int)floorf(job->origin_z);
+    int step_x = dir_x >= 0.0f ? 1 : -1;
+    int step_z = dir_z >= 0.0f ? 1 : -1;
+
+    float delta_x = dir_x != 0.0f ? fabsf(1.0f / dir_x) : 1e30f;
+    float delta_z = dir_z != 0.0f ? fabsf(1.0f / dir_z) : 1e30f;
+    float side_x = dir_x >= 0.0f ? (cell_x + 1.0f - job->origin_x) * delta_x
+                                 : (job->origin_x - cell_x) * delta_x;
+    float side_z = dir_z >= 0.0f ? (cell_z + 1.0f - job->origin_z) * delta_z
+                                 : (job->origin_z - cell_z) * delta_z;
+
+    float travelled = 0.0f;
+    while (travelled <= job->max_distance) {
+        if (cell_x < 0 || cell_x >= maze_width || cell_z < 0 || cell_z >= maze_height) return;
+
+        // Varios hilos pueden marcar la misma celda: escritura atómica relajada
+        __atomic_store_n(&cell_visible[cell_x * maze_height + cell_z], 1, __ATOMIC_RELAXED);
+        if (maze_cell(cell_x, cell_z) == 1) return;
+
+        if (side_x < side_z) {
+            travelled = side_x;
+            side_x += delta_x;
+            cell_x += step_x;
+        } else {
+            travelled = side_z;
+            side_z += delta_z;
+            cell_z += step_z;
+        }
+    }
+}
+
+static void ray_bundle_task(void* data, int index) {
+    const RayBundleJob* job = (const RayBundleJob*)data;
+    int first = index * OCCLUSION_RAYS_PER_BUNDLE;
+    int last = first + OCCLUSION_RAYS_PER_BUNDLE;
+    if (last > job->ray_count) last = job->ray_count;
+
+    for (int i = first; i < last; i++) {
+        cast_ray(job, job->start_angle + i * job->angle_step);
+    }
+}
+
+void occlusion_update(float max_distance) {
+    occlusion_valid = false;
+    if (!occlusion_enabled || !cell_visible) return;
+
+    // Borrar solo las marcas del frame anterior (columnas contiguas en z)
+    for (int x = marked_x0; x <= marked_x1; x++) {
+        memset(&cell_visible[(size_t)x * maze_height + marked_z0], 0, (size_t)(marked_z1 - marked_z0 + 1));
+    }
+    memset(chunk_visible, 0, (size_t)chunk_cols * chunk_rows);
+
+    // Cada celda ocupa [x - 0.5, x + 0.5]: desplazar para que el DDA use celdas enteras
+    RayBundleJob job;
+    job.origin_x = player.x + 0.5f;
+    job.origin_z = player.z + 0.5f;
+    job.max_distance = max_distance;
+
+    // Un rayo se detiene pasada max_distance y marca como mucho una celda más allá
+    int reach = (int)ceilf(max_distance) + 2;
+    int origin_cell_x = (int)floorf(job.origin_x);
+    int origin_cell_z = (int)floorf(job.origin_z);
+    marked_x0 = origin_cell_x - reach < 0 ? 0 : origin_cell_x - reach;
+    marked_z0 = origin_cell_z - reach < 0 ? 0 : origin_cell_z - reach;
+    marked_x1 = origin_cell_x + reach >= maze_width ? maze_width - 1 : origin_cell_x + reach;
+    marked_z1 = origin_cell_z + reach >= maze_height ? maze_height - 1 : origin_cell_z + reach;
+
+    // Abanico horizontal del frustum; con pitch pronunciado la huella cubre todo alrededor
+    float half_fov = frustum_half_fov_x + OCCLUSION_FOV_MARGIN;
+    if (fabsf(player.pitch) > (float)M_PI / 4.0f || half_fov >= (float)M_PI) {
+        half_fov = (float)M_PI;
+    }
+    job.angle_step = OCCLUSION_RAY_SPACING / max_distance;
+    job.ray_count = (int)ceilf(2.0f * half_fov / job.angle_step) + 1;
+    job.start_angle = player.yaw - half_fov;
+
+    int bundles = (job.ray_count + OCCLUSION_RAYS_PER_BUNDLE - 1) / OCCLUSION_RAYS_PER_BUNDLE;
+    thread_pool_run(ray_bundle_task, &job, bundles);
+
+    // Contar celdas visibles frente al test de radio anterior y marcar chunks
+    occlusion_stats.rays = job.ray_count;
+    occlusion_stats.visible_cells = 0;
+    occlusion_stats.radius_cells = 0;
+
+    float max_distance_sq = max_distance * max_distance;
+    for (int x = marked_x0; x <= marked_x1; x++) {
+        for (int z = marked_z0; z <= marked_z1; z++) {
+            // Cualquier celda alcanzada hace visible su chunk: también las abiertas,
+            // porque el suelo y el techo van en la malla del chunk
+            bool visible = cell_visible[x * maze_height + z] != 0;
+            if (visible) chunk_visible[(z / WALL_CHUNK_SIZE) * chunk_cols + x / WALL_CHUNK_SIZE] = 1;
+            if (maze_cell(x, z) == 0) continue;
+            float dx = x - player.x;
+            float dz = z - player.z;
+            if (dx * dx + dz * dz <= max_distance_sq) occlusion_stats.radius_cells++;
+            if (visible) occlusion_stats.visible_cells++;
+        }
+    }
+
+    occlusion_valid = true;
+}
+
+bool occlusion_cell_visible(int x, int z) {
+    if (!occlusion_valid) return true;
+    if (x < 0 || x >= maze_width || z < 0 || z >= maze_height) return false;
+    return cell_visible[x * maze_height + z] != 0;
+}
+
+bool occlusion_chunk_visible(int chunk_x, int chunk_z) {
+    if (!occlusion_valid) return true;
+    if (chunk_x < 0 || chunk_x >= chunk_cols || chunk_z < 0 || chunk_z >= chunk_rows) return false;
+    return chunk_visible[chunk_z * chunk_cols + chunk_x] != 0;
+}
+
+void cleanup_occlusion() {
+    free(cell_visible);
+    free(chunk_visible);
+    cell_visible = NULL;
+    chunk_visible = NULL;
+    occlusion_valid = false;
+}
@@ -0,0 +1,29 @@
+// occlusion.h - Oclusión por raycasting 2D (DDA) sobre la rejilla del laberinto
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+
+#include <stdbool.h>
+
+// Parámetros del raycasting
+#define OCCLUSION_RAYS_PER_BUNDLE 32     // Rayos por tarea del pool de hilos
+#define OCCLUSION_RAY_SPACING 0.25f      // Separación máxima entre rayos (en celdas) a la distancia máxima
+#define OCCLUSION_FOV_MARGIN 0.2f        // Margen angular (radianes) a cada lado del FOV
+
+// Estadísticas del último frame
+typedef struct {
+    int rays;              // Rayos lanzados
+    int visible_cells;     // Celdas con muro o decoración alcanzadas por algún rayo
+    int radius_cells;      // Celdas con muro o decoración dentro del radio (test anterior)
+} OcclusionStats;
+
+extern bool occlusion_enabled;
+extern OcclusionStats occlusion_stats;
+
+// Funciones de oclusión
+void init_occlusion();
+void occlusion_update(float max_distance);
+bool occlusion_cell_visible(int x, int z);
+bool occlusion_chunk_visible(int chunk_x, int chunk_z);
+void cleanup_occlusion();
+
+#endif // OCCLUSION_H
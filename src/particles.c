@@ -1,99 +1,276 @@
 // particles.c - Sistema simple de efectos de partículas
 #include "particles.h"
+#include "gl_ext.h"
+#include "gl_state.h"
+#include "map.h"
+#include "render.h"
 #include <math.h>
+#include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
-Particle particles[MAX_PARTICLES];
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+// Vértice del lote de partículas: posición y color empaquetado (16 bytes)
+typedef struct {
+    float x, y, z;
+    unsigned char color[4];
+} ParticleVertex;
+
+ParticlePool particles;
 int particle_count = 0;
 
+static ParticleVertex vertices[MAX_PARTICLES * 4];
+static GLuint particle_vbo = 0;
+
+// Ordenación por profundidad (claves de 16 bits e índices al pool)
+static float view_depth[MAX_PARTICLES];
+static unsigned short sort_keys[MAX_PARTICLES];
+static unsigned short sort_keys_scratch[MAX_PARTICLES];
+static int sort_order[MAX_PARTICLES];
+static int sort_order_scratch[MAX_PARTICLES];
+
 void init_particles() {
     particle_count = 0;
-    for (int i = 0; i < MAX_PARTICLES; i++) {
-        particles[i].life = 0.0f;
+    if (gl_has_vbo && !particle_vbo) {
+        glGenBuffers(1, &particle_vbo);
     }
 }
 
+// Integra de 4 en 4 con SSE; el resto (o todo sin SSE) va por la ruta escalar
+static void integrate_particles() {
+    int i = 0;
+#if defined(__SSE__)
+    const __m128 gravity = _mm_set1_ps(PARTICLE_GRAVITY);
+    const __m128 tick = _mm_set1_ps(SIMULATION_TICK_SECONDS);
+    const __m128 size_decay = _mm_set1_ps(PARTICLE_SIZE_DECAY);
+    const __m128 alpha_decay = _mm_set1_ps(PARTICLE_ALPHA_DECAY);
+    for (; i + 4 <= particle_count; i += 4) {
+        __m128 vy = _mm_loadu_ps(particles.vy + i);
+        __m128 x = _mm_loadu_ps(particles.x + i);
+        __m128 y = _mm_loadu_ps(particles.y + i);
+        __m128 z = _mm_loadu_ps(particles.z + i);
+        _mm_storeu_ps(particles.previous_x + i, x);
+        _mm_storeu_ps(particles.previous_y + i, y);
+        _mm_storeu_ps(particles.previous_z + i, z);
+        _mm_storeu_ps(particles.x + i, _mm_add_ps(x, _mm_loadu_ps(particles.vx + i)));
+        _mm_storeu_ps(particles.y + i, _mm_add_ps(y, vy));
+        _mm_storeu_ps(particles.z + i, _mm_add_ps(z, _mm_loadu_ps(particles.vz + i)));
+        _mm_storeu_ps(particles.vy + i, _mm_sub_ps(vy, gravity));
+        _mm_storeu_ps(particles.life + i, _mm_sub_ps(_mm_loadu_ps(particles.life + i), tick));
+        _mm_storeu_ps(particles.size + i, _mm_mul_ps(_mm_loadu_ps(particles.size + i), size_decay));
+        _mm_storeu_ps(particles.alpha + i, _mm_mul_ps(_mm_loadu_ps(particles.alpha + i), alpha_decay));
+    }
+#endif
+    for (; i < particle_count; i++) {
+        particles.previous_x[i] = particles.x[i];
+        particles.previous_y[i] = particles.y[i];
+        particles.previous_z[i] = particles.z[i];
+        particles.x[i] += particles.vx[i];
+        particles.y[i] += particles.vy[i];
+        particles.z[i] += particles.vz[i];
+        particles.vy[i] -= PARTICLE_GRAVITY;
+        particles.life[i] -= SIMULATION_TICK_SECONDS; // Un tick de simulación
+        particles.size[i] *= PARTICLE_SIZE_DECAY;
+        particles.alpha[i] *= PARTICLE_ALPHA_DECAY;
+    }
+}
+
+// Mueve la partícula 'from' al hueco 'to' (todos los arrays)
+static void move_particle(int to, int from) {
+    particles.x[to] = particles.x[from];
+    particles.y[to] = particles.y[from];
+    particles.z[to] = particles.z[from];
+    particles.previous_x[to] = particles.previous_x[from];
+    particles.previous_y[to] = particles.previous_y[from];
+    particles.previous_z[to] = particles.previous_z[from];
+    particles.vx[to] = particles.vx[from];
+    particles.vy[to] = particles.vy[from];
+    particles.vz[to] = particles.vz[from];
+    particles.life[to] = particles.life[from];
+    particles.size[to] = particles.size[from];
+    particles.alpha[to] = particles.alpha[from];
+    memcpy(particles.color[to], particles.color[from], 3);
+}
+
 void update_particles() {
-    for (int i = 0; i < MAX_PARTICLES; i++) {
-        if (particles[i].life > 0.0f) {
-            // Actualizar posición
-            particles[i].x += particles[i].vx;
-            particles[i].y += particles[i].vy;
-            particles[i].z += particles[i].vz;
-            
-            // Aplicar gravedad
-            particles[i].vy -= 0.01f;
-            
-            // Reducir vida
-            particles[i].life -= 0.016f; // Aproximadamente 60 FPS
-            
-            // Reducir tamaño
-            particles[i].size *= 0.99f;
-            
-            // Reducir alpha
-            particles[i].a *= 0.98f;
-            
-            // Si la partícula muere, marcar para reutilización
-            if (particles[i].life <= 0.0f) {
-                particles[i].life = 0.0f;
-            }
+    integrate_particles();
+
+    // Eliminar las muertas moviendo la última a su hueco. Se recorre hacia atrás:
+    // la que llega desde el final ya se comprobó y está viva
+    for (int i = particle_count - 1; i >= 0; i--) {
+        if (particles.life[i] <= 0.0f) {
+            particle_count--;
+            if (i != particle_count) move_particle(i, particle_count);
         }
     }
 }
 
-void render_particles() {
-    glDisable(GL_LIGHTING);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    
-    for (int i = 0; i < MAX_PARTICLES; i++) {
-        if (particles[i].life > 0.0f) {
-            glPushMatrix();
-            glTranslatef(particles[i].x, particles[i].y, particles[i].z);
-            
-            glColor4f(particles[i].r, particles[i].g, particles[i].b, particles[i].a);
-            
-            // Dibujar partícula como un pequeño cuadrado
-            float size = particles[i].size;
-            glBegin(GL_QUADS);
-            glVertex3f(-size, -size, 0);
-            glVertex3f(size, -size, 0);
-            glVertex3f(size, size, 0);
-            glVertex3f(-size, size, 0);
-            glEnd();
-            
-            glPopMatrix();
-        }
+// Posición de dibujo: interpolada entre los dos últimos ticks con render_alpha
+static inline void interpolated_position(int i, float* x, float* y, float* z) {
+    *x = particles.previous_x[i] + (particles.x[i] - particles.previous_x[i]) * render_alpha;
+    *y = particles.previous_y[i] + (particles.y[i] - particles.previous_y[i]) * render_alpha;
+    *z = particles.previous_z[i] + (particles.z[i] - particles.previous_z[i]) * render_alpha;
+}
+
+// Profundidad de vista de las partículas delante de la cámara, cuantizada a 16 bits
+// e invertida para que el orden ascendente de la clave sea de atrás hacia delante
+static int compute_sort_keys() {
+    const float* eye = camera_basis.eye;
+    const float* forward = camera_basis.forward;
+    int visible = 0;
+    float max_depth = 0.0f;
+
+    for (int i = 0; i < particle_count; i++) {
+        float x, y, z;
+        interpolated_position(i, &x, &y, &z);
+        float depth = (x - eye[0]) * forward[0] +
+                      (y - eye[1]) * forward[1] +
+                      (z - eye[2]) * forward[2];
+        if (depth < PARTICLE_NEAR_DEPTH) continue;  // Detrás de la cámara
+        view_depth[visible] = depth;
+        sort_order[visible] = i;
+        if (depth > max_depth) max_depth = depth;
+        visible++;
     }
-    
-    glDisable(GL_BLEND);
-    glEnable(GL_LIGHTING);
+
+    float scale = max_depth > 0.0f ? 65535.0f / max_depth : 0.0f;
+    for (int i = 0; i < visible; i++) {
+        sort_keys[i] = 65535u - (unsigned short)(view_depth[i] * scale);
+    }
+    return visible;
 }
 
-void add_particle(float x, float y, float z, float vx, float vy, float vz) {
-    // Buscar una partícula libre
-    for (int i = 0; i < MAX_PARTICLES; i++) {
-        if (particles[i].life <= 0.0f) {
-            particles[i].x = x;
-            particles[i].y = y;
-            particles[i].z = z;
-            particles[i].vx = vx;
-            particles[i].vy = vy;
-            particles[i].vz = vz;
-            particles[i].life = 1.0f;
-            particles[i].size = 0.1f + (rand() % 10) / 100.0f;
-            particles[i].r = 0.8f + (rand() % 20) / 100.0f;
-            particles[i].g = 0.6f + (rand() % 20) / 100.0f;
-            particles[i].b = 0.2f + (rand() % 20) / 100.0f;
-            particles[i].a = 1.0f;
-            break;
+// Radix sort LSD de 2 pasadas de 8 bits (estable) sobre las claves y los índices
+static void radix_sort_keys(int count) {
+    unsigned short* keys = sort_keys;
+    unsigned short* keys_out = sort_keys_scratch;
+    int* order = sort_order;
+    int* order_out = sort_order_scratch;
+
+    for (int shift = 0; shift < 16; shift += 8) {
+        int offsets[256] = {0};
+        for (int i = 0; i < count; i++) offsets[(keys[i] >> shift) & 0xFF]++;
+        int total = 0;
+        for (int b = 0; b < 256; b++) {
+            int bucket = offsets[b];
+            offsets[b] = total;
+            total += bucket;
         }
+        for (int i = 0; i < count; i++) {
+            int slot = offsets[(keys[i] >> shift) & 0xFF]++;
+            keys_out[slot] = keys[i];
+            order_out[slot] = order[i];
+        }
+
+        unsigned short* keys_swap = keys; keys = keys_out; keys_out = keys_swap;
+        int* order_swap = order; order = order_out; order_out = order_swap;
     }
+    // Con un número par de pasadas el resultado queda en sort_keys / sort_order
+}
+
+int sort_particles_back_to_front() {
+    int visible = compute_sort_keys();
+    radix_sort_keys(visible);
+    return visible;
+}
+
+void upload_particle_batch(int visible) {
+    // Cuadrados orientados a la cámara: esquinas en p +/- (derecha +/- arriba) * tamaño
+    const float* right = camera_basis.right;
+    const float* up = camera_basis.up;
+    float diagonal_a[3] = {right[0] + up[0], right[1] + up[1], right[2] + up[2]};
+    float diagonal_b[3] = {right[0] - up[0], right[1] - up[1], right[2] - up[2]};
+
+    for (int n = 0; n < visible; n++) {
+        int i = sort_order[n];
+        float x, y, z;
+        interpolated_position(i, &x, &y, &z);
+        float size = particles.size[i];
+        float ax = diagonal_a[0] * size, ay = diagonal_a[1] * size, az = diagonal_a[2] * size;
+        float bx = diagonal_b[0] * size, by = diagonal_b[1] * size, bz = diagonal_b[2] * size;
+        ParticleVertex* quad = &vertices[n * 4];
+        unsigned char color[4] = {particles.color[i][0], particles.color[i][1], particles.color[i][2],
+                                  (unsigned char)(particles.alpha[i] * 255.0f + 0.5f)};
+
+        quad[0].x = x - ax; quad[0].y = y - ay; quad[0].z = z - az;
+        quad[1].x = x + bx; quad[1].y = y + by; quad[1].z = z + bz;
+        quad[2].x = x + ax; quad[2].y = y + ay; quad[2].z = z + az;
+        quad[3].x = x - bx; quad[3].y = y - by; quad[3].z = z - bz;
+        for (int v = 0; v < 4; v++) memcpy(quad[v].color, color, 4);
+    }
+
+    if (particle_vbo) {
+        // Se reserva de nuevo en cada frame para no esperar al anterior
+        glBindBuffer(GL_ARRAY_BUFFER, particle_vbo);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(sizeof(ParticleVertex) * visible * 4), vertices, GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+}
+
+void render_particles() {
+    if (particle_count == 0) return;
+
+    int visible = sort_particles_back_to_front();
+    if (visible == 0) return;
+    upload_particle_batch(visible);
+
+    // Mezcla sin escribir profundidad: el orden ya lo resuelve la ordenación
+    gl_state_enable(GL_LIGHTING, false);
+    gl_state_enable(GL_BLEND, true);
+    gl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    gl_state_depth_mask(GL_FALSE);
+
+    int vertex_count = visible * 4;
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    if (particle_vbo) {
+        glBindBuffer(GL_ARRAY_BUFFER, particle_vbo);
+        glVertexPointer(3, GL_FLOAT, sizeof(ParticleVertex), (const void*)0);
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(ParticleVertex), (const void*)offsetof(ParticleVertex, color));
+    } else {
+        glVertexPointer(3, GL_FLOAT, sizeof(ParticleVertex), &vertices[0].x);
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(ParticleVertex), vertices[0].color);
+    }
+    glDrawArrays(GL_QUADS, 0, vertex_count);
+    gl_state_count_draw(vertex_count);
+    if (particle_vbo) glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    gl_state_depth_mask(GL_TRUE);
+    gl_state_enable(GL_BLEND, false);
+    gl_state_enable(GL_LIGHTING, true);
+}
+
+void add_particle(float x, float y, float z, float vx, float vy, float vz) {
+    // Sin hueco libre la partícula se descarta
+    if (particle_count >= MAX_PARTICLES) return;
+
+    int i = particle_count++;
+    particles.x[i] = x;
+    particles.y[i] = y;
+    particles.z[i] = z;
+    particles.previous_x[i] = x;        // Recién creada: sin recorrido que interpolar
+    particles.previous_y[i] = y;
+    particles.previous_z[i] = z;
+    particles.vx[i] = vx;
+    particles.vy[i] = vy;
+    particles.vz[i] = vz;
+    particles.life[i] = 1.0f;
+    particles.size[i] = 0.1f + (rand() % 10) / 100.0f;
+    particles.color[i][0] = (unsigned char)((0.8f + (rand() % 20) / 100.0f) * 255.0f);
+    particles.color[i][1] = (unsigned char)((0.6f + (rand() % 20) / 100.0f) * 255.0f);
+    particles.color[i][2] = (unsigned char)((0.2f + (rand() % 20) / 100.0f) * 255.0f);
+    particles.alpha[i] = 1.0f;
 }
 
 void cleanup_particles() {
     particle_count = 0;
-    for (int i = 0; i < MAX_PARTICLES; i++) {
-        particles[i].life = 0.0f;
+    if (particle_vbo) {
+        glDeleteBuffers(1, &particle_vbo);
+        particle_vbo = 0;
     }
 }
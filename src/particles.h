@@ -4,24 +4,36 @@
 
 #include <GL/gl.h>
 
-// Estructura para partículas
+// Sistema de partículas
+#define MAX_PARTICLES 100000
+#define PARTICLE_GRAVITY 0.01f          // Restado a vy en cada tick
+#define PARTICLE_SIZE_DECAY 0.99f       // Factor por tick
+#define PARTICLE_ALPHA_DECAY 0.98f      // Factor por tick
+#define PARTICLE_NEAR_DEPTH 0.1f        // Las más cercanas (o detrás de la cámara) no se dibujan
+
+// Partículas como estructura de arrays: las vivas ocupan [0, particle_count)
+// sin huecos, así la actualización recorre memoria contigua de 4 en 4 (SSE)
+// y crear o eliminar una partícula es O(1) (añadir al final / mover la última).
+// previous_* guarda la posición al inicio del último tick para interpolar el render
 typedef struct {
-    float x, y, z;
-    float vx, vy, vz;
-    float life;
-    float size;
-    float r, g, b, a;
-} Particle;
+    float x[MAX_PARTICLES], y[MAX_PARTICLES], z[MAX_PARTICLES];
+    float previous_x[MAX_PARTICLES], previous_y[MAX_PARTICLES], previous_z[MAX_PARTICLES];
+    float vx[MAX_PARTICLES], vy[MAX_PARTICLES], vz[MAX_PARTICLES];
+    float life[MAX_PARTICLES];
+    float size[MAX_PARTICLES];
+    float alpha[MAX_PARTICLES];
+    unsigned char color[MAX_PARTICLES][3];
+} ParticlePool;
 
-// Sistema de partículas
-#define MAX_PARTICLES 1000
-extern Particle particles[MAX_PARTICLES];
+extern ParticlePool particles;
 extern int particle_count;
 
 // Funciones de partículas
 void init_particles();
 void update_particles();
-void render_particles();
+void render_particles();            // Billboards ordenados de atrás hacia delante, una llamada de dibujo
+int sort_particles_back_to_front(); // Visibles ordenadas por profundidad de vista; devuelve cuántas
+void upload_particle_batch(int visible); // Billboards en el orden de la última ordenación
 void add_particle(float x, float y, float z, float vx, float vy, float vz);
 void cleanup_particles();
 
@@ -19,9 +19,9 @@ Player3D player = {0};
 void init_player() {
     // Inicializar jugador con valores por defecto
     // Posición en el centro del mapa 200x200
-    player.x = MAZE_WIDTH / 2.0f;
+    player.x = maze_width / 2.0f;
     player.y = 1.0f;  // Altura inicial más alta para evitar problemas de cámara
-    player.z = MAZE_HEIGHT / 2.0f;
+    player.z = maze_height / 2.0f;
     player.yaw = 0.0f;
     player.pitch = 0.0f;
     player.height = 1.8f;  // Altura del jugador 1.80m
@@ -55,6 +55,11 @@ void update_player() {
     // Ajustar altura del jugador basada en el terreno
     adjust_player_to_terrain();
     
+    // Marcar la celda actual como explorada
+    int cell_x = (int)floorf(player.x + 0.5f);
+    int cell_z = (int)floorf(player.z + 0.5f);
+    if (maze_in_bounds(cell_x, cell_z)) set_maze_flag(cell_x, cell_z, CELL_EXPLORED);
+    
     // Actualizar sistema de audio
     update_audio();
 }
@@ -0,0 +1,243 @@
+// profiler.c - Perfilador de frame por subsistema con overlay en pantalla
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include "timer.h"
+#include "profiler.h"
+#include "gl_state.h"
+#include "thread_pool.h"
+#include "ui_batch.h"
+#include <GL/gl.h>
+#include <stdio.h>
+#include <string.h>
+
+extern int windowWidth;
+extern int windowHeight;
+
+// Disposición del overlay en píxeles
+#define OVERLAY_X 10.0f
+#define OVERLAY_Y 10.0f
+#define OVERLAY_TEXT_SCALE 2.0f
+#define OVERLAY_LINE_HEIGHT 24.0f
+#define OVERLAY_GRAPH_WIDTH 560.0f
+#define OVERLAY_GRAPH_HEIGHT 96.0f
+#define OVERLAY_SPARK_WIDTH 150.0f
+#define OVERLAY_SPARK_HEIGHT 16.0f
+#define OVERLAY_AVERAGE_COLUMN 200.0f
+#define OVERLAY_PEAK_COLUMN 300.0f
+
+bool profiler_overlay_visible = false;
+
+static ProfileRing rings[PROFILE_SECTION_COUNT];
+static double section_start[PROFILE_SECTION_COUNT];
+static double section_total[PROFILE_SECTION_COUNT];   // Segundos acumulados en el frame
+static double last_frame_time = 0.0;    // 0 hasta el primer frame del loop
+
+// Capacidades que el overlay cambia y devuelve como estaban
+#define OVERLAY_CAP_COUNT 6
+static const GLenum overlay_caps[OVERLAY_CAP_COUNT] = {
+    GL_DEPTH_TEST, GL_CULL_FACE, GL_LIGHTING, GL_FOG, GL_TEXTURE_2D, GL_BLEND
+};
+
+static const char* section_names[PROFILE_SECTION_COUNT] = {
+    "frame",
+    "update_player",
+    "update_enemy",
+    "process_events",
+    "render_world",
+    "  suelo y techo",
+    "  muros",
+    "  enemigo",
+    "  particulas",
+    "glfwSwapBuffers"
+};
+
+static const float section_colors[PROFILE_SECTION_COUNT][3] = {
+    {1.0f, 1.0f, 1.0f},
+    {0.4f, 0.8f, 1.0f},
+    {1.0f, 0.4f, 0.4f},
+    {1.0f, 0.8f, 0.3f},
+    {0.5f, 1.0f, 0.5f},
+    {0.8f, 0.7f, 0.5f},
+    {0.9f, 0.9f, 0.6f},
+    {1.0f, 0.5f, 0.8f},
+    {0.6f, 0.6f, 1.0f},
+    {0.7f, 0.7f, 0.7f}
+};
+
+void init_profiler() {
+    memset(rings, 0, sizeof(rings));
+    memset(section_total, 0, sizeof(section_total));
+    last_frame_time = 0.0;
+    printf("Perfilador inicializado (F3 muestra el overlay)\n");
+}
+
+void profiler_begin(ProfileSection section) {
+    section_start[section] = timer_seconds();
+}
+
+void profiler_end(ProfileSection section) {
+    section_total[section] += timer_seconds() - section_start[section];
+}
+
+static void ring_push(ProfileRing* ring, float value) {
+    long index = ring->written;
+    ring->samples[index % PROFILER_HISTORY] = value;
+    atomic_store_long(&ring->written, index + 1);
+}
+
+void profiler_end_frame() {
+    double now = timer_seconds();
+    section_total[PROFILE_FRAME] = now - last_frame_time;
+
+    // El primer frame arrastraría toda la carga del mapa: solo marca el inicio
+    if (last_frame_time == 0.0) {
+        last_frame_time = now;
+        memset(section_total, 0, sizeof(section_total));
+        return;
+    }
+    last_frame_time = now;
+
+    for (int i = 0; i < PROFILE_SECTION_COUNT; i++) {
+        ring_push(&rings[i], (float)(section_total[i] * 1000.0));
+        section_total[i] = 0.0;
+    }
+}
+
+int profiler_read(ProfileSection section, float* samples, int max_samples) {
+    const ProfileRing* ring = &rings[section];
+    long written = atomic_load_long((volatile long*)&ring->written);
+    int count = written < PROFILER_HISTORY ? (int)written : PROFILER_HISTORY;
+    if (count > max_samples) count = max_samples;
+
+    for (int i = 0; i < count; i++) {
+        samples[i] = ring->samples[(written - count + i) % PROFILER_HISTORY];
+    }
+    return count;
+}
+
+void profiler_toggle_overlay() {
+    profiler_overlay_visible = !profiler_overlay_visible;
+}
+
+static void add_text(float x, float y, const char* text, const float* color) {
+    ui_text(text, x, y, OVERLAY_TEXT_SCALE, OVERLAY_TEXT_SCALE, color[0], color[1], color[2]);
+}
+
+// Barras de tiempo de frame; escala mínima de 33.3 ms
+static void draw_frame_graph(const float* samples, int count, float x, float y, float peak) {
+    float scale_ms = peak > 33.3f ? peak : 33.3f;
+    float bar_width = OVERLAY_GRAPH_WIDTH / PROFILER_HISTORY;
+
+    ui_rect(x, y, OVERLAY_GRAPH_WIDTH, OVERLAY_GRAPH_HEIGHT, 0.0f, 0.0f, 0.0f, 0.6f);
+    for (int i = 0; i < count; i++) {
+        float height = samples[i] / scale_ms * OVERLAY_GRAPH_HEIGHT;
+        float bar_x = x + (PROFILER_HISTORY - count + i) * bar_width;
+        float bar_y = y + OVERLAY_GRAPH_HEIGHT - height;
+        if (samples[i] <= 16.7f) ui_rect(bar_x, bar_y, bar_width, height, 0.3f, 0.9f, 0.3f, 1.0f);
+        else if (samples[i] <= 33.3f) ui_rect(bar_x, bar_y, bar_width, height, 0.9f, 0.8f, 0.2f, 1.0f);
+        else ui_rect(bar_x, bar_y, bar_width, height, 0.9f, 0.2f, 0.2f, 1.0f);
+    }
+
+    // Referencias de 60 y 30 FPS
+    float y60 = y + OVERLAY_GRAPH_HEIGHT - 16.7f / scale_ms * OVERLAY_GRAPH_HEIGHT;
+    float y30 = y + OVERLAY_GRAPH_HEIGHT - 33.3f / scale_ms * OVERLAY_GRAPH_HEIGHT;
+    ui_rect(x, y60, OVERLAY_GRAPH_WIDTH, 1.0f, 1.0f, 1.0f, 1.0f, 0.5f);
+    ui_rect(x, y30, OVERLAY_GRAPH_WIDTH, 1.0f, 1.0f, 1.0f, 1.0f, 0.5f);
+}
+
+// Historial de una sección como línea, escalado a su propio máximo
+static void draw_sparkline(const float* samples, int count, float x, float y, float peak, const float* color) {
+    if (count < 2 || peak <= 0.0f) return;
+    float step = OVERLAY_SPARK_WIDTH / (PROFILER_HISTORY - 1);
+
+    float previous_x = 0.0f, previous_y = 0.0f;
+    for (int i = 0; i < count; i++) {
+        float point_x = x + (PROFILER_HISTORY - count + i) * step;
+        float point_y = y + OVERLAY_SPARK_HEIGHT - samples[i] / peak * OVERLAY_SPARK_HEIGHT;
+        if (i > 0) ui_line(previous_x, previous_y, point_x, point_y, 1.0f, color[0], color[1], color[2], 1.0f);
+        previous_x = point_x;
+        previous_y = point_y;
+    }
+}
+
+void render_profiler_overlay() {
+    if (!profiler_overlay_visible) return;
+
+    static float samples[PROFILE_SECTION_COUNT][PROFILER_HISTORY];
+    float average[PROFILE_SECTION_COUNT];
+    float peak[PROFILE_SECTION_COUNT];
+    int count[PROFILE_SECTION_COUNT];
+    for (int s = 0; s < PROFILE_SECTION_COUNT; s++) {
+        count[s] = profiler_read((ProfileSection)s, samples[s], PROFILER_HISTORY);
+        float sum = 0.0f;
+        peak[s] = 0.0f;
+        for (int i = 0; i < count[s]; i++) {
+            sum += samples[s][i];
+            if (samples[s][i] > peak[s]) peak[s] = samples[s][i];
+        }
+        average[s] = count[s] > 0 ? sum / count[s] : 0.0f;
+    }
+
+    // Proyección ortogonal en píxeles, sin iluminación, niebla ni profundidad
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0, windowWidth, windowHeight, 0, -1, 1);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    // Guardar las capacidades que cambia el overlay para devolverlas tal cual
+    bool previous_caps[OVERLAY_CAP_COUNT];
+    for (int i = 0; i < OVERLAY_CAP_COUNT; i++) previous_caps[i] = gl_state_is_enabled(overlay_caps[i]);
+
+    gl_state_enable(GL_DEPTH_TEST, false);
+    gl_state_enable(GL_CULL_FACE, false);
+    gl_state_enable(GL_LIGHTING, false);
+    gl_state_enable(GL_FOG, false);
+    gl_state_enable(GL_TEXTURE_2D, false);
+    gl_state_enable(GL_BLEND, true);
+    gl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    float x = OVERLAY_X;
+    float y = OVERLAY_Y;
+    float panel_height = OVERLAY_LINE_HEIGHT * PROFILE_SECTION_COUNT + OVERLAY_GRAPH_HEIGHT + 16.0f;
+    ui_rect(x - 6.0f, y - 6.0f, OVERLAY_GRAPH_WIDTH + 12.0f, panel_height, 0.0f, 0.0f, 0.0f, 0.5f);
+
+    char line[128];
+    snprintf(line, sizeof(line), "Frame %.2f ms (%.0f FPS)  peor %.2f ms",
+             average[PROFILE_FRAME], average[PROFILE_FRAME] > 0.0f ? 1000.0f / average[PROFILE_FRAME] : 0.0f,
+             peak[PROFILE_FRAME]);
+    add_text(x, y, line, section_colors[PROFILE_FRAME]);
+    y += OVERLAY_LINE_HEIGHT;
+
+    draw_frame_graph(samples[PROFILE_FRAME], count[PROFILE_FRAME], x, y, peak[PROFILE_FRAME]);
+    y += OVERLAY_GRAPH_HEIGHT + 8.0f;
+
+    // Desglose por subsistema: media, máximo y su historial
+    for (int s = PROFILE_FRAME + 1; s < PROFILE_SECTION_COUNT; s++) {
+        add_text(x, y, section_names[s], section_colors[s]);
+        snprintf(line, sizeof(line), "%.2f ms", average[s]);
+        add_text(x + OVERLAY_AVERAGE_COLUMN, y, line, section_colors[s]);
+        snprintf(line, sizeof(line), "max %.2f", peak[s]);
+        add_text(x + OVERLAY_PEAK_COLUMN, y, line, section_colors[s]);
+        draw_sparkline(samples[s], count[s], x + OVERLAY_GRAPH_WIDTH - OVERLAY_SPARK_WIDTH, y,
+                       peak[s], section_colors[s]);
+        y += OVERLAY_LINE_HEIGHT;
+    }
+
+    // Panel, gráficas y texto en una sola llamada de dibujo
+    ui_flush();
+
+    // Restaurar el estado que había antes del overlay
+    for (int i = 0; i < OVERLAY_CAP_COUNT; i++) gl_state_enable(overlay_caps[i], previous_caps[i]);
+
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+}
+
+void cleanup_profiler() {
+    profiler_overlay_visible = false;
+}
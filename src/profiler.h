@@ -0,0 +1,45 @@
+// profiler.h - Perfilador de frame por subsistema con overlay en pantalla
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+
+// Frames guardados en cada historial (unos 4 segundos a 60 FPS)
+#define PROFILER_HISTORY 256
+#define PROFILER_TOGGLE_KEY GLFW_KEY_F3
+
+// Secciones medidas (tiempo de CPU acumulado por frame)
+typedef enum {
+    PROFILE_FRAME,              // Frame completo del loop principal
+    PROFILE_UPDATE_PLAYER,
+    PROFILE_UPDATE_ENEMY,
+    PROFILE_PROCESS_EVENTS,
+    PROFILE_RENDER_WORLD,
+    PROFILE_RENDER_FLOOR,       // Suelo, terreno y techo
+    PROFILE_RENDER_WALLS,
+    PROFILE_RENDER_ENEMY,
+    PROFILE_RENDER_PARTICLES,
+    PROFILE_SWAP_BUFFERS,
+    PROFILE_SECTION_COUNT
+} ProfileSection;
+
+// Historial circular sin bloqueos: un único productor (el hilo que cierra el frame)
+// publica cada muestra con un store de liberación; los lectores solo leen
+typedef struct {
+    float samples[PROFILER_HISTORY];   // Milisegundos
+    volatile long written;             // Muestras escritas en total
+} ProfileRing;
+
+extern bool profiler_overlay_visible;
+
+// Funciones del perfilador
+void init_profiler();
+void profiler_begin(ProfileSection section);
+void profiler_end(ProfileSection section);
+void profiler_end_frame();                 // Publica los tiempos del frame en los historiales
+int profiler_read(ProfileSection section, float* samples, int max_samples); // Más antiguas primero
+void profiler_toggle_overlay();
+void render_profiler_overlay();
+void cleanup_profiler();
+
+#endif // PROFILER_H
@@ -0,0 +1,255 @@
+// pvs.c - Conjunto potencialmente visible (PVS) precalculado al generar el mapa
+#include "pvs.h"
+#include "timer.h"
+#include "map.h"
+#include "wall_mesh.h"
+#include "thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+bool pvs_ready = false;
+double pvs_bake_ms = 0.0;
+
+// Rejilla de clusters y chunks
+static int cluster_cols = 0;
+static int cluster_rows = 0;
+static int chunk_cols = 0;
+static int chunk_rows = 0;
+static int bitset_bytes = 0;
+
+// Entradas comprimidas: un blob contiguo con desplazamientos por cluster
+static unsigned char* pvs_blob = NULL;
+static int* pvs_offsets = NULL;     // -1 = cluster sin celdas abiertas
+
+// Resultado temporal de cada cluster durante el horneado
+typedef struct {
+    unsigned char* data;
+    int size;
+} PvsEntry;
+
+static PvsEntry* bake_entries = NULL;
+
+// Progreso del horneado (clusters terminados, lo leen otros hilos)
+static volatile long clusters_baked = 0;
+static volatile long clusters_total = 0;
+
+// Último cluster descomprimido
+static int cached_cluster = -1;
+static unsigned char* cached_bits = NULL;
+
+// Compresión: cada 0 va seguido del número de ceros consecutivos (1-255)
+static int compress_bitset(const unsigned char* bits, unsigned char* out) {
+    int size = 0;
+    for (int i = 0; i < bitset_bytes; ) {
+        if (bits[i] != 0) {
+            out[size++] = bits[i++];
+            continue;
+        }
+        int run = 0;
+        while (i < bitset_bytes && bits[i] == 0 && run < 255) {
+            run++;
+            i++;
+        }
+        out[size++] = 0;
+        out[size++] = (unsigned char)run;
+    }
+    return size;
+}
+
+static void decompress_bitset(const unsigned char* data, unsigned char* bits) {
+    int i = 0;
+    while (i < bitset_bytes) {
+        unsigned char value = *data++;
+        if (value != 0) {
+            bits[i++] = value;
+        } else {
+            int run = *data++;
+            memset(bits + i, 0, (size_t)run);
+            i += run;
+        }
+    }
+}
+
+// Rayo DDA desde el centro de una celda: marca el chunk de cada celda recorrida (las
+// abiertas también, el suelo y el techo van en la malla del chunk) hasta el primer muro
+static void pvs_cast_ray(unsigned char* bits, int start_x, int start_z, float angle) {
+    float origin_x = start_x + 0.5f;
+    float origin_z = start_z + 0.5f;
+    float dir_x = cosf(angle);
+    float dir_z = sinf(angle);
+
+    int cell_x = start_x;
+    int cell_z = start_z;
+    int step_x = dir_x >= 0.0f ? 1 : -1;
+    int step_z = dir_z >= 0.0f ? 1 : -1;
+    float delta_x = dir_x != 0.0f ? fabsf(1.0f / dir_x) : 1e30f;
+    float delta_z = dir_z != 0.0f ? fabsf(1.0f / dir_z) : 1e30f;
+    float side_x = dir_x >= 0.0f ? (cell_x + 1.0f - origin_x) * delta_x : (origin_x - cell_x) * delta_x;
+    float side_z = dir_z >= 0.0f ? (cell_z + 1.0f - origin_z) * delta_z : (origin_z - cell_z) * delta_z;
+
+    float travelled = 0.0f;
+    while (travelled <= PVS_MAX_DISTANCE) {
+        if (cell_x < 0 || cell_x >= maze_width || cell_z < 0 || cell_z >= maze_height) return;
+
+        int chunk = (cell_z / WALL_CHUNK_SIZE) * chunk_cols + cell_x / WALL_CHUNK_SIZE;
+        bits[chunk >> 3] |= (unsigned char)(1 << (chunk & 7));
+        if (maze_cell(cell_x, cell_z) == 1) return;
+
+        if (side_x < side_z) {
+            travelled = side_x;
+            side_x += delta_x;
+            cell_x += step_x;
+        } else {
+            travelled = side_z;
+            side_z += delta_z;
+            cell_z += step_z;
+        }
+    }
+}
+
+static void bake_cluster_task(void* data, int index) {
+    (void)data;
+    int cluster_x = index % cluster_cols;
+    int cluster_z = index / cluster_cols;
+    int x0 = cluster_x * PVS_CLUSTER_SIZE;
+    int z0 = cluster_z * PVS_CLUSTER_SIZE;
+
+    unsigned char* bits = (unsigned char*)calloc((size_t)bitset_bytes, 1);
+    if (!bits) return;
+
+    int ray_count = (int)ceilf(2.0f * (float)M_PI * PVS_MAX_DISTANCE / PVS_RAY_SPACING);
+    bool has_open_cell = false;
+
+    // Lanzar rayos en todas direcciones desde cada celda abierta del cluster
+    for (int x = x0; x < x0 + PVS_CLUSTER_SIZE && x < maze_width; x++) {
+        for (int z = z0; z < z0 + PVS_CLUSTER_SIZE && z < maze_height; z++) {
+            if (maze_cell(x, z) == 1) continue;
+            has_open_cell = true;
+            for (int r = 0; r < ray_count; r++) {
+                pvs_cast_ray(bits, x, z, 2.0f * (float)M_PI * r / ray_count);
+            }
+        }
+    }
+
+    if (has_open_cell) {
+        // En el peor caso cada byte nulo ocupa dos bytes comprimidos
+        unsigned char* packed = (unsigned char*)malloc((size_t)bitset_bytes * 2);
+        if (packed) {
+            bake_entries[index].size = compress_bitset(bits, packed);
+            bake_entries[index].data = packed;
+        }
+    }
+    free(bits);
+    atomic_add_long(&clusters_baked, 1);
+}
+
+void bake_pvs() {
+    cleanup_pvs();
+    if (maze_width * maze_height > PVS_MAX_MAP_CELLS) {
+        // El horneado crece con clusters x chunks: en mapas grandes se omite
+        printf("PVS omitido: mapa de %dx%d celdas (límite %d)\n", maze_width, maze_height, PVS_MAX_MAP_CELLS);
+        return;
+    }
+    double start = timer_seconds();
+
+    cluster_cols = (maze_width + PVS_CLUSTER_SIZE - 1) / PVS_CLUSTER_SIZE;
+    cluster_rows = (maze_height + PVS_CLUSTER_SIZE - 1) / PVS_CLUSTER_SIZE;
+    chunk_cols = (maze_width + WALL_CHUNK_SIZE - 1) / WALL_CHUNK_SIZE;
+    chunk_rows = (maze_height + WALL_CHUNK_SIZE - 1) / WALL_CHUNK_SIZE;
+    bitset_bytes = (chunk_cols * chunk_rows + 7) / 8;
+
+    int cluster_count = cluster_cols * cluster_rows;
+    atomic_store_long(&clusters_baked, 0);
+    atomic_store_long(&clusters_total, cluster_count);
+    bake_entries = (PvsEntry*)calloc((size_t)cluster_count, sizeof(PvsEntry));
+    pvs_offsets = (int*)malloc(sizeof(int) * (size_t)cluster_count);
+    cached_bits = (unsigned char*)malloc((size_t)bitset_bytes);
+    if (!bake_entries || !pvs_offsets || !cached_bits) {
+        printf("Error: Sin memoria para el PVS\n");
+        cleanup_pvs();
+        return;
+    }
+
+    // Cada cluster es independiente: repartirlos entre los hilos
+    thread_pool_run(bake_cluster_task, NULL, cluster_count);
+
+    // Empaquetar las entradas en un único blob
+    int blob_size = 0;
+    for (int i = 0; i < cluster_count; i++) blob_size += bake_entries[i].size;
+    pvs_blob = (unsigned char*)malloc((size_t)(blob_size > 0 ? blob_size : 1));
+
+    int offset = 0;
+    int entries = 0;
+    for (int i = 0; i < cluster_count; i++) {
+        if (bake_entries[i].data && pvs_blob) {
+            pvs_offsets[i] = offset;
+            memcpy(pvs_blob + offset, bake_entries[i].data, (size_t)bake_entries[i].size);
+            offset += bake_entries[i].size;
+            entries++;
+        } else {
+            pvs_offsets[i] = -1;
+        }
+        free(bake_entries[i].data);
+    }
+    free(bake_entries);
+    bake_entries = NULL;
+
+    cached_cluster = -1;
+    pvs_ready = pvs_blob != NULL;
+    pvs_bake_ms = (timer_seconds() - start) * 1000.0;
+
+    printf("PVS horneado: %d clusters de %dx%d, %d chunks, %d bytes (sin comprimir %d) en %.1f ms\n",
+           entries, PVS_CLUSTER_SIZE, PVS_CLUSTER_SIZE, chunk_cols * chunk_rows,
+           blob_size, entries * bitset_bytes, pvs_bake_ms);
+}
+
+float pvs_bake_progress() {
+    long total = atomic_load_long(&clusters_total);
+    if (total <= 0) return 0.0f;
+    return (float)atomic_load_long(&clusters_baked) / (float)total;
+}
+
+const unsigned char* pvs_lookup(float x, float z) {
+    if (!pvs_ready) return NULL;
+
+    // Celda del jugador (cada celda ocupa [x - 0.5, x + 0.5])
+    int cell_x = (int)floorf(x + 0.5f);
+    int cell_z = (int)floorf(z + 0.5f);
+    if (cell_x < 0 || cell_x >= maze_width || cell_z < 0 || cell_z >= maze_height) return NULL;
+
+    int cluster = (cell_z / PVS_CLUSTER_SIZE) * cluster_cols + cell_x / PVS_CLUSTER_SIZE;
+    if (pvs_offsets[cluster] < 0) return NULL;
+
+    if (cluster != cached_cluster) {
+        decompress_bitset(pvs_blob + pvs_offsets[cluster], cached_bits);
+        cached_cluster = cluster;
+    }
+    return cached_bits;
+}
+
+bool pvs_bit(const unsigned char* bits, int chunk_index) {
+    return (bits[chunk_index >> 3] >> (chunk_index & 7)) & 1;
+}
+
+void cleanup_pvs() {
+    if (bake_entries) {
+        int cluster_count = cluster_cols * cluster_rows;
+        for (int i = 0; i < cluster_count; i++) free(bake_entries[i].data);
+        free(bake_entries);
+    }
+    free(pvs_blob);
+    free(pvs_offsets);
+    free(cached_bits);
+    bake_entries = NULL;
+    pvs_blob = NULL;
+    pvs_offsets = NULL;
+    cached_bits = NULL;
+    cached_cluster = -1;
+    pvs_ready = false;
+}
@@ -0,0 +1,23 @@
+// pvs.h - Conjunto potencialmente visible (PVS) precalculado al generar el mapa
+#ifndef PVS_H
+#define PVS_H
+
+#include <stdbool.h>
+
+// Parámetros del horneado
+#define PVS_CLUSTER_SIZE 4          // Celdas por lado de cada cluster
+#define PVS_MAX_DISTANCE 35.0f      // Igual que la distancia de render de muros
+#define PVS_RAY_SPACING 0.5f        // Separación entre rayos (en celdas) a la distancia máxima
+#define PVS_MAX_MAP_CELLS (256 * 256)   // Mapas mayores usan la prueba de distancia sin PVS
+
+extern bool pvs_ready;
+extern double pvs_bake_ms;
+
+// Funciones del PVS
+void bake_pvs();
+float pvs_bake_progress();      // 0..1 durante bake_pvs (se puede leer desde otro hilo)
+const unsigned char* pvs_lookup(float x, float z);
+bool pvs_bit(const unsigned char* bits, int chunk_index);
+void cleanup_pvs();
+
+#endif // PVS_H
@@ -5,6 +5,18 @@
 #include "enemy.h"
 #include "particles.h"
 #include "image_loader.h"
+#include "wall_mesh.h"
+#include "frustum.h"
+#include "occlusion.h"
+#include "pvs.h"
+#include "gl_state.h"
+#include "instancing.h"
+#include "light_clusters.h"
+#include "lightmap.h"
+#include "lod.h"
+#include "profiler.h"
+#include "ui_batch.h"
+#include "world_stream.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
@@ -19,6 +31,10 @@
 extern int windowWidth;
 extern int windowHeight;
 
+// Interpolación entre ticks (fuera del bucle principal se dibuja el último tick)
+float render_alpha = 1.0f;
+unsigned long simulation_ticks = 0;
+
 // Variables de niebla
 float fog_start = 10.0f;
 float fog_end = 50.0f;
@@ -30,36 +46,53 @@ float light_y = 0.0f;
 float light_z = 0.0f;
 float light_range = LIGHT_RANGE;
 
+// Ruta de renderizado de muros
+int wall_render_mode = WALL_RENDER_CHUNKS;
+
+// Base de la cámara del último setup_camera()
+CameraBasis camera_basis = {{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+
+// Materiales compartidos (la caché de estado filtra los que se repiten)
+const GLMaterial material_wall = {
+    {0.1f, 0.1f, 0.1f, 1.0f}, {0.2f, 0.2f, 0.2f, 1.0f}, {0.05f, 0.05f, 0.05f, 1.0f}, 16.0f
+};
+static const GLMaterial material_default = {
+    {0.2f, 0.2f, 0.2f, 1.0f}, {0.8f, 0.8f, 0.8f, 1.0f}, {0.3f, 0.3f, 0.3f, 1.0f}, 64.0f
+};
+const GLMaterial material_floor = {
+    {0.4f, 0.4f, 0.4f, 1.0f}, {0.7f, 0.7f, 0.7f, 1.0f}, {0.1f, 0.1f, 0.1f, 1.0f}, 16.0f
+};
+static const GLMaterial material_terrain = {
+    {0.35f, 0.35f, 0.35f, 1.0f}, {0.65f, 0.65f, 0.65f, 1.0f}, {0.05f, 0.05f, 0.05f, 1.0f}, 8.0f
+};
+const GLMaterial material_ceiling = {
+    {0.4f, 0.4f, 0.4f, 1.0f}, {0.7f, 0.7f, 0.7f, 1.0f}, {0.3f, 0.3f, 0.3f, 1.0f}, 32.0f
+};
+
+// Niebla EQUILIBRADA estilo Silent Hill - visible pero atmosférica
+static const GLFog fog_params = {
+    GL_EXP2, FOG_DENSITY, FOG_START_DISTANCE, FOG_END_DISTANCE, {0.15f, 0.15f, 0.18f, 1.0f}
+};
+
 // Variables del sistema de carga eliminadas
 
-// Función para frustum culling basado en perspectiva de cámara
-bool is_in_frustum(int x, int z) {
-    // Calcular vector desde el jugador al objeto
-    float dx = x - player.x;
-    float dz = z - player.z;
-    
-    // Calcular ángulo del objeto relativo a la dirección de la cámara
-    float object_angle = atan2(dz, dx);
-    float player_angle = player.yaw;
-    
-    // Normalizar ángulos
-    float angle_diff = object_angle - player_angle;
-    while (angle_diff > M_PI) angle_diff -= 2.0f * M_PI;
-    while (angle_diff < -M_PI) angle_diff += 2.0f * M_PI;
-    
-    // Campo de visión de 180 grados (90 grados a cada lado) - más generoso para perspectiva
-    float fov_half = M_PI / 2.0f;
-    
-    // Verificar si está dentro del campo de visión
-    return fabs(angle_diff) <= fov_half;
+// Frustum culling de una celda del laberinto (ruta inmediata)
+static bool cell_in_frustum(int x, int z, float height) {
+    bool inside = frustum_test_box(x - 0.5f, 0.0f, z - 0.5f, x + 0.5f, height, z + 0.5f);
+    if (inside) {
+        frustum_stats.cells_accepted++;
+    } else {
+        frustum_stats.cells_rejected++;
+    }
+    return inside;
 }
 
 void init_renderer() {
     // Habilitar características 3D
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
-    glEnable(GL_LIGHTING);
-    glEnable(GL_FOG);
+    gl_state_enable(GL_DEPTH_TEST, true);
+    gl_state_enable(GL_CULL_FACE, true);
+    gl_state_enable(GL_LIGHTING, true);
+    gl_state_enable(GL_FOG, true);
     
     // Configurar culling
     glCullFace(GL_BACK);
@@ -68,6 +101,9 @@ void init_renderer() {
     // Configurar sistema de iluminación
     setup_lighting();
     
+    // Material por defecto más realista
+    gl_state_material(&material_default);
+    
     // Pantalla de carga eliminada
     
     // Inicializar sistema de partículas
@@ -105,25 +141,44 @@ void setup_camera() {
         player.x + lookX, look_height, player.z + lookZ,  // Punto de mira
         0.0f, 1.0f, 0.0f  // Vector "up" (hacia arriba)
     );
+    
+    // Misma base que construye gluLookAt: adelante, derecha = adelante x Y, arriba = derecha x adelante
+    float forwardY = look_height - eye_height;
+    length = sqrt(lookX * lookX + forwardY * forwardY + lookZ * lookZ);
+    if (length <= 0.0f) length = 1.0f;
+    camera_basis.eye[0] = player.x;
+    camera_basis.eye[1] = eye_height;
+    camera_basis.eye[2] = player.z;
+    camera_basis.forward[0] = lookX / length;
+    camera_basis.forward[1] = forwardY / length;
+    camera_basis.forward[2] = lookZ / length;
+    
+    float rightLength = sqrt(camera_basis.forward[0] * camera_basis.forward[0] +
+                             camera_basis.forward[2] * camera_basis.forward[2]);
+    if (rightLength > 0.0f) {
+        camera_basis.right[0] = -camera_basis.forward[2] / rightLength;
+        camera_basis.right[1] = 0.0f;
+        camera_basis.right[2] = camera_basis.forward[0] / rightLength;
+    } else {
+        // Mirando en vertical: cualquier horizontal sirve
+        camera_basis.right[0] = 1.0f;
+        camera_basis.right[1] = 0.0f;
+        camera_basis.right[2] = 0.0f;
+    }
+    camera_basis.up[0] = camera_basis.right[1] * camera_basis.forward[2] - camera_basis.right[2] * camera_basis.forward[1];
+    camera_basis.up[1] = camera_basis.right[2] * camera_basis.forward[0] - camera_basis.right[0] * camera_basis.forward[2];
+    camera_basis.up[2] = camera_basis.right[0] * camera_basis.forward[1] - camera_basis.right[1] * camera_basis.forward[0];
 }
 
 void draw_cube(float x, float y, float z, float size) {
     float half = size * 0.5f;
     
     // Asegurar que no hay blending ni transparencia
-    glDisable(GL_BLEND);
-    glDepthMask(GL_TRUE);
-    
-    // Configurar material sólido para que responda a la iluminación (negro para postes)
-    GLfloat ambient[] = {0.1f, 0.1f, 0.1f, 1.0f};
-    GLfloat diffuse[] = {0.2f, 0.2f, 0.2f, 1.0f};
-    GLfloat specular[] = {0.05f, 0.05f, 0.05f, 1.0f};
-    GLfloat shininess[] = {16.0f};
+    gl_state_enable(GL_BLEND, false);
+    gl_state_depth_mask(GL_TRUE);
     
-    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, ambient);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, diffuse);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, specular);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, shininess);
+    // Material sólido que responde a la iluminación (negro para postes)
+    gl_state_material(&material_wall);
     
     glBegin(GL_QUADS);
     
@@ -170,23 +225,16 @@ void draw_cube(float x, float y, float z, float size) {
     glVertex3f(x - half, y - half, z + half);
     
     glEnd();
+    gl_state_count_draw(24);
 }
 
 void draw_tall_wall(int x, int z, int levels) {
     // Asegurar que no hay blending ni transparencia
-    glDisable(GL_BLEND);
-    glDepthMask(GL_TRUE);
+    gl_state_enable(GL_BLEND, false);
+    gl_state_depth_mask(GL_TRUE);
     
-    // Configurar material para paredes (negro oscuro)
-    GLfloat mat_ambient[] = {0.1f, 0.1f, 0.1f, 1.0f};
-    GLfloat mat_diffuse[] = {0.2f, 0.2f, 0.2f, 1.0f};
-    GLfloat mat_specular[] = {0.1f, 0.1f, 0.1f, 1.0f};
-    GLfloat mat_shininess[] = {32.0f};
-    
-    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, mat_ambient);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, mat_diffuse);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, mat_specular);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, mat_shininess);
+    // Mismo material que draw_cube (el que se aplicaba antes quedaba siempre sobrescrito)
+    gl_state_material(&material_wall);
     
     // Dibujar una pared alta compuesta por múltiples cubos apilados
     for (int level = 0; level < levels; level++) {
@@ -197,17 +245,48 @@ void draw_tall_wall(int x, int z, int levels) {
     }
 }
 
+void draw_wall_slab(int x, int z, float height) {
+    gl_state_enable(GL_BLEND, false);
+    gl_state_depth_mask(GL_TRUE);
+    gl_state_material(&material_wall);
+    
+    // Las cuatro caras laterales de la columna completa (la cara superior queda
+    // bajo el techo y nunca se ve): 4 quads en lugar de 6 por nivel
+    float x0 = x - 0.5f, x1 = x + 0.5f;
+    float z0 = z - 0.5f, z1 = z + 0.5f;
+    glBegin(GL_QUADS);
+    
+    glNormal3f(0.0f, 0.0f, 1.0f);
+    glVertex3f(x0, 0.0f, z1);
+    glVertex3f(x1, 0.0f, z1);
+    glVertex3f(x1, height, z1);
+    glVertex3f(x0, height, z1);
+    
+    glNormal3f(0.0f, 0.0f, -1.0f);
+    glVertex3f(x0, 0.0f, z0);
+    glVertex3f(x0, height, z0);
+    glVertex3f(x1, height, z0);
+    glVertex3f(x1, 0.0f, z0);
+    
+    glNormal3f(-1.0f, 0.0f, 0.0f);
+    glVertex3f(x0, 0.0f, z0);
+    glVertex3f(x0, 0.0f, z1);
+    glVertex3f(x0, height, z1);
+    glVertex3f(x0, height, z0);
+    
+    glNormal3f(1.0f, 0.0f, 0.0f);
+    glVertex3f(x1, 0.0f, z0);
+    glVertex3f(x1, height, z0);
+    glVertex3f(x1, height, z1);
+    glVertex3f(x1, 0.0f, z1);
+    
+    glEnd();
+    gl_state_count_draw(16);
+}
+
 void draw_floor() {
     // Configurar material para el suelo - color gris con niveles
-    GLfloat ambient[] = {0.4f, 0.4f, 0.4f, 1.0f};  // Gris más claro
-    GLfloat diffuse[] = {0.7f, 0.7f, 0.7f, 1.0f};   // Gris medio más visible
-    GLfloat specular[] = {0.1f, 0.1f, 0.1f, 1.0f}; // Brillo muy sutil
-    GLfloat shininess[] = {16.0f};
-    
-    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, ambient);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, diffuse);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, specular);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, shininess);
+    gl_state_material(&material_floor);
     
     // Dibujar suelo con múltiples niveles para crear verticalidad
     glBegin(GL_QUADS);
@@ -263,20 +342,13 @@ void draw_floor() {
     glVertex3f(200.0f, -0.4f, -200.0f);
     
     glEnd();
+    gl_state_count_draw(28);
 }
 
 void draw_terrain_variations() {
     // Dibujar variaciones en el terreno para crear más verticalidad
     // Configurar material para variaciones del terreno
-    GLfloat ambient[] = {0.35f, 0.35f, 0.35f, 1.0f};  // Gris ligeramente diferente
-    GLfloat diffuse[] = {0.65f, 0.65f, 0.65f, 1.0f};   // Gris medio
-    GLfloat specular[] = {0.05f, 0.05f, 0.05f, 1.0f}; // Brillo muy sutil
-    GLfloat shininess[] = {8.0f};
-    
-    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, ambient);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, diffuse);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, specular);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, shininess);
+    gl_state_material(&material_terrain);
     
     glBegin(GL_QUADS);
     
@@ -340,9 +412,13 @@ void draw_terrain_variations() {
     glVertex3f(100.0f, -0.1f, -100.0f);
     
     glEnd();
+    gl_state_count_draw(36);
 }
 
 float get_terrain_height(float x, float z) {
+    // El mundo infinito es llano: sus coordenadas locales cambian al recentrar
+    if (world_stream_active) return 0.1f;
+    
     // Calcular la altura del terreno basada en la posición
     // Área central elevada (100x100)
     if (x >= -100.0f && x <= 100.0f && z >= -100.0f && z <= 100.0f) {
@@ -360,86 +436,62 @@ float get_terrain_height(float x, float z) {
 
 void draw_ceiling() {
     // Configurar material para el techo (gris)
-    GLfloat ambient[] = {0.4f, 0.4f, 0.4f, 1.0f};
-    GLfloat diffuse[] = {0.7f, 0.7f, 0.7f, 1.0f};
-    GLfloat specular[] = {0.3f, 0.3f, 0.3f, 1.0f};
-    GLfloat shininess[] = {32.0f};
-    
-    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, ambient);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, diffuse);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, specular);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, shininess);
+    gl_state_material(&material_ceiling);
     
     glBegin(GL_QUADS);
     glNormal3f(0.0f, -1.0f, 0.0f); // Normal hacia abajo
-    float ceiling_height = MAZE_LEVELS + 2.0f; // Techo más alto
+    float ceiling_height = CEILING_HEIGHT; // Techo más alto
     glVertex3f(-200.0f, ceiling_height, -200.0f);
     glVertex3f(200.0f, ceiling_height, -200.0f);
     glVertex3f(200.0f, ceiling_height, 200.0f);
     glVertex3f(-200.0f, ceiling_height, 200.0f);
     glEnd();
+    gl_state_count_draw(4);
 }
 
 void setup_fog() {
     // Configurar niebla EQUILIBRADA estilo Silent Hill - visible pero atmosférica
-    glEnable(GL_FOG);
-    glFogi(GL_FOG_MODE, GL_EXP2); // Usar niebla exponencial
-    glFogf(GL_FOG_DENSITY, 0.12f); // Densidad equilibrada - visible pero densa
-    glFogf(GL_FOG_START, 5.0f); // Comenzar la niebla CERCA
-    glFogf(GL_FOG_END, 25.0f); // Terminar la niebla a distancia media - equilibrada
-    
-    // Color de la niebla equilibrado y atmosférico
-    GLfloat fogColor[4] = {0.15f, 0.15f, 0.18f, 1.0f}; // Gris equilibrado
-    glFogfv(GL_FOG_COLOR, fogColor);
+    gl_state_enable(GL_FOG, true);
+    gl_state_fog(&fog_params);
+    
+    // Umbrales de LOD derivados de la misma niebla
+    lod_begin_frame(&fog_params);
 }
 
 void update_fog_distance() {
     // Mantener niebla EQUILIBRADA estilo Silent Hill - visible pero atmosférica
-    glFogf(GL_FOG_START, 5.0f);
-    glFogf(GL_FOG_END, 25.0f);
-    glFogf(GL_FOG_DENSITY, 0.12f);
+    gl_state_fog(&fog_params);
 }
 
 void setup_lighting() {
     // Configurar iluminación realista y dinámica
-    glEnable(GL_LIGHTING);
-    glEnable(GL_LIGHT0);
-    glEnable(GL_LIGHT1); // Luz adicional para el enemigo
-    glEnable(GL_LIGHT2); // Luz ambiental adicional
+    gl_state_enable(GL_LIGHTING, true);
+    gl_state_enable(GL_LIGHT0, true);
+    gl_state_enable(GL_LIGHT1, true); // Luz adicional para el enemigo
+    gl_state_enable(GL_LIGHT2, true); // Luz ambiental adicional
     
     // Configurar luz ambiental (más tenue para ambiente backrooms)
     GLfloat ambient[] = {0.3f, 0.3f, 0.3f, 1.0f};
-    glLightfv(GL_LIGHT0, GL_AMBIENT, ambient);
+    gl_state_light(GL_LIGHT0, GL_AMBIENT, ambient);
     
     // Configurar luz difusa (más realista)
     GLfloat diffuse[] = {0.8f, 0.8f, 0.7f, 1.0f};
-    glLightfv(GL_LIGHT0, GL_DIFFUSE, diffuse);
+    gl_state_light(GL_LIGHT0, GL_DIFFUSE, diffuse);
     
     // Configurar luz especular (más sutil)
     GLfloat specular[] = {0.4f, 0.4f, 0.4f, 1.0f};
-    glLightfv(GL_LIGHT0, GL_SPECULAR, specular);
+    gl_state_light(GL_LIGHT0, GL_SPECULAR, specular);
     
     // Configurar atenuación más realista
-    glLightf(GL_LIGHT0, GL_CONSTANT_ATTENUATION, 0.5f);
-    glLightf(GL_LIGHT0, GL_LINEAR_ATTENUATION, 0.1f);
-    glLightf(GL_LIGHT0, GL_QUADRATIC_ATTENUATION, 0.05f);
+    gl_state_lightf(GL_LIGHT0, GL_CONSTANT_ATTENUATION, 0.5f);
+    gl_state_lightf(GL_LIGHT0, GL_LINEAR_ATTENUATION, 0.1f);
+    gl_state_lightf(GL_LIGHT0, GL_QUADRATIC_ATTENUATION, 0.05f);
     
     // Configurar rango de la luz
-    glLightf(GL_LIGHT0, GL_SPOT_CUTOFF, 180.0f); // Luz omnidireccional
-    
-    // Configurar material por defecto más realista
-    GLfloat mat_ambient[] = {0.2f, 0.2f, 0.2f, 1.0f};
-    GLfloat mat_diffuse[] = {0.8f, 0.8f, 0.8f, 1.0f};
-    GLfloat mat_specular[] = {0.3f, 0.3f, 0.3f, 1.0f};
-    GLfloat mat_shininess[] = {64.0f};
-    
-    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, mat_ambient);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, mat_diffuse);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, mat_specular);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, mat_shininess);
+    gl_state_lightf(GL_LIGHT0, GL_SPOT_CUTOFF, 180.0f); // Luz omnidireccional
     
     // Habilitar sombras suaves
-    glEnable(GL_NORMALIZE);
+    gl_state_enable(GL_NORMALIZE, true);
 }
 
 void setup_enemy_lighting(float x, float y, float z) {
@@ -449,15 +501,15 @@ void setup_enemy_lighting(float x, float y, float z) {
     GLfloat specular[] = {0.8f, 0.0f, 0.0f, 1.0f};
     GLfloat position[] = {x, y, z, 1.0f}; // Luz puntual
     
-    glLightfv(GL_LIGHT1, GL_AMBIENT, ambient);
-    glLightfv(GL_LIGHT1, GL_DIFFUSE, diffuse);
-    glLightfv(GL_LIGHT1, GL_SPECULAR, specular);
-    glLightfv(GL_LIGHT1, GL_POSITION, position);
+    gl_state_light(GL_LIGHT1, GL_AMBIENT, ambient);
+    gl_state_light(GL_LIGHT1, GL_DIFFUSE, diffuse);
+    gl_state_light(GL_LIGHT1, GL_SPECULAR, specular);
+    gl_state_light(GL_LIGHT1, GL_POSITION, position);
     
     // Configurar atenuación para luz del enemigo (más rango)
-    glLightf(GL_LIGHT1, GL_CONSTANT_ATTENUATION, 1.0f);
-    glLightf(GL_LIGHT1, GL_LINEAR_ATTENUATION, 0.05f);
-    glLightf(GL_LIGHT1, GL_QUADRATIC_ATTENUATION, 0.02f);
+    gl_state_lightf(GL_LIGHT1, GL_CONSTANT_ATTENUATION, 1.0f);
+    gl_state_lightf(GL_LIGHT1, GL_LINEAR_ATTENUATION, 0.05f);
+    gl_state_lightf(GL_LIGHT1, GL_QUADRATIC_ATTENUATION, 0.02f);
 }
 
 void update_fog_based_on_lighting() {
@@ -476,87 +528,30 @@ void update_lighting() {
     
     // Configurar posición de la luz principal (linterna del jugador)
     GLfloat position[] = {light_x, light_y, light_z, 1.0f};
-    glLightfv(GL_LIGHT0, GL_POSITION, position);
+    gl_state_light(GL_LIGHT0, GL_POSITION, position);
     
     // Configurar luz ambiental dinámica basada en la posición
-    static float time_counter = 0.0f;
-    time_counter += 0.016f; // Aproximadamente 60 FPS
+    // El tiempo sale de los ticks de simulación, no de los frames dibujados
+    float time_counter = ((float)simulation_ticks + render_alpha - 1.0f) * SIMULATION_TICK_SECONDS;
     float ambient_intensity = 0.2f + 0.1f * sin(time_counter * 0.5f);
     GLfloat ambient[] = {ambient_intensity, ambient_intensity, ambient_intensity * 0.9f, 1.0f};
-    glLightfv(GL_LIGHT0, GL_AMBIENT, ambient);
+    gl_state_light(GL_LIGHT0, GL_AMBIENT, ambient);
     
     // Configurar luz ambiental adicional (LIGHT2) para iluminación general
     GLfloat ambient2[] = {0.1f, 0.1f, 0.1f, 1.0f};
     GLfloat diffuse2[] = {0.3f, 0.3f, 0.3f, 1.0f};
     GLfloat position2[] = {0.0f, 10.0f, 0.0f, 1.0f}; // Luz desde arriba
     
-    glLightfv(GL_LIGHT2, GL_AMBIENT, ambient2);
-    glLightfv(GL_LIGHT2, GL_DIFFUSE, diffuse2);
-    glLightfv(GL_LIGHT2, GL_POSITION, position2);
+    gl_state_light(GL_LIGHT2, GL_AMBIENT, ambient2);
+    gl_state_light(GL_LIGHT2, GL_DIFFUSE, diffuse2);
+    gl_state_light(GL_LIGHT2, GL_POSITION, position2);
     
     // Actualizar niebla basada en la iluminación
     update_fog_based_on_lighting();
 }
 
-void render_world() {
-    // Verificar que el mapa esté precargado
-    if (!is_map_ready()) {
-        render_map_loading_screen();
-        return;
-    }
-    
-    // Limpiar buffers con depth testing
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    
-    // Asegurar que depth testing esté habilitado
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
-    glDepthMask(GL_TRUE);
-    
-    // Deshabilitar blending para muros sólidos
-    glDisable(GL_BLEND);
-    
-    // Configurar la cámara
-    setup_camera();
-    
-    // Configurar iluminación
-    setup_lighting();
-    
-    // Configurar niebla
-    setup_fog();
-    
-    // Actualizar niebla dinámicamente
-    update_fog_distance();
-    
-    // Forzar configuración de niebla EQUILIBRADA estilo Silent Hill en cada frame
-    glEnable(GL_FOG);
-    glFogi(GL_FOG_MODE, GL_EXP2);
-    glFogf(GL_FOG_DENSITY, 0.12f); // Densidad equilibrada - visible pero densa
-    glFogf(GL_FOG_START, 5.0f); // CERCA
-    glFogf(GL_FOG_END, 25.0f); // DISTANCIA MEDIA - equilibrada
-    GLfloat fogColor[4] = {0.15f, 0.15f, 0.18f, 1.0f}; // Equilibrado
-    glFogfv(GL_FOG_COLOR, fogColor);
-    
-    // Actualizar iluminación dinámica (cada 3 frames para mejor rendimiento)
-    static int lighting_frame_counter = 0;
-    if (lighting_frame_counter % 3 == 0) {
-        update_lighting();
-    }
-    lighting_frame_counter++;
-    
-    // Actualizar partículas
-    update_particles();
-    
-    // Dibujar suelo y techo DESPUÉS de configurar la niebla
-    // (para que estén afectados por la niebla densa)
-    draw_floor();
-    draw_terrain_variations(); // Añadir variaciones del terreno
-    draw_ceiling();
-    
-    // Renderizar el laberinto 3D basado en la PERSPECTIVA DE LA CÁMARA
-    // Calcular rango de renderizado basado en la dirección de la cámara
-    float render_distance = 35.0f; // Distancia aumentada para área de carga más grande
-    
+// Ruta original en modo inmediato: un cubo por nivel y por celda
+static void draw_walls_immediate(float render_distance) {
     // Optimización: usar distancia al cuadrado para evitar sqrt costoso
     float render_distance_sq = render_distance * render_distance;
     
@@ -568,104 +563,216 @@ void render_world() {
     
     // Limitar a los bordes del mapa
     if (start_x < 0) start_x = 0;
-    if (end_x >= MAZE_WIDTH) end_x = MAZE_WIDTH - 1;
+    if (end_x >= maze_width) end_x = maze_width - 1;
     if (start_z < 0) start_z = 0;
-    if (end_z >= MAZE_HEIGHT) end_z = MAZE_HEIGHT - 1;
+    if (end_z >= maze_height) end_z = maze_height - 1;
+    
+    // Chunks potencialmente visibles desde la celda del jugador (NULL = sin PVS)
+    const unsigned char* pvs = pvs_lookup(player.x, player.z);
+    int chunk_cols = (maze_width + WALL_CHUNK_SIZE - 1) / WALL_CHUNK_SIZE;
     
     // Renderizar basado en la perspectiva de la cámara
     // Priorizar objetos en la dirección de la mirada del jugador
     for (int x = start_x; x <= end_x; x++) {
         for (int z = start_z; z <= end_z; z++) {
-            if (maze[x][z] == 1) { // Si hay una pared
+            if (maze_cell(x, z) == 0) continue;
+            if (pvs && !pvs_bit(pvs, (z / WALL_CHUNK_SIZE) * chunk_cols + x / WALL_CHUNK_SIZE)) continue;
+            
+            if (maze_cell(x, z) == 1) { // Si hay una pared
                 // Calcular distancia al cuadrado (más eficiente que sqrt)
                 float dx = x - player.x;
                 float dz = z - player.z;
                 float distance_sq = dx * dx + dz * dz;
                 
                 // Verificar distancia primero (más rápido)
-                if (distance_sq <= render_distance_sq) {
-                    // Solo calcular sqrt cuando sea necesario
-                    float distance = sqrt(distance_sq);
-                    
-                    // Sistema de prioridades: objetos cercanos siempre se renderizan
-                    bool should_render = false;
-                    int levels = MAZE_LEVELS;
-                    
-                    if (distance <= 25.0f) {
-                        // Zona cercana: siempre renderizar (área de carga aumentada)
-                        should_render = true;
-                        levels = MAZE_LEVELS;
-                    } else if (distance <= 35.0f) {
-                        // Zona media: renderizar con frustum culling basado en perspectiva
-                        should_render = is_in_frustum(x, z);
-                        levels = MAZE_LEVELS;
-                    } else {
-                        // Zona lejana: NO RENDERIZAR (oculto por niebla)
-                        should_render = false;
-                        levels = 0;
-                    }
-                    
-                    if (should_render) {
-                        // Material ya configurado en draw_tall_wall
-                        glDisable(GL_BLEND);
-                        glDepthMask(GL_TRUE);
-                        
-                        // Dibujar pared con altura optimizada
-                        draw_tall_wall(x, z, levels);
+                if (distance_sq <= render_distance_sq && occlusion_cell_visible(x, z)) {
+                    // Frustum real: caja de la celda contra los 6 planos
+                    if (cell_in_frustum(x, z, (float)MAZE_LEVELS)) {
+                        // Cerca: cubos apilados (iluminación por vértice en cada nivel);
+                        // más lejos la niebla la aplana y basta un bloque fusionado
+                        if (lod_cell_tier(x, z, distance_sq) == LOD_TIER_NEAR) {
+                            draw_tall_wall(x, z, MAZE_LEVELS);
+                        } else {
+                            draw_wall_slab(x, z, (float)MAZE_LEVELS);
+                        }
                     }
                 }
-            } else if (maze[x][z] == 2) { // Elementos decorativos
+            } else if (maze_cell(x, z) == 2) { // Elementos decorativos
                 // Calcular distancia al cuadrado (más eficiente)
                 float dx = x - player.x;
                 float dz = z - player.z;
                 float distance_sq = dx * dx + dz * dz;
                 float decor_distance_sq = 35.0f * 35.0f;
                 
-                // Sistema de prioridades para elementos decorativos
-                if (distance_sq <= decor_distance_sq) {
-                    float distance = sqrt(distance_sq);
-                    bool should_render = false;
-                    float size = 0.2f;
-                    
-                    if (distance <= 20.0f) {
-                        // Zona cercana: siempre renderizar (área de carga aumentada)
-                        should_render = true;
-                        size = 0.2f;
-                    } else if (distance <= 35.0f) {
-                        // Zona media: con frustum culling basado en perspectiva
-                        should_render = is_in_frustum(x, z);
-                        size = 0.2f;
-                    } else {
-                        // Zona lejana: NO RENDERIZAR (oculto por niebla)
-                        should_render = false;
-                        size = 0.0f;
-                    }
-                    
-                    if (should_render) {
-                        glDisable(GL_BLEND);
-                        glDepthMask(GL_TRUE);
-                        
+                // Elementos decorativos dentro del rango y del frustum
+                if (distance_sq <= decor_distance_sq && occlusion_cell_visible(x, z)) {
+                    if (cell_in_frustum(x, z, 0.4f) && lod_cell_tier(x, z, distance_sq) != LOD_TIER_FAR) {
                         // Dibujar elemento decorativo optimizado
-                        draw_cube(x, 0.3f, z, size);
+                        draw_cube(x, 0.3f, z, 0.2f);
                     }
                 }
             }
         }
     }
+}
+
+// Envoltorios para la pasada opaca ordenada por material
+static void draw_floor_queued(void* data) {
+    (void)data;
+    profiler_begin(PROFILE_RENDER_FLOOR);
+    lightmap_bind(LIGHTMAP_SURFACE_FLOOR);
+    draw_floor();
+    lightmap_unbind();
+    profiler_end(PROFILE_RENDER_FLOOR);
+}
+
+static void draw_terrain_queued(void* data) {
+    (void)data;
+    profiler_begin(PROFILE_RENDER_FLOOR);
+    lightmap_bind(LIGHTMAP_SURFACE_FLOOR);
+    draw_terrain_variations();
+    lightmap_unbind();
+    profiler_end(PROFILE_RENDER_FLOOR);
+}
+
+static void draw_ceiling_queued(void* data) {
+    (void)data;
+    profiler_begin(PROFILE_RENDER_FLOOR);
+    lightmap_bind(LIGHTMAP_SURFACE_CEILING);
+    draw_ceiling();
+    lightmap_unbind();
+    profiler_end(PROFILE_RENDER_FLOOR);
+}
+
+// Suelo y techo fundidos en los mismos chunks que los muros
+static void draw_floor_chunks_queued(void* data) {
+    (void)data;
+    profiler_begin(PROFILE_RENDER_FLOOR);
+    render_floor_chunks();
+    profiler_end(PROFILE_RENDER_FLOOR);
+}
+
+static void draw_ceiling_chunks_queued(void* data) {
+    (void)data;
+    profiler_begin(PROFILE_RENDER_FLOOR);
+    render_ceiling_chunks();
+    profiler_end(PROFILE_RENDER_FLOOR);
+}
+
+static void draw_walls_queued(void* data) {
+    float render_distance = *(float*)data;
+    profiler_begin(PROFILE_RENDER_WALLS);
+    if (wall_render_mode == WALL_RENDER_INSTANCED && instancing_ready) {
+        // Una llamada para todos los muros y otra para toda la decoración
+        render_instanced_walls(render_distance);
+    } else if (wall_render_mode != WALL_RENDER_IMMEDIATE && wall_mesh_ready) {
+        // Geometría precalculada (y respaldo sin instancing): una llamada por chunk visible
+        render_wall_chunks();
+    } else {
+        draw_walls_immediate(render_distance);
+    }
+    profiler_end(PROFILE_RENDER_WALLS);
+}
+
+void render_world() {
+    // Contadores de la caché de estado por frame
+    gl_state_begin_frame();
+    
+    // Verificar que el mapa esté precargado
+    if (!is_map_ready()) {
+        render_map_loading_screen();
+        return;
+    }
+    profiler_begin(PROFILE_RENDER_WORLD);
+    
+    // Limpiar buffers con el color de la niebla: suelo y techo terminan en la distancia
+    // de render y más allá la niebla ya es opaca (el resto de pantallas sigue en negro)
+    glClearColor(fog_params.color[0], fog_params.color[1], fog_params.color[2], 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    
+    // Asegurar que depth testing esté habilitado
+    gl_state_enable(GL_DEPTH_TEST, true);
+    gl_state_depth_func(GL_LESS);
+    gl_state_depth_mask(GL_TRUE);
+    
+    // Deshabilitar blending para muros sólidos
+    gl_state_enable(GL_BLEND, false);
+    
+    // Configurar la cámara
+    setup_camera();
+    
+    // Extraer los planos del frustum de las matrices actuales
+    frustum_update();
+    
+    // Configurar iluminación
+    setup_lighting();
+    
+    // Configurar niebla (una sola vez: la caché descarta lo que no cambia)
+    setup_fog();
+    
+    // Actualizar iluminación dinámica (cada 3 frames para mejor rendimiento)
+    static int lighting_frame_counter = 0;
+    if (lighting_frame_counter % 3 == 0) {
+        update_lighting();
+    }
+    lighting_frame_counter++;
+    
+    // Renderizar el laberinto 3D basado en la PERSPECTIVA DE LA CÁMARA
+    float render_distance = 35.0f; // Distancia aumentada para área de carga más grande
+    
+    // Raycasting 2D desde la celda del jugador: solo las celdas alcanzadas llegan al render
+    occlusion_update(render_distance);
+    
+    // Chunks visibles (frustum + PVS + oclusión), compartidos por muros, suelo y techo
+    bool chunk_meshes = wall_render_mode != WALL_RENDER_IMMEDIATE && wall_mesh_ready;
+    if (chunk_meshes) update_chunk_visibility(render_distance);
+    
+    // Luces del mapa: horneadas en lightmaps para los chunks y por clusters en GLSL
+    // para el instancing. La ruta inmediata queda como referencia con iluminación fija
+    // (sus glMaterial entre glBegin/glEnd no llegan al shader de forma fiable en todos los drivers)
+    bool baked_lights = wall_render_mode == WALL_RENDER_CHUNKS && lightmaps_ready;
+    bool clustered_lights = !baked_lights && wall_render_mode != WALL_RENDER_IMMEDIATE;
+    if (clustered_lights) update_light_clusters(render_distance);
+    
+    // Pasada opaca ordenada por material. Suelo y techo van DESPUÉS de
+    // configurar la niebla (para que estén afectados por la niebla densa)
+    if (chunk_meshes) {
+        gl_state_submit(&material_floor, draw_floor_chunks_queued, NULL);
+        gl_state_submit(&material_ceiling, draw_ceiling_chunks_queued, NULL);
+    } else {
+        // Referencia inmediata: planos grandes y subniveles originales
+        gl_state_submit(&material_floor, draw_floor_queued, NULL);
+        gl_state_submit(&material_terrain, draw_terrain_queued, NULL); // Variaciones del terreno
+        gl_state_submit(&material_ceiling, draw_ceiling_queued, NULL);
+    }
+    gl_state_submit(&material_wall, draw_walls_queued, &render_distance);
+    if (baked_lights) lightmap_begin();
+    if (clustered_lights) clustered_lighting_begin();
+    gl_state_flush_draws();
+    clustered_lighting_end();
+    lightmap_end();
     
     // Renderizar enemigo 3D
+    profiler_begin(PROFILE_RENDER_ENEMY);
     render_enemy_3d();
+    profiler_end(PROFILE_RENDER_ENEMY);
     
     // Mini mapa eliminado para mejor rendimiento
     
     // Renderizar partículas
+    profiler_begin(PROFILE_RENDER_PARTICLES);
     render_particles();
+    profiler_end(PROFILE_RENDER_PARTICLES);
+    profiler_end(PROFILE_RENDER_WORLD);
 }
 
 // Todas las funciones del minimapa eliminadas para mejor rendimiento
 
 void cleanup_renderer() {
     // Limpiar recursos del renderizador
+    cleanup_particles();
+    cleanup_lod();
     // Funciones del minimapa eliminadas para mejor rendimiento
 }
 
@@ -683,52 +790,20 @@ void render_map_loading_screen() {
     glPushMatrix();
     glLoadIdentity();
     
-    // Deshabilitar depth testing para la pantalla de carga
-    glDisable(GL_DEPTH_TEST);
+    // Deshabilitar depth testing, culling (la Y va hacia abajo) e iluminación para la pantalla de carga
+    gl_state_enable(GL_DEPTH_TEST, false);
+    gl_state_enable(GL_CULL_FACE, false);
+    gl_state_enable(GL_LIGHTING, false);
     
     // Fondo negro
-    glColor3f(0.0f, 0.0f, 0.0f);
-    glBegin(GL_QUADS);
-    glVertex2f(0, 0);
-    glVertex2f(windowWidth, 0);
-    glVertex2f(windowWidth, windowHeight);
-    glVertex2f(0, windowHeight);
-    glEnd();
-    
-    // Texto de carga (simulado con rectángulos)
-    glColor3f(1.0f, 1.0f, 1.0f);
+    ui_rect(0.0f, 0.0f, (float)windowWidth, (float)windowHeight, 0.0f, 0.0f, 0.0f, 1.0f);
     
-    // Título
-    float titleX = windowWidth / 2.0f - 200.0f;
+    // Título centrado (stb_easy_font escalado x4)
+    const char* title = "PRECARGANDO MAPA";
+    float titleScale = 4.0f;
+    float titleX = windowWidth / 2.0f - ui_text_width(title) * titleScale / 2.0f;
     float titleY = windowHeight / 2.0f - 100.0f;
-    
-    // Dibujar "PRECARGANDO MAPA" como rectángulos
-    glBegin(GL_QUADS);
-    // P
-    glVertex2f(titleX, titleY);
-    glVertex2f(titleX + 20, titleY);
-    glVertex2f(titleX + 20, titleY + 40);
-    glVertex2f(titleX, titleY + 40);
-    glVertex2f(titleX, titleY + 20);
-    glVertex2f(titleX + 15, titleY + 20);
-    glVertex2f(titleX + 15, titleY + 10);
-    glVertex2f(titleX, titleY + 10);
-    // R
-    glVertex2f(titleX + 30, titleY);
-    glVertex2f(titleX + 50, titleY);
-    glVertex2f(titleX + 50, titleY + 40);
-    glVertex2f(titleX + 30, titleY + 40);
-    // E
-    glVertex2f(titleX + 60, titleY);
-    glVertex2f(titleX + 80, titleY);
-    glVertex2f(titleX + 80, titleY + 40);
-    glVertex2f(titleX + 60, titleY + 40);
-    // C
-    glVertex2f(titleX + 90, titleY);
-    glVertex2f(titleX + 110, titleY);
-    glVertex2f(titleX + 110, titleY + 40);
-    glVertex2f(titleX + 90, titleY + 40);
-    glEnd();
+    ui_text(title, titleX, titleY, titleScale, titleScale, 1.0f, 1.0f, 1.0f);
     
     // Barra de progreso
     float progressBarX = windowWidth / 2.0f - 150.0f;
@@ -737,26 +812,23 @@ void render_map_loading_screen() {
     float progressBarHeight = 20.0f;
     
     // Fondo de la barra
-    glColor3f(0.3f, 0.3f, 0.3f);
-    glBegin(GL_QUADS);
-    glVertex2f(progressBarX, progressBarY);
-    glVertex2f(progressBarX + progressBarWidth, progressBarY);
-    glVertex2f(progressBarX + progressBarWidth, progressBarY + progressBarHeight);
-    glVertex2f(progressBarX, progressBarY + progressBarHeight);
-    glEnd();
+    ui_rect(progressBarX, progressBarY, progressBarWidth, progressBarHeight, 0.3f, 0.3f, 0.3f, 1.0f);
     
-    // Barra de progreso (animada)
-    static float progress = 0.0f;
-    progress += 0.5f;
-    if (progress > progressBarWidth) progress = 0.0f;
+    // Progreso real publicado por el hilo que genera el mapa
+    float progress = map_generation_progress();
+    ui_rect(progressBarX, progressBarY, progressBarWidth * progress, progressBarHeight, 0.0f, 1.0f, 0.0f, 1.0f);
     
-    glColor3f(0.0f, 1.0f, 0.0f);
-    glBegin(GL_QUADS);
-    glVertex2f(progressBarX, progressBarY);
-    glVertex2f(progressBarX + progress, progressBarY);
-    glVertex2f(progressBarX + progress, progressBarY + progressBarHeight);
-    glVertex2f(progressBarX, progressBarY + progressBarHeight);
-    glEnd();
+    // Etapa actual y porcentaje bajo la barra
+    char stageText[64];
+    snprintf(stageText, sizeof(stageText), "%s  %d%%", map_stage_name(map_generation_stage()),
+             (int)(progress * 100.0f));
+    float stageScale = 2.0f;
+    float stageX = windowWidth / 2.0f - ui_text_width(stageText) * stageScale / 2.0f;
+    ui_text(stageText, stageX, progressBarY + progressBarHeight + 12.0f, stageScale, stageScale,
+            0.8f, 0.8f, 0.8f);
+    
+    // Toda la pantalla en una sola llamada de dibujo
+    ui_flush();
     
     // Restaurar matrices
     glPopMatrix();
@@ -764,8 +836,10 @@ void render_map_loading_screen() {
     glPopMatrix();
     glMatrixMode(GL_MODELVIEW);
     
-    // Rehabilitar depth testing
-    glEnable(GL_DEPTH_TEST);
+    // Rehabilitar el estado del mundo 3D
+    gl_state_enable(GL_LIGHTING, true);
+    gl_state_enable(GL_CULL_FACE, true);
+    gl_state_enable(GL_DEPTH_TEST, true);
 }
 
 // Función cleanup_renderer ya definida anteriormente
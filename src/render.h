@@ -4,6 +4,7 @@
 
 #include <GL/gl.h>
 #include <GL/glu.h>
+#include "gl_state.h"
 
 // Constantes de niebla EQUILIBRADA estilo Silent Hill - visible pero atmosférica
 #define FOG_START_DISTANCE 5.0f
@@ -15,12 +16,18 @@
 #define LIGHT_INTENSITY 1.0f
 #define LIGHT_ATTENUATION 0.3f
 
+// Rutas de renderizado de muros
+#define WALL_RENDER_IMMEDIATE 0  // Cubos en modo inmediato (ruta original)
+#define WALL_RENDER_CHUNKS 1     // Chunks precalculados en VBO
+#define WALL_RENDER_INSTANCED 2  // Una instancia por celda visible (requiere GLSL)
+
 // Funciones de renderizado 3D
 void init_renderer();
 void setup_camera();
 void render_world();
 void draw_cube(float x, float y, float z, float size);
 void draw_tall_wall(int x, int z, int levels);
+void draw_wall_slab(int x, int z, float height);
 void draw_floor();
 void draw_ceiling();
 void draw_terrain_variations();
@@ -41,6 +48,10 @@ void render_map_loading_screen();
 void setup_additional_lights();
 void cleanup_renderer();
 
+// Interpolación del render entre los dos últimos ticks de simulación
+extern float render_alpha;                  // Fracción del tick transcurrida (1 = último tick)
+extern unsigned long simulation_ticks;      // Ticks completados (los cuenta el bucle principal)
+
 // Variables de niebla
 extern float fog_start;
 extern float fog_end;
@@ -52,4 +63,22 @@ extern float light_y;
 extern float light_z;
 extern float light_range;
 
+// Materiales compartidos (los lightmaps hornean la luz ya multiplicada por su difuso)
+extern const GLMaterial material_wall;
+extern const GLMaterial material_floor;
+extern const GLMaterial material_ceiling;
+
+// Ruta de renderizado de muros activa
+extern int wall_render_mode;
+
+// Base de la cámara fijada por setup_camera() (orienta los billboards)
+typedef struct {
+    float eye[3];
+    float forward[3];
+    float right[3];
+    float up[3];
+} CameraBasis;
+
+extern CameraBasis camera_basis;
+
 #endif // RENDER_H
@@ -0,0 +1,239 @@
+// thread_pool.c - Pool de hilos de trabajo para tareas paralelas
+#include "thread_pool.h"
+#include <stdio.h>
+
+#ifdef _WIN32
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0600  // Variables de condición (Vista+)
+#endif
+#include <windows.h>
+typedef HANDLE PoolThread;
+typedef CRITICAL_SECTION PoolMutex;
+typedef CONDITION_VARIABLE PoolCond;
+#define pool_mutex_init(m) InitializeCriticalSection(m)
+#define pool_mutex_destroy(m) DeleteCriticalSection(m)
+#define pool_mutex_lock(m) EnterCriticalSection(m)
+#define pool_mutex_unlock(m) LeaveCriticalSection(m)
+#define pool_cond_init(c) InitializeConditionVariable(c)
+#define pool_cond_destroy(c) ((void)(c))
+#define pool_cond_wait(c, m) SleepConditionVariableCS(c, m, INFINITE)
+#define pool_cond_broadcast(c) WakeAllConditionVariable(c)
+#else
+#include <pthread.h>
+#include <unistd.h>
+typedef pthread_t PoolThread;
+typedef pthread_mutex_t PoolMutex;
+typedef pthread_cond_t PoolCond;
+#define pool_mutex_init(m) pthread_mutex_init(m, NULL)
+#define pool_mutex_destroy(m) pthread_mutex_destroy(m)
+#define pool_mutex_lock(m) pthread_mutex_lock(m)
+#define pool_mutex_unlock(m) pthread_mutex_unlock(m)
+#define pool_cond_init(c) pthread_cond_init(c, NULL)
+#define pool_cond_destroy(c) pthread_cond_destroy(c)
+#define pool_cond_wait(c, m) pthread_cond_wait(c, m)
+#define pool_cond_broadcast(c) pthread_cond_broadcast(c)
+#endif
+
+// Estado del pool
+static PoolThread workers[THREAD_POOL_MAX_THREADS];
+static int worker_count = 0;
+static PoolMutex pool_mutex;
+static PoolCond work_ready;
+static PoolCond work_done;
+static bool pool_running = false;
+
+// Trabajo en curso (protegido por pool_mutex salvo next_index)
+static ThreadTask current_task = NULL;
+static void* current_data = NULL;
+static int current_count = 0;
+static volatile long next_index = 0;
+static int pending_workers = 0;
+static unsigned int generation = 0;
+
+// Ejecutar índices hasta agotar el trabajo
+static void drain_tasks(ThreadTask task, void* data, int count) {
+    for (;;) {
+        long index = atomic_add_long(&next_index, 1) - 1;
+        if (index >= count) break;
+        task(data, (int)index);
+    }
+}
+
+static void worker_loop() {
+    unsigned int seen_generation = 0;
+
+    pool_mutex_lock(&pool_mutex);
+    for (;;) {
+        while (pool_running && generation == seen_generation) {
+            pool_cond_wait(&work_ready, &pool_mutex);
+        }
+        if (!pool_running) break;
+
+        seen_generation = generation;
+        ThreadTask task = current_task;
+        void* data = current_data;
+        int count = current_count;
+        pool_mutex_unlock(&pool_mutex);
+
+        drain_tasks(task, data, count);
+
+        pool_mutex_lock(&pool_mutex);
+        if (--pending_workers == 0) {
+            pool_cond_broadcast(&work_done);
+        }
+    }
+    pool_mutex_unlock(&pool_mutex);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI worker_main(LPVOID param) {
+    worker_loop();
+    return 0;
+}
+#else
+static void* worker_main(void* param) {
+    worker_loop();
+    return NULL;
+}
+#endif
+
+// Hilo de fondo
+static PoolThread background_thread;
+static bool background_started = false;
+static BackgroundTask background_task = NULL;
+static void* background_data = NULL;
+
+#ifdef _WIN32
+static DWORD WINAPI background_main(LPVOID param) {
+    (void)param;
+    background_task(background_data);
+    return 0;
+}
+#else
+static void* background_main(void* param) {
+    (void)param;
+    background_task(background_data);
+    return NULL;
+}
+#endif
+
+static int detect_core_count() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (int)cores : 1;
+#endif
+}
+
+void init_thread_pool(int thread_count) {
+    if (pool_running) return;
+
+    // El hilo principal también trabaja, así que se crean núcleos - 1 hilos
+    if (thread_count <= 0) thread_count = detect_core_count() - 1;
+    if (thread_count > THREAD_POOL_MAX_THREADS) thread_count = THREAD_POOL_MAX_THREADS;
+    if (thread_count < 0) thread_count = 0;
+
+    pool_mutex_init(&pool_mutex);
+    pool_cond_init(&work_ready);
+    pool_cond_init(&work_done);
+    pool_running = true;
+    generation = 0;
+
+    worker_count = 0;
+    for (int i = 0; i < thread_count; i++) {
+#ifdef _WIN32
+        workers[i] = CreateThread(NULL, 0, worker_main, NULL, 0, NULL);
+        if (workers[i] == NULL) break;
+#else
+        if (pthread_create(&workers[i], NULL, worker_main, NULL) != 0) break;
+#endif
+        worker_count++;
+    }
+
+    printf("Pool de hilos inicializado: %d hilos de trabajo + hilo principal\n", worker_count);
+}
+
+void thread_pool_run(ThreadTask task, void* data, int count) {
+    if (count <= 0) return;
+
+    // Sin pool (o una sola tarea): ejecutar en el hilo actual
+    if (!pool_running || worker_count == 0 || count == 1) {
+        for (int i = 0; i < count; i++) task(data, i);
+        return;
+    }
+
+    pool_mutex_lock(&pool_mutex);
+    current_task = task;
+    current_data = data;
+    current_count = count;
+    atomic_store_long(&next_index, 0);
+    pending_workers = worker_count;
+    generation++;
+    pool_cond_broadcast(&work_ready);
+    pool_mutex_unlock(&pool_mutex);
+
+    // El hilo que llama también consume tareas
+    drain_tasks(task, data, count);
+
+    pool_mutex_lock(&pool_mutex);
+    while (pending_workers > 0) {
+        pool_cond_wait(&work_done, &pool_mutex);
+    }
+    current_task = NULL;
+    pool_mutex_unlock(&pool_mutex);
+}
+
+int thread_pool_size() {
+    return worker_count + 1;
+}
+
+void cleanup_thread_pool() {
+    if (!pool_running) return;
+
+    pool_mutex_lock(&pool_mutex);
+    pool_running = false;
+    pool_cond_broadcast(&work_ready);
+    pool_mutex_unlock(&pool_mutex);
+
+    for (int i = 0; i < worker_count; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(workers[i], INFINITE);
+        CloseHandle(workers[i]);
+#else
+        pthread_join(workers[i], NULL);
+#endif
+    }
+    worker_count = 0;
+
+    pool_cond_destroy(&work_ready);
+    pool_cond_destroy(&work_done);
+    pool_mutex_destroy(&pool_mutex);
+}
+
+bool start_background_task(BackgroundTask task, void* data) {
+    if (background_started) return false;
+
+    background_task = task;
+    background_data = data;
+#ifdef _WIN32
+    background_thread = CreateThread(NULL, 0, background_main, NULL, 0, NULL);
+    background_started = background_thread != NULL;
+#else
+    background_started = pthread_create(&background_thread, NULL, background_main, NULL) == 0;
+#endif
+    return background_started;
+}
+
+void wait_background_task() {
+    if (!background_started) return;
+#ifdef _WIN32
+    WaitForSingleObject(background_thread, INFINITE);
+    CloseHandle(background_thread);
+#else
+    pthread_join(background_thread, NULL);
+#endif
+    background_started = false;
+}
@@ -0,0 +1,37 @@
+// thread_pool.h - Pool de hilos de trabajo para tareas paralelas
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stdbool.h>
+
+#define THREAD_POOL_MAX_THREADS 16
+
+// Tarea paralela: se llama una vez por índice en [0, count)
+typedef void (*ThreadTask)(void* data, int index);
+
+// Funciones del pool
+void init_thread_pool(int thread_count);   // 0 = número de núcleos
+void thread_pool_run(ThreadTask task, void* data, int count);
+int thread_pool_size();
+void cleanup_thread_pool();
+
+// Hilo de fondo aparte del pool para trabajos largos que no deben bloquear
+// el hilo principal (uno a la vez; wait_background_task lo espera y lo libera)
+typedef void (*BackgroundTask)(void* data);
+bool start_background_task(BackgroundTask task, void* data);
+void wait_background_task();
+
+// Operaciones atómicas básicas (GCC/MinGW)
+static inline long atomic_load_long(volatile long* value) {
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static inline void atomic_store_long(volatile long* value, long new_value) {
+    __atomic_store_n(value, new_value, __ATOMIC_RELEASE);
+}
+
+static inline long atomic_add_long(volatile long* value, long amount) {
+    return __atomic_add_fetch(value, amount, __ATOMIC_ACQ_REL);
+}
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,22 @@
+// timer.c - Reloj monotónico en segundos
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 199309L  // clock_gettime
+#endif
+#include "timer.h"
+
+#ifndef _WIN32
+#include <time.h>
+
+double timer_seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+#else
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+double timer_seconds() {
+    return glfwGetTime();
+}
+#endif
@@ -0,0 +1,9 @@
+// timer.h - Reloj monotónico en segundos para el bucle, el profiler y el benchmark
+#ifndef TIMER_H
+#define TIMER_H
+
+// Linux: clock_gettime(CLOCK_MONOTONIC), sin depender de que GLFW esté inicializado
+// (el benchmark sin ventana no lo inicializa). Windows: el reloj de GLFW
+double timer_seconds();
+
+#endif // TIMER_H
@@ -0,0 +1,210 @@
+// ui_batch.c - Lote 2D para interfaz y texto (una llamada de dibujo por frame)
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include "ui_batch.h"
+#include "gl_ext.h"
+#include <GL/gl.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+// stb_easy_font inicializa un struct sin llaves internas (aviso de -Wall)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-braces"
+#include "stb_easy_font.h"
+#pragma GCC diagnostic pop
+
+// Vértice del lote: posición y color empaquetado (12 bytes)
+typedef struct {
+    float x, y;
+    unsigned char color[4];
+} UIVertex;
+
+// Quads de un texto ya generados por stb_easy_font, relativos a su origen
+typedef struct {
+    unsigned int hash;
+    char text[UI_TEXT_MAX_LENGTH + 1];
+    float* positions;       // Pares x, y (4 vértices por quad)
+    int vertex_count;
+} UITextEntry;
+
+UIBatchStats ui_batch_stats = {0, 0, 0, 0};
+
+static UIVertex vertices[UI_BATCH_MAX_QUADS * 4];
+static int vertex_count = 0;
+static GLuint batch_vbo = 0;
+
+static UITextEntry text_cache[UI_TEXT_CACHE_SIZE];
+static int frame_quads = 0;
+static int frame_hits = 0;
+static int frame_misses = 0;
+static int frame_draw_calls = 0;
+
+// Salida de stb_easy_font (16 bytes por vértice); solo se usa al fallar la caché
+static char glyph_scratch[UI_TEXT_MAX_LENGTH * 64 * 16 * 4];
+
+void init_ui_batch() {
+    memset(text_cache, 0, sizeof(text_cache));
+    vertex_count = 0;
+    if (gl_has_vbo && !batch_vbo) {
+        glGenBuffers(1, &batch_vbo);
+    }
+}
+
+static void draw_batch() {
+    if (vertex_count == 0) return;
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    if (batch_vbo) {
+        // Se reserva de nuevo en cada envío para no esperar al frame anterior
+        glBindBuffer(GL_ARRAY_BUFFER, batch_vbo);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(sizeof(UIVertex) * vertex_count), vertices, GL_STREAM_DRAW);
+        glVertexPointer(2, GL_FLOAT, sizeof(UIVertex), (const void*)0);
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(UIVertex), (const void*)offsetof(UIVertex, color));
+    } else {
+        glVertexPointer(2, GL_FLOAT, sizeof(UIVertex), &vertices[0].x);
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(UIVertex), vertices[0].color);
+    }
+    glDrawArrays(GL_QUADS, 0, vertex_count);
+    if (batch_vbo) glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    frame_quads += vertex_count / 4;
+    frame_draw_calls++;
+    vertex_count = 0;
+}
+
+// Hueco para un quad; si el lote está lleno se dibuja lo acumulado
+static UIVertex* reserve_quad() {
+    if (vertex_count + 4 > UI_BATCH_MAX_QUADS * 4) draw_batch();
+    UIVertex* quad = &vertices[vertex_count];
+    vertex_count += 4;
+    return quad;
+}
+
+static void set_vertex(UIVertex* vertex, float x, float y, const unsigned char* color) {
+    vertex->x = x;
+    vertex->y = y;
+    memcpy(vertex->color, color, 4);
+}
+
+static void pack_color(unsigned char* color, float r, float g, float b, float a) {
+    color[0] = (unsigned char)(r * 255.0f + 0.5f);
+    color[1] = (unsigned char)(g * 255.0f + 0.5f);
+    color[2] = (unsigned char)(b * 255.0f + 0.5f);
+    color[3] = (unsigned char)(a * 255.0f + 0.5f);
+}
+
+void ui_rect(float x, float y, float width, float height, float r, float g, float b, float a) {
+    unsigned char color[4];
+    pack_color(color, r, g, b, a);
+    UIVertex* quad = reserve_quad();
+    set_vertex(&quad[0], x, y, color);
+    set_vertex(&quad[1], x + width, y, color);
+    set_vertex(&quad[2], x + width, y + height, color);
+    set_vertex(&quad[3], x, y + height, color);
+}
+
+void ui_line(float x0, float y0, float x1, float y1, float thickness, float r, float g, float b, float a) {
+    // Quad a lo largo del segmento, desplazado media anchura por la normal
+    float dx = x1 - x0, dy = y1 - y0;
+    float length = sqrtf(dx * dx + dy * dy);
+    if (length <= 0.0f) return;
+    float nx = -dy / length * thickness * 0.5f;
+    float ny = dx / length * thickness * 0.5f;
+
+    unsigned char color[4];
+    pack_color(color, r, g, b, a);
+    UIVertex* quad = reserve_quad();
+    set_vertex(&quad[0], x0 + nx, y0 + ny, color);
+    set_vertex(&quad[1], x0 - nx, y0 - ny, color);
+    set_vertex(&quad[2], x1 - nx, y1 - ny, color);
+    set_vertex(&quad[3], x1 + nx, y1 + ny, color);
+}
+
+// FNV-1a sobre el texto (recortado a UI_TEXT_MAX_LENGTH)
+static unsigned int hash_text(const char* text, int* length) {
+    unsigned int hash = 2166136261u;
+    int i = 0;
+    for (; text[i] && i < UI_TEXT_MAX_LENGTH; i++) {
+        hash = (hash ^ (unsigned char)text[i]) * 16777619u;
+    }
+    *length = i;
+    return hash;
+}
+
+// Quads del texto desde la caché; al fallar se generan una vez con stb_easy_font
+static const UITextEntry* cached_text(const char* text) {
+    int length;
+    unsigned int hash = hash_text(text, &length);
+    UITextEntry* entry = &text_cache[hash % UI_TEXT_CACHE_SIZE];
+    if (entry->positions && entry->hash == hash &&
+        strncmp(entry->text, text, length) == 0 && entry->text[length] == '\0') {
+        frame_hits++;
+        return entry;
+    }
+    frame_misses++;
+
+    char trimmed[UI_TEXT_MAX_LENGTH + 1];
+    memcpy(trimmed, text, length);
+    trimmed[length] = '\0';
+    int quads = stb_easy_font_print(0.0f, 0.0f, trimmed, NULL, glyph_scratch, sizeof(glyph_scratch));
+
+    float* positions = (float*)realloc(entry->positions, sizeof(float) * 2 * 4 * (quads > 0 ? quads : 1));
+    if (!positions) return NULL;
+    for (int i = 0; i < quads * 4; i++) {
+        const float* source = (const float*)(glyph_scratch + i * 16);
+        positions[i * 2] = source[0];
+        positions[i * 2 + 1] = source[1];
+    }
+    entry->positions = positions;
+    entry->vertex_count = quads * 4;
+    entry->hash = hash;
+    memcpy(entry->text, trimmed, length + 1);
+    return entry;
+}
+
+void ui_text(const char* text, float x, float y, float scale_x, float scale_y, float r, float g, float b) {
+    const UITextEntry* entry = cached_text(text);
+    if (!entry) return;
+
+    unsigned char color[4];
+    pack_color(color, r, g, b, 1.0f);
+    for (int i = 0; i < entry->vertex_count; i += 4) {
+        UIVertex* quad = reserve_quad();
+        for (int v = 0; v < 4; v++) {
+            set_vertex(&quad[v], x + entry->positions[(i + v) * 2] * scale_x,
+                       y + entry->positions[(i + v) * 2 + 1] * scale_y, color);
+        }
+    }
+}
+
+float ui_text_width(const char* text) {
+    return (float)stb_easy_font_width((char*)text);
+}
+
+void ui_flush() {
+    draw_batch();
+    ui_batch_stats.quads = frame_quads;
+    ui_batch_stats.draw_calls = frame_draw_calls;
+    ui_batch_stats.cache_hits = frame_hits;
+    ui_batch_stats.cache_misses = frame_misses;
+    frame_quads = 0;
+    frame_draw_calls = 0;
+    frame_hits = 0;
+    frame_misses = 0;
+}
+
+void cleanup_ui_batch() {
+    for (int i = 0; i < UI_TEXT_CACHE_SIZE; i++) {
+        free(text_cache[i].positions);
+        text_cache[i].positions = NULL;
+    }
+    if (batch_vbo) {
+        glDeleteBuffers(1, &batch_vbo);
+        batch_vbo = 0;
+    }
+    vertex_count = 0;
+}
@@ -0,0 +1,33 @@
+// ui_batch.h - Lote 2D para interfaz y texto (una llamada de dibujo por frame)
+#ifndef UI_BATCH_H
+#define UI_BATCH_H
+
+#include <stdbool.h>
+
+// Capacidad del lote y de la caché de texto
+#define UI_BATCH_MAX_QUADS 16384        // Al llenarse se dibuja y se sigue acumulando
+#define UI_TEXT_CACHE_SIZE 256          // Entradas de la caché (tabla directa por hash)
+#define UI_TEXT_MAX_LENGTH 128          // Textos más largos se recortan
+
+// Contadores del último ui_flush()
+typedef struct {
+    int quads;
+    int draw_calls;
+    int cache_hits;
+    int cache_misses;
+} UIBatchStats;
+
+extern UIBatchStats ui_batch_stats;
+
+// Funciones del lote (las coordenadas son las de la proyección activa al dibujar)
+void init_ui_batch();
+void ui_rect(float x, float y, float width, float height, float r, float g, float b, float a);
+void ui_line(float x0, float y0, float x1, float y1, float thickness, float r, float g, float b, float a);
+// Texto de stb_easy_font: (x, y) es la esquina superior izquierda y la escala se aplica
+// a cada eje (una escala Y negativa sirve para proyecciones con Y hacia arriba)
+void ui_text(const char* text, float x, float y, float scale_x, float scale_y, float r, float g, float b);
+float ui_text_width(const char* text);  // En unidades de stb_easy_font (escala 1)
+void ui_flush();                         // Dibuja todo lo acumulado en una llamada
+void cleanup_ui_batch();
+
+#endif // UI_BATCH_H
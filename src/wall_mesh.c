@@ -0,0 +1,724 @@
+// wall_mesh.c - Geometría estática de muros, suelo y techo precalculada por chunks
+#include "wall_mesh.h"
+#include "gl_ext.h"
+#include "map.h"
+#include "player.h"
+#include "frustum.h"
+#include "occlusion.h"
+#include "pvs.h"
+#include "render.h"
+#include "lightmap.h"
+#include "lod.h"
+#include "light_clusters.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Variables globales de la malla
+WallChunk* wall_chunks = NULL;
+int wall_chunks_x = 0;
+int wall_chunks_z = 0;
+bool wall_mesh_ready = false;
+
+int wall_chunks_drawn = 0;
+
+// Cajas de los chunks en SoA para el frustum culling
+static FrustumBoxes chunk_boxes = {0};
+static unsigned char* chunk_visible = NULL;
+long wall_triangle_count = 0;
+
+// Chunks que pasan frustum, PVS y oclusión en el frame actual
+static int* visible_chunks = NULL;
+static int visible_chunk_count = 0;
+
+// Partes de cada chunk que se dibujan por separado (un material cada una)
+typedef enum {
+    CHUNK_PART_WALLS,
+    CHUNK_PART_FLOOR,
+    CHUNK_PART_CEILING
+} ChunkPart;
+
+// Buffer dinámico de vértices usado durante el horneado
+typedef struct {
+    float* data;
+    int count;      // Vértices escritos
+    int capacity;   // Vértices reservados
+} MeshBuilder;
+
+// Celdas que se mallan: la rejilla del mapa (cells NULL) o un bloque lineal externo de
+// size x size celdas (chunks del mundo infinito) en el que lo de fuera cuenta como muro
+typedef struct {
+    const unsigned char* cells;
+    int size;
+} MeshSource;
+
+static const MeshSource map_source = {NULL, 0};
+
+static int source_cell(const MeshSource* src, int x, int z) {
+    if (!src->cells) return maze_cell(x, z);
+    return src->cells[x * src->size + z] & CELL_TYPE_MASK;
+}
+
+static void mesh_reserve(MeshBuilder* b, int extra) {
+    if (b->count + extra <= b->capacity) return;
+    int new_capacity = b->capacity > 0 ? b->capacity * 2 : 1024;
+    while (new_capacity < b->count + extra) new_capacity *= 2;
+    float* data = (float*)realloc(b->data, (size_t)new_capacity * WALL_VERTEX_FLOATS * sizeof(float));
+    if (!data) {
+        printf("Error: Sin memoria para la malla de muros\n");
+        exit(1);
+    }
+    b->data = data;
+    b->capacity = new_capacity;
+}
+
+static void mesh_vertex(MeshBuilder* b, float u, float v, float nx, float ny, float nz,
+                        float x, float y, float z) {
+    float* out = b->data + (size_t)b->count * WALL_VERTEX_FLOATS;
+    out[0] = u;  out[1] = v;
+    out[2] = nx; out[3] = ny; out[4] = nz;
+    out[5] = x;  out[6] = y;  out[7] = z;
+    b->count++;
+}
+
+// Misma geometría y orden de vértices que draw_cube()
+static void mesh_cube(MeshBuilder* b, float x, float y, float z, float size) {
+    float h = size * 0.5f;
+    float uv[4];
+    lightmap_dark_uv(uv);
+    float u = uv[0], v = uv[1];
+    mesh_reserve(b, 24);
+
+    // Cara frontal (Z+)
+    mesh_vertex(b, u, v, 0, 0, 1, x - h, y - h, z + h);
+    mesh_vertex(b, u, v, 0, 0, 1, x + h, y - h, z + h);
+    mesh_vertex(b, u, v, 0, 0, 1, x + h, y + h, z + h);
+    mesh_vertex(b, u, v, 0, 0, 1, x - h, y + h, z + h);
+
+    // Cara trasera (Z-)
+    mesh_vertex(b, u, v, 0, 0, -1, x - h, y - h, z - h);
+    mesh_vertex(b, u, v, 0, 0, -1, x - h, y + h, z - h);
+    mesh_vertex(b, u, v, 0, 0, -1, x + h, y + h, z - h);
+    mesh_vertex(b, u, v, 0, 0, -1, x + h, y - h, z - h);
+
+    // Cara izquierda (X-)
+    mesh_vertex(b, u, v, -1, 0, 0, x - h, y - h, z - h);
+    mesh_vertex(b, u, v, -1, 0, 0, x - h, y - h, z + h);
+    mesh_vertex(b, u, v, -1, 0, 0, x - h, y + h, z + h);
+    mesh_vertex(b, u, v, -1, 0, 0, x - h, y + h, z - h);
+
+    // Cara derecha (X+)
+    mesh_vertex(b, u, v, 1, 0, 0, x + h, y - h, z - h);
+    mesh_vertex(b, u, v, 1, 0, 0, x + h, y + h, z - h);
+    mesh_vertex(b, u, v, 1, 0, 0, x + h, y + h, z + h);
+    mesh_vertex(b, u, v, 1, 0, 0, x + h, y - h, z + h);
+
+    // Cara superior (Y+)
+    mesh_vertex(b, u, v, 0, 1, 0, x - h, y + h, z - h);
+    mesh_vertex(b, u, v, 0, 1, 0, x - h, y + h, z + h);
+    mesh_vertex(b, u, v, 0, 1, 0, x + h, y + h, z + h);
+    mesh_vertex(b, u, v, 0, 1, 0, x + h, y + h, z - h);
+
+    // Cara inferior (Y-)
+    mesh_vertex(b, u, v, 0, -1, 0, x - h, y - h, z - h);
+    mesh_vertex(b, u, v, 0, -1, 0, x + h, y - h, z - h);
+    mesh_vertex(b, u, v, 0, -1, 0, x + h, y - h, z + h);
+    mesh_vertex(b, u, v, 0, -1, 0, x - h, y - h, z + h);
+}
+
+// Caras laterales visibles de la columna x en el tramo z0..z1 del chunk: muro con la
+// celda vecina abierta (fuera del mapa cuenta como muro). El chunk cabe en una palabra
+// del plano de bits porque WALL_CHUNK_SIZE divide a 64
+static uint64_t chunk_face_mask(const MeshSource* src, int x, int z0, int z1, int dx, int dz) {
+    if (!src->cells) {
+        uint64_t mask = maze_exposed_walls(x, z0 >> 6, dx, dz) >> (z0 & 63);
+        return z1 - z0 < 64 ? mask & (((uint64_t)1 << (z1 - z0)) - 1) : mask;
+    }
+
+    // Bloque externo: sin plano de bits, celda a celda
+    uint64_t mask = 0;
+    for (int z = z0; z < z1; z++) {
+        int nx = x + dx, nz = z + dz;
+        if (source_cell(src, x, z) != 1) continue;
+        if (nx < 0 || nx >= src->size || nz < 0 || nz >= src->size || source_cell(src, nx, nz) == 1) continue;
+        mask |= (uint64_t)1 << (z - z0);
+    }
+    return mask;
+}
+
+// Quad vertical de altura completa; todos los niveles se funden en uno
+static void mesh_side_quad(const MeshSource* src, MeshBuilder* b, int dx, int dz, float fixed, float from, float to) {
+    float top = (float)MAZE_LEVELS;
+    mesh_reserve(b, 4);
+
+    // Rectángulo del tramo en el atlas de lightmaps: u de from a to, v de 0 a top.
+    // Los bloques externos no tienen lightmaps (y el atlas no es de varios hilos)
+    float uv[4];
+    if (src->cells) lightmap_dark_uv(uv);
+    else lightmap_add_wall_face(dx, dz, fixed, from, to, uv);
+    float u0 = uv[0], v0 = uv[1], u1 = uv[2], v1 = uv[3];
+
+    if (dz == 1) {          // Cara Z+
+        mesh_vertex(b, u0, v0, 0, 0, 1, from, 0.0f, fixed);
+        mesh_vertex(b, u1, v0, 0, 0, 1, to, 0.0f, fixed);
+        mesh_vertex(b, u1, v1, 0, 0, 1, to, top, fixed);
+        mesh_vertex(b, u0, v1, 0, 0, 1, from, top, fixed);
+    } else if (dz == -1) {  // Cara Z-
+        mesh_vertex(b, u0, v0, 0, 0, -1, from, 0.0f, fixed);
+        mesh_vertex(b, u0, v1, 0, 0, -1, from, top, fixed);
+        mesh_vertex(b, u1, v1, 0, 0, -1, to, top, fixed);
+        mesh_vertex(b, u1, v0, 0, 0, -1, to, 0.0f, fixed);
+    } else if (dx == -1) {  // Cara X-
+        mesh_vertex(b, u0, v0, -1, 0, 0, fixed, 0.0f, from);
+        mesh_vertex(b, u1, v0, -1, 0, 0, fixed, 0.0f, to);
+        mesh_vertex(b, u1, v1, -1, 0, 0, fixed, top, to);
+        mesh_vertex(b, u0, v1, -1, 0, 0, fixed, top, from);
+    } else {                // Cara X+
+        mesh_vertex(b, u0, v0, 1, 0, 0, fixed, 0.0f, from);
+        mesh_vertex(b, u0, v1, 1, 0, 0, fixed, top, from);
+        mesh_vertex(b, u1, v1, 1, 0, 0, fixed, top, to);
+        mesh_vertex(b, u1, v0, 1, 0, 0, fixed, 0.0f, to);
+    }
+}
+
+// Caras laterales de una dirección, fundiendo tramos contiguos de la misma fila
+static void mesh_side_faces(const MeshSource* src, MeshBuilder* b, int x0, int z0, int x1, int z1, int dx, int dz) {
+    if (dz != 0) {
+        // Caras Z+/Z-: filas a lo largo de X, bit z - z0 de la máscara de cada columna
+        uint64_t masks[WALL_CHUNK_SIZE];
+        for (int x = x0; x < x1; x++) masks[x - x0] = chunk_face_mask(src, x, z0, z1, dx, dz);
+        for (int z = z0; z < z1; z++) {
+            int x = x0;
+            while (x < x1) {
+                if (!((masks[x - x0] >> (z - z0)) & 1)) { x++; continue; }
+                int run_start = x;
+                while (x < x1 && ((masks[x - x0] >> (z - z0)) & 1)) x++;
+                mesh_side_quad(src, b, dx, dz, z + dz * 0.5f, run_start - 0.5f, x - 0.5f);
+            }
+        }
+    } else {
+        // Caras X+/X-: columnas a lo largo de Z, cada tramo es una racha de unos
+        for (int x = x0; x < x1; x++) {
+            uint64_t mask = chunk_face_mask(src, x, z0, z1, dx, dz);
+            while (mask) {
+                int run_start = __builtin_ctzll(mask);
+                uint64_t rest = ~(mask >> run_start);
+                int run_length = rest ? __builtin_ctzll(rest) : 64 - run_start;
+                mesh_side_quad(src, b, dx, dz, x + dx * 0.5f, z0 + run_start - 0.5f, z0 + run_start + run_length - 0.5f);
+                mask &= run_length + run_start < 64 ? ~(uint64_t)0 << (run_start + run_length) : 0;
+            }
+        }
+    }
+}
+
+// Tapas superiores fundidas en rectángulos (mallado voraz 2D)
+static void mesh_top_faces(const MeshSource* src, MeshBuilder* b, int x0, int z0, int x1, int z1) {
+    bool used[WALL_CHUNK_SIZE][WALL_CHUNK_SIZE] = {{false}};
+    float top = (float)MAZE_LEVELS;
+
+    // Las tapas quedan por encima de todas las luces: sin luz horneada
+    float uv[4];
+    lightmap_dark_uv(uv);
+
+    for (int z = z0; z < z1; z++) {
+        for (int x = x0; x < x1; x++) {
+            if (source_cell(src, x, z) != 1 || used[x - x0][z - z0]) continue;
+
+            // Extender en X mientras haya muro libre
+            int w = 1;
+            while (x + w < x1 && source_cell(src, x + w, z) == 1 && !used[x + w - x0][z - z0]) w++;
+
+            // Extender en Z mientras toda la fila siga siendo muro
+            int h = 1;
+            while (z + h < z1) {
+                bool row_ok = true;
+                for (int i = 0; i < w; i++) {
+                    if (source_cell(src, x + i, z + h) != 1 || used[x + i - x0][z + h - z0]) {
+                        row_ok = false;
+                        break;
+                    }
+                }
+                if (!row_ok) break;
+                h++;
+            }
+
+            for (int i = 0; i < w; i++) {
+                for (int j = 0; j < h; j++) used[x + i - x0][z + j - z0] = true;
+            }
+
+            float fx0 = x - 0.5f, fx1 = x + w - 0.5f;
+            float fz0 = z - 0.5f, fz1 = z + h - 0.5f;
+            mesh_reserve(b, 4);
+            mesh_vertex(b, uv[0], uv[1], 0, 1, 0, fx0, top, fz0);
+            mesh_vertex(b, uv[0], uv[1], 0, 1, 0, fx0, top, fz1);
+            mesh_vertex(b, uv[0], uv[1], 0, 1, 0, fx1, top, fz1);
+            mesh_vertex(b, uv[0], uv[1], 0, 1, 0, fx1, top, fz0);
+        }
+    }
+}
+
+// Suelo: celdas abiertas a la misma altura de terreno fundidas en rectángulos, como
+// las tapas de los muros (bajo los muros no se ve)
+static void mesh_floor_faces(const MeshSource* src, MeshBuilder* b, int x0, int z0, int x1, int z1) {
+    bool used[WALL_CHUNK_SIZE][WALL_CHUNK_SIZE] = {{false}};
+    float uv[4];
+    lightmap_dark_uv(uv);   // El lightmap del suelo usa texgen
+
+    for (int z = z0; z < z1; z++) {
+        for (int x = x0; x < x1; x++) {
+            if (source_cell(src, x, z) == 1 || used[x - x0][z - z0]) continue;
+            float y = get_terrain_height((float)x, (float)z);
+
+            // Extender en X mientras siga el suelo libre a la misma altura
+            int w = 1;
+            while (x + w < x1 && source_cell(src, x + w, z) != 1 && !used[x + w - x0][z - z0] &&
+                   get_terrain_height((float)(x + w), (float)z) == y) w++;
+
+            // Extender en Z mientras toda la fila cumpla lo mismo
+            int h = 1;
+            while (z + h < z1) {
+                bool row_ok = true;
+                for (int i = 0; i < w; i++) {
+                    if (source_cell(src, x + i, z + h) == 1 || used[x + i - x0][z + h - z0] ||
+                        get_terrain_height((float)(x + i), (float)(z + h)) != y) {
+                        row_ok = false;
+                        break;
+                    }
+                }
+                if (!row_ok) break;
+                h++;
+            }
+
+            for (int i = 0; i < w; i++) {
+                for (int j = 0; j < h; j++) used[x + i - x0][z + j - z0] = true;
+            }
+
+            float fx0 = x - 0.5f, fx1 = x + w - 0.5f;
+            float fz0 = z - 0.5f, fz1 = z + h - 0.5f;
+            mesh_reserve(b, 4);
+            mesh_vertex(b, uv[0], uv[1], 0, 1, 0, fx0, y, fz0);
+            mesh_vertex(b, uv[0], uv[1], 0, 1, 0, fx0, y, fz1);
+            mesh_vertex(b, uv[0], uv[1], 0, 1, 0, fx1, y, fz1);
+            mesh_vertex(b, uv[0], uv[1], 0, 1, 0, fx1, y, fz0);
+        }
+    }
+}
+
+// Techo: a altura constante y también sobre los muros, un solo quad por chunk
+static void mesh_ceiling_quad(MeshBuilder* b, int x0, int z0, int x1, int z1) {
+    float uv[4];
+    lightmap_dark_uv(uv);
+    float y = CEILING_HEIGHT;
+    float fx0 = x0 - 0.5f, fx1 = x1 - 0.5f;
+    float fz0 = z0 - 0.5f, fz1 = z1 - 0.5f;
+    mesh_reserve(b, 4);
+    mesh_vertex(b, uv[0], uv[1], 0, -1, 0, fx0, y, fz0);
+    mesh_vertex(b, uv[0], uv[1], 0, -1, 0, fx1, y, fz0);
+    mesh_vertex(b, uv[0], uv[1], 0, -1, 0, fx1, y, fz1);
+    mesh_vertex(b, uv[0], uv[1], 0, -1, 0, fx0, y, fz1);
+}
+
+// Mallar las celdas del chunk en el builder (sin GL): muros, decoración, suelo y techo
+static void mesh_chunk(const MeshSource* src, WallChunk* chunk, MeshBuilder* b) {
+    int limit_x = src->cells ? src->size : maze_width;
+    int limit_z = src->cells ? src->size : maze_height;
+    int end_x = chunk->cell_x + WALL_CHUNK_SIZE;
+    int end_z = chunk->cell_z + WALL_CHUNK_SIZE;
+    if (end_x > limit_x) end_x = limit_x;
+    if (end_z > limit_z) end_z = limit_z;
+
+    b->count = 0;
+
+    // Muros: solo caras entre muro y espacio abierto, sin caras inferiores
+    mesh_side_faces(src, b, chunk->cell_x, chunk->cell_z, end_x, end_z, 0, 1);
+    mesh_side_faces(src, b, chunk->cell_x, chunk->cell_z, end_x, end_z, 0, -1);
+    mesh_side_faces(src, b, chunk->cell_x, chunk->cell_z, end_x, end_z, 1, 0);
+    mesh_side_faces(src, b, chunk->cell_x, chunk->cell_z, end_x, end_z, -1, 0);
+    mesh_top_faces(src, b, chunk->cell_x, chunk->cell_z, end_x, end_z);
+    chunk->wall_vertex_count = b->count;
+
+    // Elementos decorativos a continuación de los muros
+    chunk->decor_first = b->count;
+    chunk->cell_count = 0;
+    for (int x = chunk->cell_x; x < end_x; x++) {
+        for (int z = chunk->cell_z; z < end_z; z++) {
+            int cell = source_cell(src, x, z);
+            if (cell == 2) {
+                mesh_cube(b, (float)x, 0.3f, (float)z, 0.2f);
+            }
+            if (cell != 0) chunk->cell_count++;
+        }
+    }
+    chunk->decor_vertex_count = b->count - chunk->decor_first;
+
+    // Suelo y techo fundidos: la luz horneada llega por texgen, no por los vértices
+    chunk->floor_first = b->count;
+    mesh_floor_faces(src, b, chunk->cell_x, chunk->cell_z, end_x, end_z);
+    chunk->floor_vertex_count = b->count - chunk->floor_first;
+    chunk->ceiling_first = b->count;
+    mesh_ceiling_quad(b, chunk->cell_x, chunk->cell_z, end_x, end_z);
+    chunk->ceiling_vertex_count = b->count - chunk->ceiling_first;
+
+    // Caja envolvente (cada celda ocupa [x - 0.5, x + 0.5])
+    chunk->min_x = chunk->cell_x - 0.5f;
+    chunk->min_z = chunk->cell_z - 0.5f;
+    chunk->max_x = end_x - 0.5f;
+    chunk->max_z = end_z - 0.5f;
+    chunk->max_y = CEILING_HEIGHT;
+}
+
+static int chunk_vertex_total(const WallChunk* chunk) {
+    return chunk->ceiling_first + chunk->ceiling_vertex_count;
+}
+
+// Subir los vértices del chunk a su VBO (o a una copia en CPU sin VBO)
+static void upload_chunk(WallChunk* chunk, const float* data) {
+    int total = chunk_vertex_total(chunk);
+    size_t bytes = (size_t)total * WALL_VERTEX_FLOATS * sizeof(float);
+    if (total == 0) return;
+
+    if (gl_has_vbo) {
+        glGenBuffers(1, &chunk->vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, chunk->vbo);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)bytes, data, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    } else {
+        chunk->vertices = (float*)malloc(bytes);
+        if (chunk->vertices) memcpy(chunk->vertices, data, bytes);
+    }
+}
+
+static void release_chunk(WallChunk* chunk) {
+    if (chunk->vbo) glDeleteBuffers(1, &chunk->vbo);
+    free(chunk->vertices);
+    memset(chunk, 0, sizeof(*chunk));
+}
+
+void bake_wall_meshes() {
+    cleanup_wall_meshes();
+
+    // Cada tramo de muro reserva su rectángulo en el atlas de lightmaps al mallarse
+    lightmap_reset_faces();
+
+    wall_chunks_x = (maze_width + WALL_CHUNK_SIZE - 1) / WALL_CHUNK_SIZE;
+    wall_chunks_z = (maze_height + WALL_CHUNK_SIZE - 1) / WALL_CHUNK_SIZE;
+    wall_chunks = (WallChunk*)calloc((size_t)wall_chunks_x * wall_chunks_z, sizeof(WallChunk));
+    if (!wall_chunks) {
+        printf("Error: No se pudo reservar memoria para los chunks de muros\n");
+        return;
+    }
+
+    int chunk_count = wall_chunks_x * wall_chunks_z;
+    bool boxes_ready = frustum_boxes_init(&chunk_boxes, chunk_count);
+    chunk_visible = (unsigned char*)calloc((size_t)chunk_boxes.capacity, 1);
+    visible_chunks = (int*)malloc(sizeof(int) * (size_t)chunk_count);
+    if (!boxes_ready || !chunk_visible || !visible_chunks) {
+        printf("Error: No se pudo reservar memoria para los chunks de muros\n");
+        cleanup_wall_meshes();
+        return;
+    }
+
+    MeshBuilder builder = {0};
+    long total_vertices = 0;
+    long wall_vertices = 0;
+    long plane_vertices = 0;
+
+    for (int cz = 0; cz < wall_chunks_z; cz++) {
+        for (int cx = 0; cx < wall_chunks_x; cx++) {
+            WallChunk* chunk = &wall_chunks[cz * wall_chunks_x + cx];
+            chunk->cell_x = cx * WALL_CHUNK_SIZE;
+            chunk->cell_z = cz * WALL_CHUNK_SIZE;
+            mesh_chunk(&map_source, chunk, &builder);
+            upload_chunk(chunk, builder.data);
+            frustum_boxes_set(&chunk_boxes, cz * wall_chunks_x + cx,
+                              chunk->min_x, 0.0f, chunk->min_z,
+                              chunk->max_x, chunk->max_y, chunk->max_z);
+            total_vertices += builder.count;
+            wall_vertices += chunk->wall_vertex_count;
+            plane_vertices += chunk->floor_vertex_count + chunk->ceiling_vertex_count;
+        }
+    }
+
+    free(builder.data);
+    wall_mesh_ready = true;
+
+    // Comparar con la geometría original: MAZE_LEVELS cubos de 12 triángulos por muro
+    wall_triangle_count = wall_vertices / 4 * 2;
+    if (!map_verbose) return;
+    long wall_cells = count_maze_walls();
+    long cube_triangles = wall_cells * MAZE_LEVELS * 12;
+    printf("Triangulos de muros: %ld (cubos apilados: %ld, reduccion %.1fx)\n",
+           wall_triangle_count, cube_triangles,
+           wall_triangle_count > 0 ? (double)cube_triangles / wall_triangle_count : 0.0);
+
+    printf("Suelo y techo fundidos: %ld quads (%ld celdas)\n",
+           plane_vertices / 4, (long)maze_width * maze_height);
+
+    printf("Malla de muros horneada: %d chunks de %dx%d celdas, %ld vertices (%.1f MB)\n",
+           chunk_count, WALL_CHUNK_SIZE, WALL_CHUNK_SIZE, total_vertices,
+           total_vertices * WALL_VERTEX_FLOATS * sizeof(float) / (1024.0f * 1024.0f));
+}
+
+void mesh_wall_block(const unsigned char* cells, int size, int cell_x, int cell_z, WallChunk* out) {
+    MeshSource src = {cells, size};
+    MeshBuilder builder = {0};
+    memset(out, 0, sizeof(*out));
+    out->cell_x = cell_x;
+    out->cell_z = cell_z;
+    mesh_chunk(&src, out, &builder);
+
+    // El builder crece al doble: quedarse solo con lo escrito
+    size_t bytes = (size_t)builder.count * WALL_VERTEX_FLOATS * sizeof(float);
+    if (builder.count > 0) {
+        out->vertices = (float*)malloc(bytes);
+        if (!out->vertices) {
+            printf("Error: Sin memoria para la malla de muros\n");
+            exit(1);
+        }
+        memcpy(out->vertices, builder.data, bytes);
+    }
+    free(builder.data);
+}
+
+void free_wall_block(WallChunk* mesh) {
+    free(mesh->vertices);
+    mesh->vertices = NULL;
+}
+
+static void update_wall_triangle_count() {
+    long wall_vertices = 0;
+    for (int i = 0; i < wall_chunks_x * wall_chunks_z; i++) wall_vertices += wall_chunks[i].wall_vertex_count;
+    wall_triangle_count = wall_vertices / 4 * 2;
+}
+
+static void set_chunk_box(int index) {
+    const WallChunk* chunk = &wall_chunks[index];
+    frustum_boxes_set(&chunk_boxes, index, chunk->min_x, 0.0f, chunk->min_z,
+                      chunk->max_x, chunk->max_y, chunk->max_z);
+}
+
+void shift_wall_meshes(int dx, int dz) {
+    if (!wall_mesh_ready) return;
+    float shift_x = (float)(dx * WALL_CHUNK_SIZE);
+    float shift_z = (float)(dz * WALL_CHUNK_SIZE);
+
+    // Liberar los que salen de la rejilla
+    for (int cz = 0; cz < wall_chunks_z; cz++) {
+        for (int cx = 0; cx < wall_chunks_x; cx++) {
+            int to_x = cx - dx, to_z = cz - dz;
+            if (to_x < 0 || to_x >= wall_chunks_x || to_z < 0 || to_z >= wall_chunks_z) {
+                release_chunk(&wall_chunks[cz * wall_chunks_x + cx]);
+            }
+        }
+    }
+
+    // Mover el resto hacia el lado contrario al desplazamiento, recorriendo en el
+    // sentido que no pisa chunks aún por mover. Su VBO sigue valiendo: solo cambia
+    // la traslación con la que se dibuja
+    int step_x = dx > 0 ? 1 : -1, step_z = dz > 0 ? 1 : -1;
+    int first_x = dx > 0 ? 0 : wall_chunks_x - 1, first_z = dz > 0 ? 0 : wall_chunks_z - 1;
+    for (int cz = first_z; cz >= 0 && cz < wall_chunks_z; cz += step_z) {
+        for (int cx = first_x; cx >= 0 && cx < wall_chunks_x; cx += step_x) {
+            WallChunk* chunk = &wall_chunks[cz * wall_chunks_x + cx];
+            int from_x = cx + dx, from_z = cz + dz;
+            if (from_x < 0 || from_x >= wall_chunks_x || from_z < 0 || from_z >= wall_chunks_z) {
+                memset(chunk, 0, sizeof(*chunk));   // Hueco para install_wall_mesh
+                chunk->cell_x = cx * WALL_CHUNK_SIZE;
+                chunk->cell_z = cz * WALL_CHUNK_SIZE;
+            } else {
+                *chunk = wall_chunks[from_z * wall_chunks_x + from_x];
+                chunk->cell_x = cx * WALL_CHUNK_SIZE;
+                chunk->cell_z = cz * WALL_CHUNK_SIZE;
+                chunk->offset_x -= shift_x;
+                chunk->offset_z -= shift_z;
+                chunk->min_x -= shift_x;
+                chunk->max_x -= shift_x;
+                chunk->min_z -= shift_z;
+                chunk->max_z -= shift_z;
+            }
+            set_chunk_box(cz * wall_chunks_x + cx);
+        }
+    }
+    update_wall_triangle_count();
+}
+
+void install_wall_mesh(int chunk_x, int chunk_z, const WallChunk* mesh, float offset_x, float offset_z) {
+    if (!wall_mesh_ready || chunk_x < 0 || chunk_x >= wall_chunks_x || chunk_z < 0 || chunk_z >= wall_chunks_z) return;
+    int index = chunk_z * wall_chunks_x + chunk_x;
+    WallChunk* chunk = &wall_chunks[index];
+    release_chunk(chunk);
+
+    // Los vértices del bloque siguen siendo de quien lo malló: aquí solo se suben
+    *chunk = *mesh;
+    chunk->vbo = 0;
+    chunk->vertices = NULL;
+    chunk->cell_x = chunk_x * WALL_CHUNK_SIZE;
+    chunk->cell_z = chunk_z * WALL_CHUNK_SIZE;
+    chunk->offset_x = offset_x;
+    chunk->offset_z = offset_z;
+    chunk->min_x += offset_x;
+    chunk->max_x += offset_x;
+    chunk->min_z += offset_z;
+    chunk->max_z += offset_z;
+    chunk->lod_tier = LOD_TIER_NEAR;
+    if (mesh->vertices) upload_chunk(chunk, mesh->vertices);
+    set_chunk_box(index);
+    update_wall_triangle_count();
+}
+
+// Distancia al cuadrado desde el jugador al punto más cercano del chunk
+static float chunk_distance_sq(const WallChunk* chunk) {
+    float dx = 0.0f, dz = 0.0f;
+    if (player.x < chunk->min_x) dx = chunk->min_x - player.x;
+    else if (player.x > chunk->max_x) dx = player.x - chunk->max_x;
+    if (player.z < chunk->min_z) dz = chunk->min_z - player.z;
+    else if (player.z > chunk->max_z) dz = player.z - chunk->max_z;
+    return dx * dx + dz * dz;
+}
+
+// Añadir un chunk candidato a la lista si pasa el frustum y la oclusión
+static void consider_chunk(int index) {
+    WallChunk* chunk = &wall_chunks[index];
+    if (!chunk_visible[index]) {
+        frustum_stats.chunks_rejected++;
+        frustum_stats.cells_rejected += chunk->cell_count;
+        return;
+    }
+    frustum_stats.chunks_accepted++;
+    frustum_stats.cells_accepted += chunk->cell_count;
+
+    // Ningún rayo alcanzó celdas de este chunk: está tapado por muros más cercanos
+    if (!occlusion_chunk_visible(index % wall_chunks_x, index / wall_chunks_x)) return;
+
+    // Chunks lejanos dibujan sus muros sin la decoración
+    chunk->lod_tier = lod_next_tier(chunk->lod_tier, sqrtf(chunk_distance_sq(chunk)));
+
+    visible_chunks[visible_chunk_count++] = index;
+    wall_chunks_drawn++;
+}
+
+void update_chunk_visibility(float render_distance) {
+    visible_chunk_count = 0;
+    wall_chunks_drawn = 0;
+    if (!wall_mesh_ready) return;
+
+    // Probar todas las cajas contra los 6 planos antes de enviar nada
+    frustum_test_boxes(&chunk_boxes, chunk_visible);
+
+    const unsigned char* pvs = pvs_lookup(player.x, player.z);
+    int chunk_count = wall_chunks_x * wall_chunks_z;
+    if (pvs) {
+        // Recorrer solo los bits activos del PVS de la celda del jugador
+        for (int byte = 0; byte * 8 < chunk_count; byte++) {
+            unsigned char bits = pvs[byte];
+            while (bits) {
+                int bit = 0;
+                while (!(bits & (1 << bit))) bit++;
+                bits &= (unsigned char)(bits - 1);
+                int index = byte * 8 + bit;
+                if (index < chunk_count) consider_chunk(index);
+            }
+        }
+    } else {
+        // Sin PVS (jugador fuera de una celda abierta): test de distancia
+        float render_distance_sq = render_distance * render_distance;
+        for (int i = 0; i < chunk_count; i++) {
+            if (chunk_distance_sq(&wall_chunks[i]) <= render_distance_sq) consider_chunk(i);
+        }
+    }
+}
+
+// Dibujar una parte de todos los chunks visibles (el material ya está aplicado)
+static void draw_visible_chunks(ChunkPart part) {
+    for (int i = 0; i < visible_chunk_count; i++) {
+        WallChunk* chunk = &wall_chunks[visible_chunks[i]];
+        int first = 0;
+        int count = chunk->wall_vertex_count;
+        if (chunk->lod_tier != LOD_TIER_FAR) count += chunk->decor_vertex_count;
+        if (part == CHUNK_PART_FLOOR) {
+            first = chunk->floor_first;
+            count = chunk->floor_vertex_count;
+        } else if (part == CHUNK_PART_CEILING) {
+            first = chunk->ceiling_first;
+            count = chunk->ceiling_vertex_count;
+        }
+        if (count == 0) continue;
+
+        if (chunk->vbo) {
+            glBindBuffer(GL_ARRAY_BUFFER, chunk->vbo);
+            glInterleavedArrays(GL_T2F_N3F_V3F, 0, (const GLvoid*)0);
+        } else if (chunk->vertices) {
+            glInterleavedArrays(GL_T2F_N3F_V3F, 0, chunk->vertices);
+        } else {
+            continue;
+        }
+
+        // Las mallas reutilizadas del mundo infinito se dibujan trasladadas
+        bool moved = chunk->offset_x != 0.0f || chunk->offset_z != 0.0f;
+        if (moved) {
+            glPushMatrix();
+            glTranslatef(chunk->offset_x, 0.0f, chunk->offset_z);
+        }
+        clustered_lighting_set_offset(chunk->offset_x, chunk->offset_z);
+        glDrawArrays(GL_QUADS, first, count);
+        gl_state_count_draw(count);
+        if (moved) glPopMatrix();
+    }
+    clustered_lighting_set_offset(0.0f, 0.0f);
+
+    if (gl_has_vbo) glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void render_floor_chunks() {
+    if (!wall_mesh_ready) return;
+    gl_state_enable(GL_BLEND, false);
+    gl_state_depth_mask(GL_TRUE);
+    gl_state_material(&material_floor);
+    lightmap_bind(LIGHTMAP_SURFACE_FLOOR);
+    draw_visible_chunks(CHUNK_PART_FLOOR);
+    lightmap_unbind();
+}
+
+void render_ceiling_chunks() {
+    if (!wall_mesh_ready) return;
+    gl_state_enable(GL_BLEND, false);
+    gl_state_depth_mask(GL_TRUE);
+    gl_state_material(&material_ceiling);
+    lightmap_bind(LIGHTMAP_SURFACE_CEILING);
+    draw_visible_chunks(CHUNK_PART_CEILING);
+    lightmap_unbind();
+}
+
+void render_wall_chunks() {
+    if (!wall_mesh_ready) return;
+
+    // Material sólido de muros y decoración (el mismo que draw_cube)
+    gl_state_enable(GL_BLEND, false);
+    gl_state_depth_mask(GL_TRUE);
+    gl_state_material(&material_wall);
+    lightmap_bind(LIGHTMAP_SURFACE_WALLS);
+    draw_visible_chunks(CHUNK_PART_WALLS);
+    lightmap_unbind();
+}
+
+void cleanup_wall_meshes() {
+    if (wall_chunks) {
+        int chunk_count = wall_chunks_x * wall_chunks_z;
+        for (int i = 0; i < chunk_count; i++) release_chunk(&wall_chunks[i]);
+        free(wall_chunks);
+    }
+    frustum_boxes_free(&chunk_boxes);
+    free(chunk_visible);
+    free(visible_chunks);
+    chunk_visible = NULL;
+    visible_chunks = NULL;
+    visible_chunk_count = 0;
+    wall_chunks = NULL;
+    wall_chunks_x = 0;
+    wall_chunks_z = 0;
+    wall_mesh_ready = false;
+}
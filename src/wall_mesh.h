@@ -0,0 +1,58 @@
+// wall_mesh.h - Geometría estática de muros, suelo y techo precalculada por chunks
+#ifndef WALL_MESH_H
+#define WALL_MESH_H
+
+#include <GL/gl.h>
+#include <stdbool.h>
+
+// Tamaño de cada chunk en celdas del laberinto
+#define WALL_CHUNK_SIZE 16
+
+// Formato de vértice: lightmap + normal + posición (compatible con GL_T2F_N3F_V3F)
+#define WALL_VERTEX_FLOATS 8
+
+// Chunk de geometría de muros
+typedef struct {
+    int cell_x, cell_z;           // Primera celda del chunk
+    float min_x, min_z;           // Caja envolvente en coordenadas de mundo
+    float max_x, max_z;
+    float max_y;
+    float offset_x, offset_z;     // Traslación al dibujar (mallas reutilizadas del mundo infinito)
+    GLuint vbo;                   // Buffer en GPU (0 si no hay VBO)
+    float* vertices;              // Copia en CPU (fallback sin VBO)
+    int wall_vertex_count;        // Vértices de muros (desde el inicio)
+    int decor_first;              // Primer vértice de decoración
+    int decor_vertex_count;       // Vértices de decoración
+    int floor_first;              // Primer vértice del suelo (celdas abiertas fundidas)
+    int floor_vertex_count;
+    int ceiling_first;            // Primer vértice del techo (un quad por chunk)
+    int ceiling_vertex_count;
+    int cell_count;               // Celdas con muro o decoración
+    int lod_tier;                 // Nivel de detalle actual (LOD_TIER_*, con histéresis)
+} WallChunk;
+
+// Variables globales de la malla
+extern WallChunk* wall_chunks;
+extern int wall_chunks_x;
+extern int wall_chunks_z;
+extern bool wall_mesh_ready;
+
+// Estadísticas del último frame
+extern int wall_chunks_drawn;
+extern long wall_triangle_count;   // Triángulos de muros tras el mallado
+
+// Funciones de la malla de muros, suelo y techo
+void bake_wall_meshes();
+// Mundo infinito: mallar sin GL un chunk de una rejilla lineal externa de size x size
+// (x * size + z, fuera cuenta como muro) desde cualquier hilo; out->vertices es suyo
+void mesh_wall_block(const unsigned char* cells, int size, int cell_x, int cell_z, WallChunk* out);
+void free_wall_block(WallChunk* mesh);
+void shift_wall_meshes(int dx, int dz);    // La ventana avanza (dx, dz) chunks: reutilizar los que quedan
+void install_wall_mesh(int chunk_x, int chunk_z, const WallChunk* mesh, float offset_x, float offset_z);
+void update_chunk_visibility(float render_distance);   // Una vez por frame, antes de dibujar
+void render_floor_chunks();
+void render_ceiling_chunks();
+void render_wall_chunks();
+void cleanup_wall_meshes();
+
+#endif // WALL_MESH_H
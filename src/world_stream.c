@@ -0,0 +1,549 @@
+// world_stream.c - Mundo infinito por chunks procedurales deterministas con origen flotante
+#include "world_stream.h"
+#include "connectivity.h"
+#include "thread_pool.h"
+#include "light_clusters.h"
+#include "player.h"
+#include "enemy.h"
+#include "particles.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Estado de cada hueco de la caché
+enum {
+    CHUNK_SLOT_FREE,
+    CHUNK_SLOT_PENDING,     // Reservado para el hilo de fondo: el hilo principal no lo lee
+    CHUNK_SLOT_READY
+};
+
+// Claves de los hashes de cada chunk
+#define SALT_LAYOUT 0x6c61796fu
+#define SALT_EDGE_X 0x65646778u     // Borde en x = chunk_x * WORLD_CHUNK_SIZE
+#define SALT_EDGE_Z 0x6564677au     // Borde en z = chunk_z * WORLD_CHUNK_SIZE
+
+bool world_stream_active = false;
+int world_origin_chunk_x = 0;
+int world_origin_chunk_z = 0;
+
+static unsigned int world_seed = 0;
+
+// Caché de chunks: solo el hilo principal cambia estados y coordenadas
+static WorldChunk* cache = NULL;
+static int cache_capacity = 0;
+static int cache_used = 0;
+static long chunks_generated = 0;
+static long chunks_evicted = 0;
+
+// Las luces de un chunk no ven más allá de sus vecinos inmediatos
+#if LIGHT_VISIBILITY_RADIUS >= WORLD_CHUNK_SIZE
+#error "La visibilidad de las luces necesita chunks más grandes que su radio"
+#endif
+#define NEIGHBOURHOOD_CELLS (WORLD_CHUNK_SIZE * 3)
+
+// Huecos que prepara la tarea de fondo en curso: generar y hornear, o solo hornear
+typedef struct {
+    int slot;
+    bool generate;
+} PendingChunk;
+
+static PendingChunk* pending = NULL;
+static int pending_count = 0;
+static volatile long prefetch_running = 0;
+
+// Huecos de la caché de cada chunk de la ventana, [i * WORLD_WINDOW_CHUNKS + j]
+static int window_slots[WORLD_WINDOW_CHUNKS * WORLD_WINDOW_CHUNKS];
+static LightVisibility window_visibility[WORLD_WINDOW_CHUNKS * WORLD_WINDOW_CHUNKS * WORLD_CHUNK_MAX_LIGHTS];
+
+// Mezcla de enteros (finalizador de MurmurHash3): el mismo resultado en cualquier
+// plataforma, a diferencia de rand()
+static unsigned int hash_mix(unsigned int h) {
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+static unsigned int chunk_hash(unsigned int seed, int chunk_x, int chunk_z, unsigned int salt) {
+    unsigned int h = hash_mix(seed ^ salt);
+    h = hash_mix(h ^ (unsigned int)chunk_x);
+    return hash_mix(h ^ (unsigned int)chunk_z * 0x9e3779b9u);
+}
+
+// Xorshift de 32 bits con estado propio por chunk
+static unsigned int next_random(unsigned int* state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static int random_range(unsigned int* state, int min, int max) {
+    return min + (int)(next_random(state) % (unsigned int)(max - min + 1));
+}
+
+// Abrir un rectángulo [x0, x1] x [z0, z1] sin tocar el marco del chunk
+static void carve_rect(unsigned char* cells, int x0, int z0, int x1, int z1) {
+    if (x0 < 1) x0 = 1;
+    if (z0 < 1) z0 = 1;
+    if (x1 > WORLD_CHUNK_SIZE - 2) x1 = WORLD_CHUNK_SIZE - 2;
+    if (z1 > WORLD_CHUNK_SIZE - 2) z1 = WORLD_CHUNK_SIZE - 2;
+    for (int x = x0; x <= x1; x++) {
+        for (int z = z0; z <= z1; z++) cells[x * WORLD_CHUNK_SIZE + z] = 0;
+    }
+}
+
+// Pasillo en L de ancho width desde (x0, z0) hasta (x1, z1)
+static void carve_corridor(unsigned char* cells, int x0, int z0, int x1, int z1, int width) {
+    carve_rect(cells, x0 < x1 ? x0 : x1, z0, x0 < x1 ? x1 : x0, z0 + width - 1);
+    carve_rect(cells, x1, z0 < z1 ? z0 : z1, x1 + width - 1, z0 < z1 ? z1 : z0);
+}
+
+// Hueco del borde compartido: los dos chunks vecinos lo calculan con la misma clave
+static void edge_door(unsigned int seed, int chunk_x, int chunk_z, unsigned int salt, int* start, int* width) {
+    unsigned int h = chunk_hash(seed, chunk_x, chunk_z, salt);
+    *width = WORLD_DOOR_MIN_WIDTH + (int)(h % (WORLD_DOOR_MAX_WIDTH - WORLD_DOOR_MIN_WIDTH + 1));
+    *start = 2 + (int)((h >> 8) % (unsigned int)(WORLD_CHUNK_SIZE - 4 - *width));
+}
+
+static void add_chunk_light(WorldChunk* chunk, int x, int z, int type) {
+    if (chunk->light_count >= WORLD_CHUNK_MAX_LIGHTS) return;
+    if (chunk->cells[x * WORLD_CHUNK_SIZE + z] & CELL_WALL) return;
+
+    // Mismos tipos que generate_light_points (el rango no pasa de LIGHT_VISIBILITY_RADIUS)
+    LightPoint* light = &chunk->lights[chunk->light_count++];
+    light->x = (float)x;
+    light->z = (float)z;
+    light->type = type;
+    light->intensity = type == 0 ? 0.4f : (type == 1 ? 0.6f : 0.8f);
+    light->range = type == 0 ? 10.0f : (type == 1 ? 14.0f : 18.0f);
+    light->active = true;
+    chunk->cells[x * WORLD_CHUNK_SIZE + z] |= CELL_LIGHT;
+}
+
+// Salas unidas al centro del chunk por pasillos y un hueco en cada borde. Los bordes
+// son muro salvo los huecos, que coinciden a ambos lados: cada chunk se genera sin
+// mirar a sus vecinos y el mundo queda conectado
+void generate_world_chunk(unsigned int seed, WorldChunk* chunk) {
+    unsigned char* cells = chunk->cells;
+    int cx = chunk->chunk_x, cz = chunk->chunk_z;
+    int center = WORLD_CHUNK_SIZE / 2;
+    unsigned int state = chunk_hash(seed, cx, cz, SALT_LAYOUT) | 1u;
+
+    memset(cells, CELL_WALL, WORLD_CHUNK_CELLS);
+    chunk->light_count = 0;
+
+    // Vestíbulo central
+    carve_rect(cells, center - 4, center - 4, center + 3, center + 3);
+
+    // Huecos de los cuatro bordes y su pasillo hasta el vestíbulo
+    int start, width;
+    edge_door(seed, cx, cz, SALT_EDGE_X, &start, &width);              // x-
+    for (int z = start; z < start + width; z++) cells[z] = 0;
+    carve_corridor(cells, 0, start, center, center, width);
+    edge_door(seed, cx + 1, cz, SALT_EDGE_X, &start, &width);          // x+
+    for (int z = start; z < start + width; z++) cells[(WORLD_CHUNK_SIZE - 1) * WORLD_CHUNK_SIZE + z] = 0;
+    carve_corridor(cells, WORLD_CHUNK_SIZE - 1, start, center, center, width);
+    edge_door(seed, cx, cz, SALT_EDGE_Z, &start, &width);              // z-
+    for (int x = start; x < start + width; x++) cells[x * WORLD_CHUNK_SIZE] = 0;
+    carve_rect(cells, start, 0, start + width - 1, center);
+    edge_door(seed, cx, cz + 1, SALT_EDGE_Z, &start, &width);          // z+
+    for (int x = start; x < start + width; x++) cells[x * WORLD_CHUNK_SIZE + WORLD_CHUNK_SIZE - 1] = 0;
+    carve_rect(cells, start, center, start + width - 1, WORLD_CHUNK_SIZE - 1);
+
+    // Salas con columnas en rejilla, cada una con un pasillo al vestíbulo
+    int room_count = random_range(&state, 2, 4);
+    for (int i = 0; i < room_count; i++) {
+        int room_w = random_range(&state, 5, 12);
+        int room_h = random_range(&state, 5, 12);
+        int x0 = random_range(&state, 1, WORLD_CHUNK_SIZE - 1 - room_w);
+        int z0 = random_range(&state, 1, WORLD_CHUNK_SIZE - 1 - room_h);
+        carve_rect(cells, x0, z0, x0 + room_w - 1, z0 + room_h - 1);
+        carve_corridor(cells, x0 + room_w / 2, z0 + room_h / 2, center, center, 2);
+
+        if (room_w >= 8 && room_h >= 8) {
+            for (int x = x0 + 2; x < x0 + room_w - 2; x += 3) {
+                for (int z = z0 + 2; z < z0 + room_h - 2; z += 3) cells[x * WORLD_CHUNK_SIZE + z] = CELL_WALL;
+            }
+        }
+        if (random_range(&state, 0, 2) == 0) {
+            int dx = x0 + random_range(&state, 0, room_w - 1);
+            int dz = z0 + random_range(&state, 0, room_h - 1);
+            if (cells[dx * WORLD_CHUNK_SIZE + dz] == 0) cells[dx * WORLD_CHUNK_SIZE + dz] = CELL_DECOR;
+        }
+        int type = room_w * room_h >= 80 ? 2 : 1;
+        add_chunk_light(chunk, x0 + room_w / 2, z0 + room_h / 2, type);
+    }
+    cells[center * WORLD_CHUNK_SIZE + center] &= (unsigned char)~CELL_WALL;   // Una columna pudo caer aquí
+    add_chunk_light(chunk, center, center, 0);
+
+    // Las columnas pueden aislar celdas: unir todo al vestíbulo (el marco no se abre)
+    int labels[WORLD_CHUNK_CELLS];
+    int regions = label_components(cells, WORLD_CHUNK_SIZE, WORLD_CHUNK_SIZE, MAP_LAYOUT_LINEAR, labels);
+    join_components(cells, WORLD_CHUNK_SIZE, WORLD_CHUNK_SIZE, MAP_LAYOUT_LINEAR, labels, regions,
+                    labels[center * WORLD_CHUNK_SIZE + center]);
+}
+
+// Malla y visibilidad de las luces del chunk, sin GL ni estado compartido: lo usa el
+// hilo de fondo (y el principal si un chunk hace falta antes de tiempo)
+static void bake_world_chunk(WorldChunk* chunk) {
+    WorldChunkBake* bake = (WorldChunkBake*)malloc(sizeof(WorldChunkBake));
+    if (!bake) {
+        printf("Error: Sin memoria para hornear los chunks del mundo\n");
+        exit(1);
+    }
+
+    for (int mx = 0; mx < WORLD_CHUNK_MESHES; mx++) {
+        for (int mz = 0; mz < WORLD_CHUNK_MESHES; mz++) {
+            mesh_wall_block(chunk->cells, WORLD_CHUNK_SIZE, mx * WALL_CHUNK_SIZE, mz * WALL_CHUNK_SIZE,
+                            &bake->meshes[mx * WORLD_CHUNK_MESHES + mz]);
+        }
+    }
+
+    // Las luces miran por los huecos de los bordes: bloque de 3x3 chunks con los
+    // vecinos regenerados aquí (son deterministas y así no se lee la caché)
+    if (chunk->light_count > 0) {
+        unsigned char block[NEIGHBOURHOOD_CELLS * NEIGHBOURHOOD_CELLS];
+        WorldChunk neighbour;
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                const unsigned char* cells = chunk->cells;
+                if (i != 1 || j != 1) {
+                    neighbour.chunk_x = chunk->chunk_x + i - 1;
+                    neighbour.chunk_z = chunk->chunk_z + j - 1;
+                    generate_world_chunk(world_seed, &neighbour);
+                    cells = neighbour.cells;
+                }
+                for (int x = 0; x < WORLD_CHUNK_SIZE; x++) {
+                    memcpy(&block[(i * WORLD_CHUNK_SIZE + x) * NEIGHBOURHOOD_CELLS + j * WORLD_CHUNK_SIZE],
+                           &cells[x * WORLD_CHUNK_SIZE], WORLD_CHUNK_SIZE);
+                }
+            }
+        }
+        for (int l = 0; l < chunk->light_count; l++) {
+            LightPoint light = chunk->lights[l];
+            light.x += WORLD_CHUNK_SIZE;
+            light.z += WORLD_CHUNK_SIZE;
+            LightVisibility* v = &bake->light_visibility[l];
+            compute_light_visibility(&light, block, NEIGHBOURHOOD_CELLS, NEIGHBOURHOOD_CELLS, v);
+            v->cell_x -= WORLD_CHUNK_SIZE;
+            v->cell_z -= WORLD_CHUNK_SIZE;
+        }
+    }
+    chunk->bake = bake;
+}
+
+static void release_chunk_bake(WorldChunk* chunk) {
+    if (!chunk->bake) return;
+    for (int m = 0; m < WORLD_CHUNK_MESHES * WORLD_CHUNK_MESHES; m++) free_wall_block(&chunk->bake->meshes[m]);
+    free(chunk->bake);
+    chunk->bake = NULL;
+}
+
+// Distancia de Chebyshev en chunks
+static int chunk_distance(const WorldChunk* chunk, int chunk_x, int chunk_z) {
+    int dx = abs(chunk->chunk_x - chunk_x);
+    int dz = abs(chunk->chunk_z - chunk_z);
+    return dx > dz ? dx : dz;
+}
+
+static int find_chunk(int chunk_x, int chunk_z) {
+    for (int i = 0; i < cache_capacity; i++) {
+        if (cache[i].state != CHUNK_SLOT_FREE && cache[i].chunk_x == chunk_x && cache[i].chunk_z == chunk_z) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Hueco libre o, con la caché llena, el chunk listo más lejano fuera de la precarga
+static int claim_slot(int center_x, int center_z) {
+    int farthest = -1;
+    int farthest_distance = WORLD_PREFETCH_RADIUS;
+    for (int i = 0; i < cache_capacity; i++) {
+        if (cache[i].state == CHUNK_SLOT_FREE) {
+            cache_used++;
+            return i;
+        }
+        if (cache[i].state != CHUNK_SLOT_READY) continue;
+        int distance = chunk_distance(&cache[i], center_x, center_z);
+        if (distance > farthest_distance) {
+            farthest = i;
+            farthest_distance = distance;
+        }
+    }
+    if (farthest >= 0) {
+        release_chunk_bake(&cache[farthest]);
+        chunks_evicted++;
+    }
+    return farthest;
+}
+
+static void prefetch_task(void* data) {
+    (void)data;
+    for (int i = 0; i < pending_count; i++) {
+        WorldChunk* chunk = &cache[pending[i].slot];
+        if (pending[i].generate) generate_world_chunk(world_seed, chunk);
+        if (!chunk->bake) bake_world_chunk(chunk);
+    }
+    atomic_store_long(&prefetch_running, 0);
+}
+
+// Publicar los chunks de la tarea de fondo (si wait es false, solo si ya terminó)
+static void collect_prefetch(bool wait) {
+    if (pending_count == 0) return;
+    if (!wait && atomic_load_long(&prefetch_running)) return;
+    wait_background_task();
+    for (int i = 0; i < pending_count; i++) {
+        cache[pending[i].slot].state = CHUNK_SLOT_READY;
+        if (pending[i].generate) chunks_generated++;
+    }
+    pending_count = 0;
+}
+
+// Encargar al hilo de fondo los chunks que faltan alrededor del chunk central, de
+// dentro hacia fuera, y hornear los que vuelven a la zona de precarga
+static void schedule_prefetch(int center_x, int center_z) {
+    if (pending_count > 0) return;
+
+    // Los horneados solo se guardan cerca: la caché conserva las celdas
+    for (int i = 0; i < cache_capacity; i++) {
+        if (cache[i].state == CHUNK_SLOT_READY && chunk_distance(&cache[i], center_x, center_z) > WORLD_PREFETCH_RADIUS) {
+            release_chunk_bake(&cache[i]);
+        }
+    }
+
+    for (int r = 0; r <= WORLD_PREFETCH_RADIUS; r++) {
+        for (int x = center_x - r; x <= center_x + r; x++) {
+            for (int z = center_z - r; z <= center_z + r; z++) {
+                if (abs(x - center_x) != r && abs(z - center_z) != r) continue;
+                int slot = find_chunk(x, z);
+                bool generate = slot < 0;
+                if (!generate && cache[slot].bake) continue;
+                if (generate) {
+                    slot = claim_slot(center_x, center_z);
+                    if (slot < 0) continue;
+                    cache[slot].chunk_x = x;
+                    cache[slot].chunk_z = z;
+                }
+                cache[slot].state = CHUNK_SLOT_PENDING;
+                pending[pending_count].slot = slot;
+                pending[pending_count].generate = generate;
+                pending_count++;
+            }
+        }
+    }
+    if (pending_count == 0) return;
+
+    // Sin hilo disponible se generan aquí mismo
+    atomic_store_long(&prefetch_running, 1);
+    if (!start_background_task(prefetch_task, NULL)) prefetch_task(NULL);
+}
+
+// Chunk listo y horneado para la ventana: espera a la precarga o lo hace en el acto
+static int require_chunk(int chunk_x, int chunk_z, int center_x, int center_z) {
+    int slot = find_chunk(chunk_x, chunk_z);
+    if (slot >= 0 && cache[slot].state == CHUNK_SLOT_PENDING) collect_prefetch(true);
+    if (slot < 0) {
+        slot = claim_slot(center_x, center_z);
+        if (slot < 0) {
+            printf("Error: Caché de chunks sin huecos libres\n");
+            exit(1);
+        }
+        cache[slot].chunk_x = chunk_x;
+        cache[slot].chunk_z = chunk_z;
+        generate_world_chunk(world_seed, &cache[slot]);
+        cache[slot].state = CHUNK_SLOT_READY;
+        chunks_generated++;
+    }
+    if (!cache[slot].bake) bake_world_chunk(&cache[slot]);
+    return slot;
+}
+
+// Copiar los chunks de la ventana a la rejilla del mapa y sus luces, con la
+// visibilidad ya horneada, a lightPoints[]
+static void compose_window() {
+    int center_x = world_origin_chunk_x + WORLD_WINDOW_RADIUS;
+    int center_z = world_origin_chunk_z + WORLD_WINDOW_RADIUS;
+    lightCount = 0;
+
+    for (int i = 0; i < WORLD_WINDOW_CHUNKS; i++) {
+        for (int j = 0; j < WORLD_WINDOW_CHUNKS; j++) {
+            int slot = require_chunk(world_origin_chunk_x + i, world_origin_chunk_z + j, center_x, center_z);
+            const WorldChunk* chunk = &cache[slot];
+            int x0 = i * WORLD_CHUNK_SIZE, z0 = j * WORLD_CHUNK_SIZE;
+            window_slots[i * WORLD_WINDOW_CHUNKS + j] = slot;
+
+            // Tipo y banderas tal cual (las celdas del chunk ya llevan CELL_LIGHT)
+            for (int x = 0; x < WORLD_CHUNK_SIZE; x++) {
+                for (int z = 0; z < WORLD_CHUNK_SIZE; z++) {
+                    maze_cells[maze_index(x0 + x, z0 + z)] = chunk->cells[x * WORLD_CHUNK_SIZE + z];
+                }
+            }
+            for (int l = 0; l < chunk->light_count && lightCount < lightCapacity; l++) {
+                LightPoint light = chunk->lights[l];
+                light.x += x0;
+                light.z += z0;
+                LightVisibility* v = &window_visibility[lightCount];
+                *v = chunk->bake->light_visibility[l];
+                v->cell_x += x0;
+                v->cell_z += z0;
+                lightPoints[lightCount++] = light;
+            }
+        }
+    }
+    commit_map_cells();
+    set_light_visibility(window_visibility, lightCount);
+}
+
+// Guardar en la caché las celdas exploradas antes de que la ventana las suelte
+static void store_explored_cells() {
+    for (int i = 0; i < WORLD_WINDOW_CHUNKS; i++) {
+        for (int j = 0; j < WORLD_WINDOW_CHUNKS; j++) {
+            int slot = find_chunk(world_origin_chunk_x + i, world_origin_chunk_z + j);
+            if (slot < 0 || cache[slot].state != CHUNK_SLOT_READY) continue;
+            for (int x = 0; x < WORLD_CHUNK_SIZE; x++) {
+                for (int z = 0; z < WORLD_CHUNK_SIZE; z++) {
+                    unsigned char explored = maze_flags(i * WORLD_CHUNK_SIZE + x, j * WORLD_CHUNK_SIZE + z) & CELL_EXPLORED;
+                    cache[slot].cells[x * WORLD_CHUNK_SIZE + z] |= explored;
+                }
+            }
+        }
+    }
+}
+
+// Restar el desplazamiento de la ventana a todo lo que vive en coordenadas del mapa
+static void rebase_entities(float shift_x, float shift_z) {
+    player.x -= shift_x;
+    player.z -= shift_z;
+
+    enemy.x -= shift_x;
+    enemy.z -= shift_z;
+    enemy.previous_x -= shift_x;
+    enemy.previous_z -= shift_z;
+    enemy.target_x -= shift_x;
+    enemy.target_z -= shift_z;
+    enemy.last_player_x -= shift_x;
+    enemy.last_player_z -= shift_z;
+    if (enemy.x < 1.0f || enemy.z < 1.0f || enemy.x > maze_width - 2.0f || enemy.z > maze_height - 2.0f) {
+        teleport_enemy_randomly();      // Quedó fuera de la ventana
+    }
+
+    for (int i = 0; i < particle_count; i++) {
+        particles.x[i] -= shift_x;
+        particles.z[i] -= shift_z;
+        particles.previous_x[i] -= shift_x;
+        particles.previous_z[i] -= shift_z;
+    }
+}
+
+// La ventana avanzó (dx, dz) chunks: las mallas que siguen dentro se reutilizan y
+// solo se suben las de los chunks que entran, ya horneadas en el hilo de fondo
+static void refresh_window(int dx, int dz) {
+    shift_wall_meshes(dx * WORLD_CHUNK_MESHES, dz * WORLD_CHUNK_MESHES);
+    for (int i = 0; i < WORLD_WINDOW_CHUNKS; i++) {
+        for (int j = 0; j < WORLD_WINDOW_CHUNKS; j++) {
+            bool entered = (dx > 0 && i >= WORLD_WINDOW_CHUNKS - dx) || (dx < 0 && i < -dx) ||
+                           (dz > 0 && j >= WORLD_WINDOW_CHUNKS - dz) || (dz < 0 && j < -dz);
+            if (!entered) continue;
+            const WorldChunkBake* bake = cache[window_slots[i * WORLD_WINDOW_CHUNKS + j]].bake;
+            for (int mx = 0; mx < WORLD_CHUNK_MESHES; mx++) {
+                for (int mz = 0; mz < WORLD_CHUNK_MESHES; mz++) {
+                    install_wall_mesh(i * WORLD_CHUNK_MESHES + mx, j * WORLD_CHUNK_MESHES + mz,
+                                      &bake->meshes[mx * WORLD_CHUNK_MESHES + mz],
+                                      (float)(i * WORLD_CHUNK_SIZE), (float)(j * WORLD_CHUNK_SIZE));
+                }
+            }
+        }
+    }
+
+    // Luces de la ventana a la GPU, sin los informes de carga en cada recentrado
+    bool verbose = map_verbose;
+    map_verbose = false;
+    refresh_clustered_lights();
+    map_verbose = verbose;
+}
+
+void init_world_stream() {
+    cleanup_world_stream();
+    world_seed = map_seed;
+
+    // Presupuesto de memoria, con sitio al menos para toda la zona de precarga
+    int prefetch_side = WORLD_PREFETCH_RADIUS * 2 + 1;
+    cache_capacity = (int)((WORLD_CACHE_BUDGET_KB * 1024L) / (long)sizeof(WorldChunk));
+    if (cache_capacity < prefetch_side * prefetch_side) cache_capacity = prefetch_side * prefetch_side;
+    cache = (WorldChunk*)calloc((size_t)cache_capacity, sizeof(WorldChunk));
+    pending = (PendingChunk*)malloc(sizeof(PendingChunk) * (size_t)cache_capacity);
+    if (!cache || !pending) {
+        printf("Error: Sin memoria para la caché de chunks del mundo\n");
+        exit(1);
+    }
+
+    // El chunk (0, 0) del mundo empieza en el centro de la ventana, bajo el jugador
+    world_origin_chunk_x = -WORLD_WINDOW_RADIUS;
+    world_origin_chunk_z = -WORLD_WINDOW_RADIUS;
+    world_stream_active = true;
+    compose_window();
+    schedule_prefetch(0, 0);
+
+    printf("Mundo infinito: semilla %u, chunks de %dx%d celdas, ventana de %dx%d, caché de %d chunks (%ld KB)\n",
+           world_seed, WORLD_CHUNK_SIZE, WORLD_CHUNK_SIZE, WORLD_WINDOW_CELLS, WORLD_WINDOW_CELLS,
+           cache_capacity, (long)cache_capacity * (long)sizeof(WorldChunk) / 1024);
+}
+
+bool update_world_stream(float* shift_x, float* shift_z) {
+    *shift_x = 0.0f;
+    *shift_z = 0.0f;
+    if (!world_stream_active) return false;
+    collect_prefetch(false);
+
+    // Chunks que se desplaza la ventana: el jugador salió del central más allá del margen
+    int first = WORLD_WINDOW_RADIUS * WORLD_CHUNK_SIZE;
+    int last = first + WORLD_CHUNK_SIZE - 1;
+    int cell_x = (int)floorf(player.x + 0.5f);
+    int cell_z = (int)floorf(player.z + 0.5f);
+    int dx = 0, dz = 0;
+    if (cell_x < first - WORLD_SHIFT_MARGIN) dx = -1;
+    else if (cell_x > last + WORLD_SHIFT_MARGIN) dx = 1;
+    if (cell_z < first - WORLD_SHIFT_MARGIN) dz = -1;
+    else if (cell_z > last + WORLD_SHIFT_MARGIN) dz = 1;
+    if (dx == 0 && dz == 0) {
+        schedule_prefetch(world_origin_chunk_x + WORLD_WINDOW_RADIUS, world_origin_chunk_z + WORLD_WINDOW_RADIUS);
+        return false;
+    }
+
+    store_explored_cells();
+    world_origin_chunk_x += dx;
+    world_origin_chunk_z += dz;
+    *shift_x = (float)(dx * WORLD_CHUNK_SIZE);
+    *shift_z = (float)(dz * WORLD_CHUNK_SIZE);
+    rebase_entities(*shift_x, *shift_z);
+
+    compose_window();
+    refresh_window(dx, dz);
+    schedule_prefetch(world_origin_chunk_x + WORLD_WINDOW_RADIUS, world_origin_chunk_z + WORLD_WINDOW_RADIUS);
+
+    printf("Mundo infinito: chunk (%d, %d), %d chunks en caché, %ld generados, %ld expulsados\n",
+           world_origin_chunk_x + WORLD_WINDOW_RADIUS, world_origin_chunk_z + WORLD_WINDOW_RADIUS,
+           cache_used, chunks_generated, chunks_evicted);
+    return true;
+}
+
+void cleanup_world_stream() {
+    collect_prefetch(true);
+    for (int i = 0; i < cache_capacity; i++) release_chunk_bake(&cache[i]);
+    free(cache);
+    free(pending);
+    cache = NULL;
+    pending = NULL;
+    cache_capacity = 0;
+    cache_used = 0;
+    chunks_generated = 0;
+    chunks_evicted = 0;
+    world_stream_active = false;
+}
@@ -0,0 +1,60 @@
+// world_stream.h - Mundo infinito por chunks procedurales deterministas con origen flotante
+#ifndef WORLD_STREAM_H
+#define WORLD_STREAM_H
+
+#include <stdbool.h>
+#include "map.h"
+#include "wall_mesh.h"
+#include "light_visibility.h"
+
+// Chunks del mundo: cada uno depende solo de la semilla y de sus coordenadas.
+// El lado es múltiplo de WALL_CHUNK_SIZE y de MAP_TILE_SIZE
+#define WORLD_CHUNK_SIZE 32
+#define WORLD_CHUNK_CELLS (WORLD_CHUNK_SIZE * WORLD_CHUNK_SIZE)
+#define WORLD_CHUNK_MAX_LIGHTS 4
+#define WORLD_DOOR_MIN_WIDTH 2          // Huecos en los bordes compartidos entre chunks
+#define WORLD_DOOR_MAX_WIDTH 4
+
+// Ventana activa: la rejilla del mapa son (2 * radio + 1)^2 chunks centrados en el
+// jugador. Al salir del chunk central más allá del margen la ventana se desplaza un
+// chunk y todas las coordenadas se recentran (origen flotante)
+#define WORLD_WINDOW_RADIUS 2
+#define WORLD_WINDOW_CHUNKS (WORLD_WINDOW_RADIUS * 2 + 1)
+#define WORLD_WINDOW_CELLS (WORLD_WINDOW_CHUNKS * WORLD_CHUNK_SIZE)
+#define WORLD_SHIFT_MARGIN 4            // Celdas de histéresis fuera del chunk central
+
+// Precarga en el hilo de fondo y caché de chunks generados
+#define WORLD_PREFETCH_RADIUS (WORLD_WINDOW_RADIUS + 1)
+#define WORLD_CACHE_BUDGET_KB 2048      // Los chunks más lejanos se expulsan al llenarse
+
+// Chunks de malla (WALL_CHUNK_SIZE) por lado de un chunk del mundo
+#define WORLD_CHUNK_MESHES (WORLD_CHUNK_SIZE / WALL_CHUNK_SIZE)
+
+// Horneado de un chunk cercano en sus coordenadas locales: malla de muros, suelo y
+// techo y visibilidad de sus luces. Lo hace el hilo de fondo antes de que el chunk
+// entre en la ventana y se libera cuando se aleja de la zona de precarga
+typedef struct {
+    WallChunk meshes[WORLD_CHUNK_MESHES * WORLD_CHUNK_MESHES];     // [mx * WORLD_CHUNK_MESHES + mz]
+    LightVisibility light_visibility[WORLD_CHUNK_MAX_LIGHTS];
+} WorldChunkBake;
+
+typedef struct {
+    int chunk_x, chunk_z;
+    int state;                          // CHUNK_SLOT_* (world_stream.c)
+    WorldChunkBake* bake;               // NULL hasta hornearlo o lejos de la precarga
+    int light_count;
+    LightPoint lights[WORLD_CHUNK_MAX_LIGHTS];  // Coordenadas locales del chunk
+    unsigned char cells[WORLD_CHUNK_CELLS];     // Celda (x, z) en x * WORLD_CHUNK_SIZE + z
+} WorldChunk;
+
+extern bool world_stream_active;
+extern int world_origin_chunk_x;        // Chunk del mundo en la celda (0, 0) de la ventana
+extern int world_origin_chunk_z;
+
+// Funciones del mundo infinito (el tamaño del mapa debe ser WORLD_WINDOW_CELLS)
+void init_world_stream();               // Compone la ventana inicial y lanza la precarga
+bool update_world_stream(float* shift_x, float* shift_z);  // Tras cada tick; true si se recentró
+void generate_world_chunk(unsigned int seed, WorldChunk* chunk);   // Rellena según chunk_x/chunk_z
+void cleanup_world_stream();
+
+#endif // WORLD_STREAM_H